@@ -692,6 +692,29 @@ void tlb_flush_page_all_cpus_synced(CPUState *src, vaddr addr)
     tlb_flush_page_by_mmuidx_all_cpus_synced(src, addr, ALL_MMUIDX_BITS);
 }
 
+static inline bool tlb_cmp_in_range(uint64_t cmp, vaddr addr,
+                                    vaddr len, vaddr mask)
+{
+    return cmp != -1 &&
+           ((cmp & TARGET_PAGE_MASK & mask) - (addr & mask)) < len;
+}
+
+/*
+ * Called with tlb_c.lock held.
+ * Flush @tlb_entry if it maps any page of [@addr, @addr + @len) under @mask.
+ */
+static bool tlb_flush_entry_range_locked(CPUTLBEntry *tlb_entry,
+                                         vaddr addr, vaddr len, vaddr mask)
+{
+    if (tlb_cmp_in_range(tlb_entry->addr_read, addr, len, mask) ||
+        tlb_cmp_in_range(tlb_entry->addr_write, addr, len, mask) ||
+        tlb_cmp_in_range(tlb_entry->addr_code, addr, len, mask)) {
+        memset(tlb_entry, -1, sizeof(*tlb_entry));
+        return true;
+    }
+    return false;
+}
+
 static void tlb_flush_range_locked(CPUState *cpu, int midx,
                                    vaddr addr, vaddr len,
                                    unsigned bits)
@@ -706,11 +729,8 @@ static void tlb_flush_range_locked(CPUState *cpu, int midx,
      * the same TLB entry.
      * TODO: Perhaps allow bits to be a few bits less than the size.
      * For now, just flush the entire TLB.
-     *
-     * If @len is larger than the tlb size, then it will take longer to
-     * test all of the entries in the TLB than it will to flush it all.
      */
-    if (mask < f->mask || len > f->mask) {
+    if (mask < f->mask) {
         tlb_debug("forcing full flush midx %d ("
                   "%016" VADDR_PRIx "/%016" VADDR_PRIx "+%016" VADDR_PRIx ")\n",
                   midx, addr, mask, len);
@@ -720,10 +740,11 @@ static void tlb_flush_range_locked(CPUState *cpu, int midx,
 
     /*
      * Check if we need to flush due to large pages.
-     * Because large_page_mask contains all 1's from the msb,
-     * we only need to test the end of the range.
+     * The range may start inside the tracked large page and extend
+     * past it, so test the whole range for overlap, not just its end.
      */
-    if (((addr + len - 1) & d->large_page_mask) == d->large_page_addr) {
+    if (addr <= (d->large_page_addr | ~d->large_page_mask) &&
+        addr + len - 1 >= d->large_page_addr) {
         tlb_debug("forcing full flush midx %d ("
                   "%016" VADDR_PRIx "/%016" VADDR_PRIx ")\n",
                   midx, d->large_page_addr, d->large_page_mask);
@@ -731,6 +752,26 @@ static void tlb_flush_range_locked(CPUState *cpu, int midx,
         return;
     }
 
+    /*
+     * Each page of the range costs one probe of the table plus a scan of
+     * the victim tlb.  Past the point where that exceeds one pass over
+     * the table, test every entry against the range instead: that is
+     * cheaper, and unlike a full flush it keeps the entries outside it.
+     */
+    if ((len >> TARGET_PAGE_BITS) > tlb_n_entries(f) / (1 + CPU_VTLB_SIZE)) {
+        for (size_t i = 0; i < tlb_n_entries(f); i++) {
+            if (tlb_flush_entry_range_locked(&f->table[i], addr, len, mask)) {
+                tlb_n_used_entries_dec(cpu, midx);
+            }
+        }
+        for (int k = 0; k < CPU_VTLB_SIZE; k++) {
+            if (tlb_flush_entry_range_locked(&d->vtable[k], addr, len, mask)) {
+                tlb_n_used_entries_dec(cpu, midx);
+            }
+        }
+        return;
+    }
+
     for (vaddr i = 0; i < len; i += TARGET_PAGE_SIZE) {
         vaddr page = addr + i;
         CPUTLBEntry *entry = tlb_entry(cpu, midx, page);
@@ -1382,9 +1423,13 @@ static bool victim_tlb_hit(CPUState *cpu, size_t mmu_idx, size_t index,
             CPUTLBEntryFull *f2 = &cpu->neg.tlb.d[mmu_idx].vfulltlb[vidx];
             CPUTLBEntryFull tmpf;
             tmpf = *f1; *f1 = *f2; *f2 = tmpf;
+            qatomic_set(&cpu->neg.tlb.c.vtlb_hit_count,
+                        cpu->neg.tlb.c.vtlb_hit_count + 1);
             return true;
         }
     }
+    qatomic_set(&cpu->neg.tlb.c.vtlb_miss_count,
+                cpu->neg.tlb.c.vtlb_miss_count + 1);
     return false;
 }
 
@@ -1998,7 +2043,7 @@ static void *atomic_mmu_lookup(CPUState *cpu, vaddr addr, MemOpIdx oi,
  * @size: number of bytes
  * @mmu_idx: virtual address context
  * @ra: return address into tcg generated code, or 0
- * Context: BQL held
+ * Context: BQL held, unless @mr is lockless_io
  *
  * Load @size bytes from @addr, which is memory-mapped i/o.
  * The bytes are concatenated in big-endian order with @ret_be.
@@ -2056,6 +2101,10 @@ static uint64_t do_ld_mmio_beN(CPUState *cpu, CPUTLBEntryFull *full,
     section = io_prepare(&mr_offset, cpu, full->xlat_section, attrs, addr, ra);
     mr = section->mr;
 
+    if (mr->lockless_io) {
+        return int_ld_mmio_beN(cpu, full, ret_be, addr, size, mmu_idx,
+                               type, ra, mr, mr_offset);
+    }
     BQL_LOCK_GUARD();
     return int_ld_mmio_beN(cpu, full, ret_be, addr, size, mmu_idx,
                            type, ra, mr, mr_offset);
@@ -2542,7 +2591,7 @@ static Int128 do_ld16_mmu(CPUState *cpu, vaddr addr,
  * @size: number of bytes
  * @mmu_idx: virtual address context
  * @ra: return address into tcg generated code, or 0
- * Context: BQL held
+ * Context: BQL held, unless @mr is lockless_io
  *
  * Store @size bytes at @addr, which is memory-mapped i/o.
  * The bytes to store are extracted in little-endian order from @val_le;
@@ -2601,6 +2650,10 @@ static uint64_t do_st_mmio_leN(CPUState *cpu, CPUTLBEntryFull *full,
     section = io_prepare(&mr_offset, cpu, full->xlat_section, attrs, addr, ra);
     mr = section->mr;
 
+    if (mr->lockless_io) {
+        return int_st_mmio_leN(cpu, full, val_le, addr, size, mmu_idx,
+                               ra, mr, mr_offset);
+    }
     BQL_LOCK_GUARD();
     return int_st_mmio_leN(cpu, full, val_le, addr, size, mmu_idx,
                            ra, mr, mr_offset);
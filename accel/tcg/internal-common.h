@@ -23,4 +23,7 @@ static inline bool cpu_in_serial_context(CPUState *cs)
     return !(cs->tcg_cflags & CF_PARALLEL) || cpu_in_exclusive_context(cs);
 }
 
+/* Register the TCG provider for query-stats; system emulation only. */
+void tcg_stats_register(void);
+
 #endif
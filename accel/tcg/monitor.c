@@ -15,10 +15,15 @@
 #include "monitor/monitor.h"
 #include "sysemu/cpus.h"
 #include "sysemu/cpu-timers.h"
+#include "sysemu/stats.h"
 #include "sysemu/tcg.h"
 #include "tcg/tcg.h"
 #include "internal-common.h"
 #include "tb-context.h"
+#ifdef CONFIG_LINUX
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
 
 
 static void dump_drift_info(GString *buf)
@@ -126,6 +131,19 @@ static gboolean tb_tree_stats_iter(gpointer key, gpointer value, gpointer data)
     return false;
 }
 
+static void tlb_victim_counts(size_t *phit, size_t *pmiss)
+{
+    CPUState *cpu;
+    size_t hit = 0, miss = 0;
+
+    CPU_FOREACH(cpu) {
+        hit += qatomic_read(&cpu->neg.tlb.c.vtlb_hit_count);
+        miss += qatomic_read(&cpu->neg.tlb.c.vtlb_miss_count);
+    }
+    *phit = hit;
+    *pmiss = miss;
+}
+
 static void tlb_flush_counts(size_t *pfull, size_t *ppart, size_t *pelide)
 {
     CPUState *cpu;
@@ -146,11 +164,111 @@ static void tcg_dump_info(GString *buf)
     g_string_append_printf(buf, "[TCG profiler not compiled]\n");
 }
 
+#ifdef CONFIG_LINUX
+/*
+ * Host instruction-side cache misses of the vCPU threads, read through
+ * perf events.  The counters are opened on the first "info jit" and keep
+ * counting from then on; they cover everything the vCPU threads run,
+ * helpers included, not only the translated code.
+ */
+enum {
+    HOST_CNT_ITLB,
+    HOST_CNT_L1I,
+    HOST_CNT_NUM,
+};
+
+typedef struct HostCacheCounters {
+    int thread_id;
+    int fd[HOST_CNT_NUM];
+} HostCacheCounters;
+
+static GArray *host_counters;
+
+static int host_counter_open(int thread_id, uint64_t cache)
+{
+    struct perf_event_attr attr = {
+        .type = PERF_TYPE_HW_CACHE,
+        .size = sizeof(attr),
+        .config = cache |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        .exclude_kernel = 1,
+        .exclude_hv = 1,
+    };
+
+    return syscall(__NR_perf_event_open, &attr, thread_id, -1, -1,
+                   PERF_FLAG_FD_CLOEXEC);
+}
+
+static void host_counters_add(int thread_id)
+{
+    HostCacheCounters c = { .thread_id = thread_id };
+
+    for (int i = 0; i < host_counters->len; i++) {
+        if (g_array_index(host_counters, HostCacheCounters, i).thread_id ==
+            thread_id) {
+            return;
+        }
+    }
+    c.fd[HOST_CNT_ITLB] = host_counter_open(thread_id,
+                                            PERF_COUNT_HW_CACHE_ITLB);
+    c.fd[HOST_CNT_L1I] = host_counter_open(thread_id,
+                                           PERF_COUNT_HW_CACHE_L1I);
+    g_array_append_val(host_counters, c);
+}
+
+static void dump_host_cache_info(GString *buf)
+{
+    static const char *const names[HOST_CNT_NUM] = {
+        [HOST_CNT_ITLB] = "host iTLB misses   ",
+        [HOST_CNT_L1I]  = "host L1I misses    ",
+    };
+    CPUState *cpu;
+
+    if (!host_counters) {
+        host_counters = g_array_new(false, false, sizeof(HostCacheCounters));
+    }
+    /* Round-robin vCPUs share a thread, which is counted once */
+    CPU_FOREACH(cpu) {
+        if (cpu->thread_id) {
+            host_counters_add(cpu->thread_id);
+        }
+    }
+
+    for (int n = 0; n < HOST_CNT_NUM; n++) {
+        uint64_t total = 0;
+        bool valid = false;
+
+        for (int i = 0; i < host_counters->len; i++) {
+            HostCacheCounters *c = &g_array_index(host_counters,
+                                                  HostCacheCounters, i);
+            uint64_t val;
+
+            if (c->fd[n] >= 0 &&
+                read(c->fd[n], &val, sizeof(val)) == sizeof(val)) {
+                total += val;
+                valid = true;
+            }
+        }
+        if (valid) {
+            g_string_append_printf(buf, "%s %" PRIu64 "\n", names[n], total);
+        } else {
+            g_string_append_printf(buf, "%s not available\n", names[n]);
+        }
+    }
+}
+#else
+static void dump_host_cache_info(GString *buf)
+{
+}
+#endif
+
 static void dump_exec_info(GString *buf)
 {
     struct tb_tree_stats tst = {};
     struct qht_stats hst;
     size_t nb_tbs, flush_full, flush_part, flush_elide;
+    size_t vtlb_hit, vtlb_miss;
 
     tcg_tb_foreach(tb_tree_stats_iter, &tst);
     nb_tbs = tst.nb_tbs;
@@ -189,13 +307,25 @@ static void dump_exec_info(GString *buf)
     g_string_append_printf(buf, "\nStatistics:\n");
     g_string_append_printf(buf, "TB flush count      %u\n",
                            qatomic_read(&tb_ctx.tb_flush_count));
+    g_string_append_printf(buf, "TB buffer full      %u\n",
+                           qatomic_read(&tb_ctx.tb_full_flush_count));
+    g_string_append_printf(buf, "TB duplicates       %u\n",
+                           qatomic_read(&tb_ctx.tb_dup_discard_count));
     g_string_append_printf(buf, "TB invalidate count %u\n",
                            qatomic_read(&tb_ctx.tb_phys_invalidate_count));
+    g_string_append_printf(buf, "SMC writes          %u (%u missed)\n",
+                           qatomic_read(&tb_ctx.tb_smc_write_count),
+                           qatomic_read(&tb_ctx.tb_smc_miss_count));
 
     tlb_flush_counts(&flush_full, &flush_part, &flush_elide);
     g_string_append_printf(buf, "TLB full flushes    %zu\n", flush_full);
     g_string_append_printf(buf, "TLB partial flushes %zu\n", flush_part);
     g_string_append_printf(buf, "TLB elided flushes  %zu\n", flush_elide);
+
+    tlb_victim_counts(&vtlb_hit, &vtlb_miss);
+    g_string_append_printf(buf, "TLB victim hits     %zu\n", vtlb_hit);
+    g_string_append_printf(buf, "TLB victim misses   %zu\n", vtlb_miss);
+    dump_host_cache_info(buf);
     tcg_dump_info(buf);
 }
 
@@ -235,6 +365,193 @@ HumanReadableText *qmp_x_query_opcount(Error **errp)
     return human_readable_text_from_str(buf);
 }
 
+/*
+ * query-stats provider.  The VM target reports the translation cache
+ * counters shown by "info jit", the vCPU target the per-vCPU softmmu
+ * TLB counters that "info jit" sums up.
+ */
+typedef struct TCGStatsDesc {
+    const char *name;
+    StatsType type;
+    bool bytes;
+    uint64_t (*get)(CPUState *cpu);
+} TCGStatsDesc;
+
+static uint64_t tcg_stat_code_size(CPUState *cpu)
+{
+    return tcg_code_size();
+}
+
+static uint64_t tcg_stat_tb_flushes(CPUState *cpu)
+{
+    return qatomic_read(&tb_ctx.tb_flush_count);
+}
+
+static uint64_t tcg_stat_tb_full_flushes(CPUState *cpu)
+{
+    return qatomic_read(&tb_ctx.tb_full_flush_count);
+}
+
+static uint64_t tcg_stat_tb_duplicates(CPUState *cpu)
+{
+    return qatomic_read(&tb_ctx.tb_dup_discard_count);
+}
+
+static uint64_t tcg_stat_tb_invalidations(CPUState *cpu)
+{
+    return qatomic_read(&tb_ctx.tb_phys_invalidate_count);
+}
+
+static uint64_t tcg_stat_smc_writes(CPUState *cpu)
+{
+    return qatomic_read(&tb_ctx.tb_smc_write_count);
+}
+
+static uint64_t tcg_stat_smc_misses(CPUState *cpu)
+{
+    return qatomic_read(&tb_ctx.tb_smc_miss_count);
+}
+
+static uint64_t tcg_stat_tlb_full_flushes(CPUState *cpu)
+{
+    return qatomic_read(&cpu->neg.tlb.c.full_flush_count);
+}
+
+static uint64_t tcg_stat_tlb_partial_flushes(CPUState *cpu)
+{
+    return qatomic_read(&cpu->neg.tlb.c.part_flush_count);
+}
+
+static uint64_t tcg_stat_tlb_elided_flushes(CPUState *cpu)
+{
+    return qatomic_read(&cpu->neg.tlb.c.elide_flush_count);
+}
+
+static uint64_t tcg_stat_tlb_victim_hits(CPUState *cpu)
+{
+    return qatomic_read(&cpu->neg.tlb.c.vtlb_hit_count);
+}
+
+static uint64_t tcg_stat_tlb_victim_misses(CPUState *cpu)
+{
+    return qatomic_read(&cpu->neg.tlb.c.vtlb_miss_count);
+}
+
+static const TCGStatsDesc tcg_vm_stats[] = {
+    { "code-size", STATS_TYPE_INSTANT, true, tcg_stat_code_size },
+    { "tb-flushes", STATS_TYPE_CUMULATIVE, false, tcg_stat_tb_flushes },
+    { "tb-full-flushes", STATS_TYPE_CUMULATIVE, false,
+      tcg_stat_tb_full_flushes },
+    { "tb-duplicates", STATS_TYPE_CUMULATIVE, false, tcg_stat_tb_duplicates },
+    { "tb-invalidations", STATS_TYPE_CUMULATIVE, false,
+      tcg_stat_tb_invalidations },
+    { "smc-writes", STATS_TYPE_CUMULATIVE, false, tcg_stat_smc_writes },
+    { "smc-misses", STATS_TYPE_CUMULATIVE, false, tcg_stat_smc_misses },
+};
+
+static const TCGStatsDesc tcg_vcpu_stats[] = {
+    { "tlb-full-flushes", STATS_TYPE_CUMULATIVE, false,
+      tcg_stat_tlb_full_flushes },
+    { "tlb-partial-flushes", STATS_TYPE_CUMULATIVE, false,
+      tcg_stat_tlb_partial_flushes },
+    { "tlb-elided-flushes", STATS_TYPE_CUMULATIVE, false,
+      tcg_stat_tlb_elided_flushes },
+    { "tlb-victim-hits", STATS_TYPE_CUMULATIVE, false,
+      tcg_stat_tlb_victim_hits },
+    { "tlb-victim-misses", STATS_TYPE_CUMULATIVE, false,
+      tcg_stat_tlb_victim_misses },
+};
+
+static StatsList *tcg_stats_list(const TCGStatsDesc *desc, size_t n,
+                                 CPUState *cpu, strList *names)
+{
+    StatsList *stats_list = NULL;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        Stats *stats;
+
+        if (!apply_str_list_filter(desc[i].name, names)) {
+            continue;
+        }
+        stats = g_new0(Stats, 1);
+        stats->name = g_strdup(desc[i].name);
+        stats->value = g_new0(StatsValue, 1);
+        stats->value->type = QTYPE_QNUM;
+        stats->value->u.scalar = desc[i].get(cpu);
+        QAPI_LIST_PREPEND(stats_list, stats);
+    }
+    return stats_list;
+}
+
+static void tcg_query_stats(StatsResultList **result, StatsTarget target,
+                            strList *names, strList *targets, Error **errp)
+{
+    StatsList *stats_list;
+    CPUState *cpu;
+
+    switch (target) {
+    case STATS_TARGET_VM:
+        stats_list = tcg_stats_list(tcg_vm_stats, ARRAY_SIZE(tcg_vm_stats),
+                                    NULL, names);
+        if (stats_list) {
+            add_stats_entry(result, STATS_PROVIDER_TCG, NULL, stats_list);
+        }
+        break;
+    case STATS_TARGET_VCPU:
+        CPU_FOREACH(cpu) {
+            if (!apply_str_list_filter(cpu->parent_obj.canonical_path,
+                                       targets)) {
+                continue;
+            }
+            stats_list = tcg_stats_list(tcg_vcpu_stats,
+                                        ARRAY_SIZE(tcg_vcpu_stats),
+                                        cpu, names);
+            if (stats_list) {
+                add_stats_entry(result, STATS_PROVIDER_TCG,
+                                cpu->parent_obj.canonical_path, stats_list);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void tcg_stats_schema(StatsSchemaList **result, StatsTarget target,
+                             const TCGStatsDesc *desc, size_t n)
+{
+    StatsSchemaValueList *list = NULL;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        StatsSchemaValue *value = g_new0(StatsSchemaValue, 1);
+
+        value->name = g_strdup(desc[i].name);
+        value->type = desc[i].type;
+        if (desc[i].bytes) {
+            value->has_unit = true;
+            value->unit = STATS_UNIT_BYTES;
+        }
+        QAPI_LIST_PREPEND(list, value);
+    }
+    add_stats_schema(result, STATS_PROVIDER_TCG, target, list);
+}
+
+static void tcg_query_stats_schemas(StatsSchemaList **result, Error **errp)
+{
+    tcg_stats_schema(result, STATS_TARGET_VM,
+                     tcg_vm_stats, ARRAY_SIZE(tcg_vm_stats));
+    tcg_stats_schema(result, STATS_TARGET_VCPU,
+                     tcg_vcpu_stats, ARRAY_SIZE(tcg_vcpu_stats));
+}
+
+void tcg_stats_register(void)
+{
+    add_stats_callbacks(STATS_PROVIDER_TCG, tcg_query_stats,
+                        tcg_query_stats_schemas);
+}
+
 static void hmp_tcg_register(void)
 {
     monitor_register_hmp_info_hrt("jit", qmp_x_query_jit);
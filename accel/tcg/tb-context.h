@@ -34,7 +34,15 @@ struct TBContext {
 
     /* statistics */
     unsigned tb_flush_count;
+    /* flushes requested because code_gen_buffer ran out of space */
+    unsigned tb_full_flush_count;
+    /* translations discarded because another vCPU linked the TB first */
+    unsigned tb_dup_discard_count;
     unsigned tb_phys_invalidate_count;
+    /* guest stores to pages holding translated code */
+    unsigned tb_smc_write_count;
+    /* ... of which did not overlap any TB and invalidated nothing */
+    unsigned tb_smc_miss_count;
 };
 
 extern TBContext tb_ctx;
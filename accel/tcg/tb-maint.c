@@ -1092,8 +1092,9 @@ bool tb_invalidate_phys_page_unwind(tb_page_addr_t addr, uintptr_t pc)
 /*
  * @p must be non-NULL.
  * Call with all @pages locked.
+ * Returns true if any TB overlapping [start, last] was invalidated.
  */
-static void
+static bool
 tb_invalidate_phys_page_range__locked(struct page_collection *pages,
                                       PageDesc *p, tb_page_addr_t start,
                                       tb_page_addr_t last,
@@ -1101,6 +1102,7 @@ tb_invalidate_phys_page_range__locked(struct page_collection *pages,
 {
     TranslationBlock *tb;
     PageForEachNext n;
+    bool invalidated = false;
 #ifdef TARGET_HAS_PRECISE_SMC
     bool current_tb_modified = false;
     TranslationBlock *current_tb = retaddr ? tcg_tb_lookup(retaddr) : NULL;
@@ -1141,6 +1143,7 @@ tb_invalidate_phys_page_range__locked(struct page_collection *pages,
             }
 #endif /* TARGET_HAS_PRECISE_SMC */
             tb_phys_invalidate__locked(tb);
+            invalidated = true;
         }
     }
 
@@ -1158,6 +1161,7 @@ tb_invalidate_phys_page_range__locked(struct page_collection *pages,
         cpu_loop_exit_noexc(current_cpu);
     }
 #endif
+    return invalidated;
 }
 
 /*
@@ -1207,7 +1211,12 @@ static void tb_invalidate_phys_page_fast__locked(struct page_collection *pages,
     }
 
     assert_page_locked(p);
-    tb_invalidate_phys_page_range__locked(pages, p, start, start + len - 1, ra);
+    qatomic_inc(&tb_ctx.tb_smc_write_count);
+    if (!tb_invalidate_phys_page_range__locked(pages, p, start,
+                                               start + len - 1, ra)) {
+        /* Store hit a code page but none of its translated bytes */
+        qatomic_inc(&tb_ctx.tb_smc_miss_count);
+    }
 }
 
 /*
@@ -32,6 +32,7 @@
 #include "qemu/notify.h"
 #include "qemu/guest-random.h"
 #include "exec/exec-all.h"
+#include "hw/core/tcg-cpu-ops.h"
 #include "tcg/startup.h"
 #include "tcg-accel-ops.h"
 #include "tcg-accel-ops-rr.h"
@@ -57,14 +58,44 @@ void rr_kick_vcpu_thread(CPUState *unused)
  *
  * The timer is removed if all vCPUs are idle and restarted again once
  * idleness is complete.
+ *
+ * While the running vCPU is the only one with something to do, there
+ * is nobody to hand over to: the kick is skipped and the period doubles,
+ * up to TCG_KICK_PERIOD_MAX.  It drops back to TCG_KICK_PERIOD as soon
+ * as a second vCPU becomes runnable.
  */
 
 static QEMUTimer *rr_kick_vcpu_timer;
 static CPUState *rr_current_cpu;
+static int64_t rr_kick_period = TCG_KICK_PERIOD;
 
 static inline int64_t rr_next_kick_time(void)
 {
-    return qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) + TCG_KICK_PERIOD;
+    return qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) + rr_kick_period;
+}
+
+/*
+ * A halted vCPU without work would only bounce off cpu_handle_halt(),
+ * unless the target needs its cpu_exec_halt hook to notice new work.
+ */
+static bool rr_cpu_halted_idle(CPUState *cpu)
+{
+    return cpu->halted && !cpu->cc->tcg_ops->cpu_exec_halt &&
+           !cpu_has_work(cpu);
+}
+
+/* Whether more than one vCPU has something to run, called with the BQL */
+static bool rr_cpus_contended(void)
+{
+    CPUState *cpu;
+    int runnable = 0;
+
+    CPU_FOREACH(cpu) {
+        if (cpu_can_run(cpu) && !rr_cpu_halted_idle(cpu) && ++runnable > 1) {
+            return true;
+        }
+    }
+    return false;
 }
 
 /* Kick the currently round-robin scheduled vCPU to next */
@@ -83,17 +114,42 @@ static void rr_kick_next_cpu(void)
 
 static void rr_kick_thread(void *opaque)
 {
+    /* icount splits the budget between vCPUs itself, keep its schedule */
+    if (!icount_enabled() && !rr_cpus_contended()) {
+        rr_kick_period = MIN(rr_kick_period * 2, TCG_KICK_PERIOD_MAX);
+        timer_mod(rr_kick_vcpu_timer, rr_next_kick_time());
+        return;
+    }
+    rr_kick_period = TCG_KICK_PERIOD;
     timer_mod(rr_kick_vcpu_timer, rr_next_kick_time());
     rr_kick_next_cpu();
 }
 
+/*
+ * Another vCPU woke up, don't let it wait for the long slice.
+ * Returns true if the timer was re-armed.  Called with the BQL.
+ */
+static bool rr_shorten_kick_period(void)
+{
+    if (rr_kick_vcpu_timer && rr_kick_period > TCG_KICK_PERIOD &&
+        rr_cpus_contended()) {
+        rr_kick_period = TCG_KICK_PERIOD;
+        timer_mod(rr_kick_vcpu_timer, rr_next_kick_time());
+        return true;
+    }
+    return false;
+}
+
 static void rr_start_kick_timer(void)
 {
     if (!rr_kick_vcpu_timer && CPU_NEXT(first_cpu)) {
         rr_kick_vcpu_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL,
                                            rr_kick_thread, NULL);
     }
-    if (rr_kick_vcpu_timer && !timer_pending(rr_kick_vcpu_timer)) {
+    if (!rr_kick_vcpu_timer) {
+        return;
+    }
+    if (!rr_shorten_kick_period() && !timer_pending(rr_kick_vcpu_timer)) {
         timer_mod(rr_kick_vcpu_timer, rr_next_kick_time());
     }
 }
@@ -251,9 +307,16 @@ static void *rr_cpu_thread_fn(void *arg)
             qemu_clock_enable(QEMU_CLOCK_VIRTUAL,
                               (cpu->singlestep_enabled & SSTEP_NOTIMER) == 0);
 
-            if (cpu_can_run(cpu)) {
+            /* Idle vCPUs are skipped without going through cpu_exec() */
+            if (cpu_can_run(cpu) && !rr_cpu_halted_idle(cpu)) {
                 int r;
 
+                /*
+                 * A vCPU woken by an interrupt does not pass through
+                 * rr_wait_io_event(), so the slice may still be long.
+                 */
+                rr_shorten_kick_period();
+
                 bql_unlock();
                 if (icount_enabled()) {
                     icount_prepare_for_run(cpu, cpu_budget);
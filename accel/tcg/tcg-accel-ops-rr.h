@@ -11,6 +11,8 @@
 #define TCG_ACCEL_OPS_RR_H
 
 #define TCG_KICK_PERIOD (NANOSECONDS_PER_SECOND / 10)
+/* Longest slice a vCPU gets while no other vCPU is waiting to run */
+#define TCG_KICK_PERIOD_MAX (NANOSECONDS_PER_SECOND * 2)
 
 /* Kick all RR vCPUs. */
 void rr_kick_vcpu_thread(CPUState *unused);
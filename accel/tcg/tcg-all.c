@@ -38,6 +38,7 @@
 #if !defined(CONFIG_USER_ONLY)
 #include "hw/boards.h"
 #endif
+#include "internal-common.h"
 #include "internal-target.h"
 
 struct TCGState {
@@ -123,6 +124,9 @@ static int tcg_init_machine(MachineState *ms)
      */
     tcg_prologue_init();
 #endif
+#if !defined(CONFIG_USER_ONLY)
+    tcg_stats_register();
+#endif
 
     return 0;
 }
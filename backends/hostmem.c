@@ -20,6 +20,9 @@
 #include "qom/object_interfaces.h"
 #include "qemu/mmap-alloc.h"
 #include "qemu/madvise.h"
+#include "qemu/thread-context.h"
+#include "qapi/qmp/qlist.h"
+#include "qom/qom-qobject.h"
 #include "hw/qdev-core.h"
 
 #ifdef CONFIG_NUMA
@@ -317,11 +320,48 @@ size_t host_memory_backend_pagesize(HostMemoryBackend *memdev)
     return pagesize;
 }
 
+#ifdef CONFIG_NUMA
+/*
+ * Without an explicit prealloc-context, run the preallocation threads on
+ * the CPUs of the bound host nodes so that pages are touched node-locally.
+ * Returns NULL if no such context could be created.
+ */
+static ThreadContext *
+host_memory_backend_node_context(HostMemoryBackend *backend)
+{
+    Object *obj = object_new(TYPE_THREAD_CONTEXT);
+    QList *nodes = qlist_new();
+    unsigned long node;
+    bool ok;
+
+    /* Named child of the backend, so the context thread gets a name */
+    object_property_add_child(OBJECT(backend), "prealloc-node-context", obj);
+    object_unref(obj);
+
+    for (node = find_first_bit(backend->host_nodes, MAX_NODES);
+         node < MAX_NODES;
+         node = find_next_bit(backend->host_nodes, MAX_NODES, node + 1)) {
+        qlist_append_int(nodes, node);
+    }
+    ok = object_property_set_qobject(obj, "node-affinity", QOBJECT(nodes),
+                                     NULL) &&
+         user_creatable_complete(USER_CREATABLE(obj), NULL);
+    qobject_unref(nodes);
+    if (!ok) {
+        object_unparent(obj);
+        return NULL;
+    }
+    return THREAD_CONTEXT(obj);
+}
+#endif
+
 static void
 host_memory_backend_memory_complete(UserCreatable *uc, Error **errp)
 {
     HostMemoryBackend *backend = MEMORY_BACKEND(uc);
     HostMemoryBackendClass *bc = MEMORY_BACKEND_GET_CLASS(uc);
+    ThreadContext *tc = backend->prealloc_context;
+    ThreadContext *node_tc = NULL;
     void *ptr;
     uint64_t sz;
     bool async = !phase_check(PHASE_LATE_BACKENDS_CREATED);
@@ -395,6 +435,10 @@ host_memory_backend_memory_complete(UserCreatable *uc, Error **errp)
             return;
         }
     }
+
+    if (backend->prealloc && !tc && maxnode && backend->policy == MPOL_BIND) {
+        tc = node_tc = host_memory_backend_node_context(backend);
+    }
 #endif
     /*
      * Preallocate memory after the NUMA policy has been instantiated.
@@ -404,10 +448,16 @@ host_memory_backend_memory_complete(UserCreatable *uc, Error **errp)
     if (backend->prealloc && !qemu_prealloc_mem(memory_region_get_fd(&backend->mr),
                                                 ptr, sz,
                                                 backend->prealloc_threads,
-                                                backend->prealloc_context,
-                                                async, errp)) {
+                                                tc, async, errp)) {
+        /* The touch threads are gone, so is any use of the node context */
+        if (node_tc) {
+            object_unparent(OBJECT(node_tc));
+        }
         return;
     }
+    if (node_tc) {
+        object_unparent(OBJECT(node_tc));
+    }
 }
 
 static bool
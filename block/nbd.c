@@ -354,6 +354,7 @@ int coroutine_fn nbd_co_do_establish_connection(BlockDriverState *bs,
 
     qio_channel_set_blocking(s->ioc, false, NULL);
     qio_channel_set_follow_coroutine_ctx(s->ioc, true);
+    qio_channel_set_uring(s->ioc, true);
 
     /* successfully connected */
     WITH_QEMU_LOCK_GUARD(&s->requests_lock) {
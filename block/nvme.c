@@ -143,6 +143,8 @@ struct BDRVNVMeState {
 
 #define NVME_BLOCK_OPT_DEVICE "device"
 #define NVME_BLOCK_OPT_NAMESPACE "namespace"
+#define NVME_BLOCK_OPT_COALESCE_TIME "coalesce-time"
+#define NVME_BLOCK_OPT_COALESCE_THRESHOLD "coalesce-threshold"
 
 static void nvme_process_completion_bh(void *opaque);
 
@@ -160,6 +162,16 @@ static QemuOptsList runtime_opts = {
             .type = QEMU_OPT_NUMBER,
             .help = "NVMe namespace",
         },
+        {
+            .name = NVME_BLOCK_OPT_COALESCE_TIME,
+            .type = QEMU_OPT_NUMBER,
+            .help = "Interrupt aggregation time in 100us units (0-255)",
+        },
+        {
+            .name = NVME_BLOCK_OPT_COALESCE_THRESHOLD,
+            .type = QEMU_OPT_NUMBER,
+            .help = "Completions aggregated per interrupt (1-256)",
+        },
         { /* end of list */ }
     },
 };
@@ -948,6 +960,38 @@ static int nvme_enable_disable_write_cache(BlockDriverState *bs, bool enable,
     return ret;
 }
 
+/*
+ * Let the controller delay the shared I/O completion interrupt until
+ * @threshold entries are posted or @time * 100us have passed.
+ */
+static int nvme_set_interrupt_coalescing(BlockDriverState *bs, uint64_t time,
+                                         uint64_t threshold, Error **errp)
+{
+    int ret;
+    NvmeCmd cmd = {
+        .opcode = NVME_ADM_CMD_SET_FEATURES,
+        .cdw10 = cpu_to_le32(NVME_INTERRUPT_COALESCING),
+        .cdw11 = cpu_to_le32((time << 8) | (threshold - 1)),
+    };
+
+    if (time > UINT8_MAX) {
+        error_setg(errp, "'" NVME_BLOCK_OPT_COALESCE_TIME
+                   "' must be between 0 and 255");
+        return -EINVAL;
+    }
+    if (threshold < 1 || threshold > UINT8_MAX + 1) {
+        error_setg(errp, "'" NVME_BLOCK_OPT_COALESCE_THRESHOLD
+                   "' must be between 1 and 256");
+        return -EINVAL;
+    }
+
+    ret = nvme_admin_cmd_sync(bs, &cmd);
+    if (ret) {
+        error_setg(errp, "Failed to configure NVMe interrupt coalescing");
+    }
+    return ret;
+}
+
 static void nvme_close(BlockDriverState *bs)
 {
     BDRVNVMeState *s = bs->opaque;
@@ -973,6 +1017,7 @@ static int nvme_file_open(BlockDriverState *bs, QDict *options, int flags,
     const char *device;
     QemuOpts *opts;
     int namespace;
+    uint64_t coalesce_time, coalesce_threshold;
     int ret;
     BDRVNVMeState *s = bs->opaque;
 
@@ -988,11 +1033,23 @@ static int nvme_file_open(BlockDriverState *bs, QDict *options, int flags,
     }
 
     namespace = qemu_opt_get_number(opts, NVME_BLOCK_OPT_NAMESPACE, 1);
+    coalesce_time = qemu_opt_get_number(opts, NVME_BLOCK_OPT_COALESCE_TIME, 0);
+    coalesce_threshold = qemu_opt_get_number(opts,
+                                             NVME_BLOCK_OPT_COALESCE_THRESHOLD,
+                                             1);
     ret = nvme_init(bs, device, namespace, errp);
     qemu_opts_del(opts);
     if (ret) {
         goto fail;
     }
+    /* Leave the controller's reset default alone unless asked */
+    if (coalesce_time || coalesce_threshold != 1) {
+        ret = nvme_set_interrupt_coalescing(bs, coalesce_time,
+                                            coalesce_threshold, errp);
+        if (ret) {
+            goto fail;
+        }
+    }
     if (flags & BDRV_O_NOCACHE) {
         if (!s->write_cache_supported) {
             error_setg(errp,
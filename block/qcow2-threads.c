@@ -36,6 +36,7 @@
 #include "qcow2.h"
 #include "block/block-io.h"
 #include "block/thread-pool.h"
+#include "block/aio_task.h"
 #include "crypto.h"
 
 static int coroutine_fn
@@ -453,6 +454,25 @@ static int qcow2_encdec_pool_func(void *opaque)
     return data->func(data->block, data->offset, data->buf, data->len, NULL);
 }
 
+typedef struct Qcow2EncDecTask {
+    AioTask task;
+    BlockDriverState *bs;
+    Qcow2EncDecData data;
+} Qcow2EncDecTask;
+
+static int coroutine_fn qcow2_encdec_task_entry(AioTask *task)
+{
+    Qcow2EncDecTask *t = container_of(task, Qcow2EncDecTask, task);
+
+    return qcow2_co_process(t->bs, qcow2_encdec_pool_func, &t->data);
+}
+
+/*
+ * Smallest piece a single en/decryption request is split into.  Below
+ * this the thread hop costs more than the cipher work it parallelises.
+ */
+#define QCOW2_ENCDEC_MIN_CHUNK (64 * KiB)
+
 static int coroutine_fn
 qcow2_co_encdec(BlockDriverState *bs, uint64_t host_offset,
                 uint64_t guest_offset, void *buf, size_t len,
@@ -467,6 +487,9 @@ qcow2_co_encdec(BlockDriverState *bs, uint64_t host_offset,
         .func = func,
     };
     uint64_t sector_size;
+    size_t chunk, pos;
+    AioTaskPool *pool;
+    int nb_chunks, ret;
 
     assert(s->crypto);
 
@@ -475,7 +498,40 @@ qcow2_co_encdec(BlockDriverState *bs, uint64_t host_offset,
     assert(QEMU_IS_ALIGNED(host_offset, sector_size));
     assert(QEMU_IS_ALIGNED(len, sector_size));
 
-    return len == 0 ? 0 : qcow2_co_process(bs, qcow2_encdec_pool_func, &arg);
+    if (len == 0) {
+        return 0;
+    }
+
+    nb_chunks = MIN(QCOW2_MAX_THREADS, len / QCOW2_ENCDEC_MIN_CHUNK);
+    if (nb_chunks <= 1) {
+        return qcow2_co_process(bs, qcow2_encdec_pool_func, &arg);
+    }
+
+    /*
+     * Large multi-cluster requests are split into sector-aligned pieces
+     * that run on all available crypto threads at once.  The IV only
+     * depends on each sector's offset, so the pieces are independent.
+     */
+    chunk = QEMU_ALIGN_UP(DIV_ROUND_UP(len, nb_chunks), sector_size);
+    pool = aio_task_pool_new(nb_chunks);
+    for (pos = 0; pos < len && aio_task_pool_status(pool) == 0; pos += chunk) {
+        Qcow2EncDecTask *t = g_new(Qcow2EncDecTask, 1);
+
+        *t = (Qcow2EncDecTask) {
+            .task.func = qcow2_encdec_task_entry,
+            .bs = bs,
+            .data = arg,
+        };
+        t->data.offset += pos;
+        t->data.buf += pos;
+        t->data.len = MIN(chunk, len - pos);
+        aio_task_pool_start_task(pool, &t->task);
+    }
+    aio_task_pool_wait_all(pool);
+    ret = aio_task_pool_status(pool);
+    aio_task_pool_free(pool);
+
+    return ret;
 }
 
 /*
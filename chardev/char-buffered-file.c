@@ -0,0 +1,156 @@
+/*
+ * QEMU buffered file chardev
+ *
+ * Output is appended to an in-memory ring and written to the file by a
+ * background thread, so a guest flooding its console never waits for
+ * write(2).  Data that does not fit in the ring is dropped.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "chardev/char.h"
+#include "qapi/error.h"
+#include "qemu/module.h"
+#include "qemu/option.h"
+#include "qemu/units.h"
+#include "qemu/write-ring.h"
+#include "qom/object.h"
+#include "trace.h"
+
+struct BufferedFileChardev {
+    Chardev parent;
+    int fd;
+    WriteRing ring;
+    bool ring_started;
+};
+typedef struct BufferedFileChardev BufferedFileChardev;
+
+DECLARE_INSTANCE_CHECKER(BufferedFileChardev, BUFFERED_FILE_CHARDEV,
+                         TYPE_CHARDEV_BUFFERED_FILE)
+
+static int buffered_file_chr_write(Chardev *chr, const uint8_t *buf, int len)
+{
+    BufferedFileChardev *d = BUFFERED_FILE_CHARDEV(chr);
+    size_t space, n, prod;
+
+    if (!buf || len < 0) {
+        return -1;
+    }
+
+    /* Writes are serialized by chr_write_lock, this is the only producer */
+    space = write_ring_begin(&d->ring, &prod);
+    n = MIN(space, len);
+    write_ring_put(&d->ring, prod, buf, n);
+    write_ring_commit(&d->ring, prod + n);
+    if (n < len) {
+        trace_buffered_file_chr_drop(chr->label, len - n);
+    }
+
+    /* Report everything as consumed so the frontend never retries */
+    return len;
+}
+
+static void char_buffered_file_init(Object *obj)
+{
+    BufferedFileChardev *d = BUFFERED_FILE_CHARDEV(obj);
+
+    d->fd = -1;
+}
+
+static void char_buffered_file_finalize(Object *obj)
+{
+    BufferedFileChardev *d = BUFFERED_FILE_CHARDEV(obj);
+
+    if (d->ring_started) {
+        /* drain whatever is left in the ring before closing */
+        write_ring_destroy(&d->ring);
+    }
+    if (d->fd >= 0) {
+        close(d->fd);
+    }
+}
+
+static void qemu_chr_open_buffered_file(Chardev *chr,
+                                        ChardevBackend *backend,
+                                        bool *be_opened,
+                                        Error **errp)
+{
+    ChardevBufferedFile *opts = backend->u.buffered_file.data;
+    BufferedFileChardev *d = BUFFERED_FILE_CHARDEV(chr);
+    int flags = O_WRONLY | O_CREAT | O_BINARY;
+    size_t size = opts->has_size ? opts->size : 1 * MiB;
+
+    /* The size must be power of 2 */
+    if (!size || (size & (size - 1))) {
+        error_setg(errp, "size of buffered-file chardev must be power of two");
+        return;
+    }
+
+    if (opts->has_append && opts->append) {
+        flags |= O_APPEND;
+    } else {
+        flags |= O_TRUNC;
+    }
+    d->fd = qemu_create(opts->path, flags, 0666, errp);
+    if (d->fd < 0) {
+        return;
+    }
+
+    /* Not stopping on errors, as for the logfile common option */
+    write_ring_init(&d->ring, d->fd, size, "chr-buffered-file", false);
+    d->ring_started = true;
+}
+
+static void qemu_chr_parse_buffered_file(QemuOpts *opts,
+                                         ChardevBackend *backend,
+                                         Error **errp)
+{
+    const char *path = qemu_opt_get(opts, "path");
+    ChardevBufferedFile *file;
+    uint64_t val;
+
+    backend->type = CHARDEV_BACKEND_KIND_BUFFERED_FILE;
+    if (path == NULL) {
+        error_setg(errp, "chardev: buffered-file: no filename given");
+        return;
+    }
+    file = backend->u.buffered_file.data = g_new0(ChardevBufferedFile, 1);
+    qemu_chr_parse_common(opts, qapi_ChardevBufferedFile_base(file));
+    file->path = g_strdup(path);
+
+    val = qemu_opt_get_size(opts, "size", 0);
+    if (val != 0) {
+        file->has_size = true;
+        file->size = val;
+    }
+
+    file->has_append = true;
+    file->append = qemu_opt_get_bool(opts, "append", false);
+}
+
+static void char_buffered_file_class_init(ObjectClass *oc, void *data)
+{
+    ChardevClass *cc = CHARDEV_CLASS(oc);
+
+    cc->parse = qemu_chr_parse_buffered_file;
+    cc->open = qemu_chr_open_buffered_file;
+    cc->chr_write = buffered_file_chr_write;
+}
+
+static const TypeInfo char_buffered_file_type_info = {
+    .name = TYPE_CHARDEV_BUFFERED_FILE,
+    .parent = TYPE_CHARDEV,
+    .class_init = char_buffered_file_class_init,
+    .instance_size = sizeof(BufferedFileChardev),
+    .instance_init = char_buffered_file_init,
+    .instance_finalize = char_buffered_file_finalize,
+};
+
+static void register_types(void)
+{
+    type_register_static(&char_buffered_file_type_info);
+}
+
+type_init(register_types);
@@ -1281,6 +1281,46 @@ static void handle_write_mem(GArray *params, void *user_ctx)
     gdb_put_packet("OK");
 }
 
+static void handle_write_mem_bin(GArray *params, void *user_ctx)
+{
+    char *data;
+    uint64_t len;
+
+    if (params->len < 2) {
+        gdb_put_packet("E22");
+        return;
+    }
+
+    /*
+     * The payload is raw binary and may contain NULs, so locate it in
+     * the unescaped packet rather than relying on the string parser.
+     */
+    data = memchr(gdbserver_state.line_buf, ':',
+                  gdbserver_state.line_buf_index);
+    if (!data) {
+        gdb_put_packet("E22");
+        return;
+    }
+    data++;
+
+    len = get_param(params, 1)->val_ull;
+    if (len > gdbserver_state.line_buf + gdbserver_state.line_buf_index -
+              data) {
+        gdb_put_packet("E22");
+        return;
+    }
+
+    /* GDB probes for X packet support with a zero length write */
+    if (len && gdb_target_memory_rw_debug(gdbserver_state.g_cpu,
+                                          get_param(params, 0)->val_ull,
+                                          (uint8_t *)data, len, true)) {
+        gdb_put_packet("E14");
+        return;
+    }
+
+    gdb_put_packet("OK");
+}
+
 static void handle_read_mem(GArray *params, void *user_ctx)
 {
     if (params->len != 2) {
@@ -2087,6 +2127,17 @@ static int gdb_handle_packet(const char *line_buf)
             cmd_parser = &write_mem_cmd_desc;
         }
         break;
+    case 'X':
+        {
+            static const GdbCmdParseEntry write_mem_bin_cmd_desc = {
+                .handler = handle_write_mem_bin,
+                .cmd = "X",
+                .cmd_startswith = 1,
+                .schema = "L,L:"
+            };
+            cmd_parser = &write_mem_bin_cmd_desc;
+        }
+        break;
     case 'p':
         {
             static const GdbCmdParseEntry get_reg_cmd_desc = {
@@ -241,18 +241,21 @@ ERST
 
     {
         .name       = "mtree",
-        .args_type  = "flatview:-f,dispatch_tree:-d,owner:-o,disabled:-D",
-        .params     = "[-f][-d][-o][-D]",
+        .args_type  = "flatview:-f,dispatch_tree:-d,owner:-o,disabled:-D,"
+                      "profile:-p",
+        .params     = "[-f][-d][-o][-D][-p]",
         .help       = "show memory tree (-f: dump flat view for address spaces;"
                       "-d: dump dispatch tree, valid with -f only);"
                       "-o: dump region owners/parents;"
-                      "-D: dump disabled regions",
+                      "-D: dump disabled regions;"
+                      "-p: dump MMIO access profile (see mmio-profile)",
         .cmd        = hmp_info_mtree,
     },
 
 SRST
   ``info mtree``
-    Show memory tree.
+    Show memory tree. With ``-p``, show the MMIO access counts and host
+    time per region and offset collected since ``mmio-profile on``.
 ERST
 
 #if defined(CONFIG_TCG)
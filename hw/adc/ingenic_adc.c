@@ -60,6 +60,8 @@ static void ingenic_adc_reset(Object *obj, ResetType type)
     s->adtch_state = 0;
     s->prev_state = 0;
     s->pressed = 0;
+    s->ts_rd = 0;
+    s->ts_count = 0;
     s->adena = 0;
     s->adcfg = 0;
     s->adctrl = 0;
@@ -79,6 +81,72 @@ static void ingenic_adc_update_irq(IngenicAdc *s)
         qemu_set_irq(s->irq, irq);
 }
 
+static int64_t ingenic_adc_ts_interval_ns(IngenicAdc *s)
+{
+    // ADWAIT counts ADC clocks derived from the 12MHz EXCLK
+    if (!s->adwait)
+        return TS_UPDATE_NS;
+    return (int64_t)(s->adwait + 1) * ((s->adclk & 0x3f) + 1) * 1000 / 12;
+}
+
+static void ingenic_adc_ts_push(IngenicAdc *s, int32_t x, int32_t y)
+{
+    if (s->ts_count == INGENIC_ADC_TS_FIFO_DEPTH) {
+        // Guest fell behind, drop the oldest sample
+        s->ts_rd = (s->ts_rd + 1) % INGENIC_ADC_TS_FIFO_DEPTH;
+        s->ts_count--;
+    }
+    uint8_t wr = (s->ts_rd + s->ts_count) % INGENIC_ADC_TS_FIFO_DEPTH;
+    s->ts_fifo[wr].x = x;
+    s->ts_fifo[wr].y = y;
+    s->ts_count++;
+    s->ts_last = s->ts_fifo[wr];
+
+    s->adstate |= BIT(2);
+    ingenic_adc_update_irq(s);
+}
+
+static void ingenic_adc_ts_fetch(IngenicAdc *s)
+{
+    // Convert the next queued sample, or keep returning the last one
+    if (!s->ts_count)
+        return;
+    int x = s->ts_fifo[s->ts_rd].x;
+    int y = s->ts_fifo[s->ts_rd].y;
+    s->ts_rd = (s->ts_rd + 1) % INGENIC_ADC_TS_FIFO_DEPTH;
+    s->ts_count--;
+
+    int fs = 32768;
+    // Screen flip
+    y = fs - y;
+    // X and Y margin offsets
+    int xmin = 1200;
+    int xmax = fs - 1200;
+    int ymin = 1600;
+    int ymax = fs - 1600;
+    x = xmin + x * (xmax - xmin) / fs;
+    y = ymin + y * (ymax - ymin) / fs;
+    // Calculate X, Y ADC values
+    int rplate = 4096;
+    int rxp = x * rplate / fs;
+    int ryp = y * rplate / fs;
+    int max = 4095;
+    s->x = rxp * max / rplate;
+    s->y = ryp * max / rplate;
+    // Pressure unsupported
+    s->z[0] = 100;
+    s->z[1] = 100;
+    s->z[2] = 100;
+    s->z[3] = 100;
+    trace_ingenic_adc_ts(s->pressed, s->x, s->y, s->z[0], s->z[1], s->z[2], s->z[3]);
+}
+
+static void ingenic_adc_ts_arm(IngenicAdc *s)
+{
+    int64_t now_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    timer_mod_anticipate_ns(&s->ts_timer, now_ns + ingenic_adc_ts_interval_ns(s));
+}
+
 static void ingenic_adc_ts_timer(void *opaque)
 {
     IngenicAdc *s = INGENIC_ADC(opaque);
@@ -88,12 +156,11 @@ static void ingenic_adc_ts_timer(void *opaque)
         return;
     }
 
-    // Set up timer to re-trigger touchscreen data ready interrupt
-    int64_t now_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
-    timer_mod_anticipate_ns(&s->ts_timer, now_ns + TS_UPDATE_NS);
-
-    s->adstate |= BIT(2);
-    ingenic_adc_update_irq(s);
+    // Sampling interval expired with the pen held still, repeat the last
+    // sample unless the guest has not yet acknowledged the previous one.
+    // The timer is re-armed once DTCH is cleared.
+    if (!(s->adstate & BIT(2)))
+        ingenic_adc_ts_push(s, s->ts_last.x, s->ts_last.y);
 }
 
 static void ingenic_adc_ts_event(void *opaque, int x, int y, int z, int buttons_state)
@@ -110,34 +177,15 @@ static void ingenic_adc_ts_event(void *opaque, int x, int y, int z, int buttons_
         s->adstate |= BIT(pressed ? 4 : 3);
         ingenic_adc_update_irq(s);
     }
-    if (pressed) {
-        int fs = 32768;
-        // Screen flip
-        y = fs - y;
-        // X and Y margin offsets
-        int xmin = 1200;
-        int xmax = fs - 1200;
-        int ymin = 1600;
-        int ymax = fs - 1600;
-        x = xmin + x * (xmax - xmin) / fs;
-        y = ymin + y * (ymax - ymin) / fs;
-        // Calculate X, Y ADC values
-        int rplate = 4096;
-        int rxp = x * rplate / fs;
-        int ryp = y * rplate / fs;
-        int max = 4095;
-        s->x = rxp * max / rplate;
-        s->y = ryp * max / rplate;
-        // Pressure unsupported
-        s->z[0] = 100;
-        s->z[1] = 100;
-        s->z[2] = 100;
-        s->z[3] = 100;
+    if (!pressed) {
+        timer_del(&s->ts_timer);
+        return;
     }
+    // Only new coordinates produce a sample
+    if (update || x != s->ts_last.x || y != s->ts_last.y)
+        ingenic_adc_ts_push(s, x, y);
     if (update)
-        ingenic_adc_ts_timer(s);
-    if (pressed || update)
-        trace_ingenic_adc_ts(pressed, s->x, s->y, s->z[0], s->z[1], s->z[2], s->z[3]);
+        ingenic_adc_ts_arm(s);
 }
 
 static void ingenic_adc_sampler_enable(IngenicAdc *s)
@@ -199,19 +247,19 @@ static uint64_t ingenic_adc_read(void *opaque, hwaddr addr, unsigned size)
         break;
     case REG_ADWAIT:
         data = s->adwait;
-        qemu_log_mask(LOG_UNIMP, "%s: TODO ADWAIT\n", __func__);
-        qmp_stop(NULL);
         break;
     case REG_ADTCH:
         // Touch screen data
         switch ((s->adcfg >> 13) & 3) {
         // X -> Y
         case 0b00:
+            ingenic_adc_ts_fetch(s);
             data = (s->y << 16) | s->x;
             break;
         // X -> Y -> Z
         case 0b01:
             if (!(s->adtch_state & 1)) {
+                ingenic_adc_ts_fetch(s);
                 data = (s->y << 16) | s->x;
                 s->adtch_fifo = s->z[0];
             } else {
@@ -224,6 +272,8 @@ static uint64_t ingenic_adc_read(void *opaque, hwaddr addr, unsigned size)
             uint8_t type = s->adtch_state & 2;
             uint32_t mask = type ? 0x80008000 : 0;
             if (!(s->adtch_state & 1)) {
+                if (!type)
+                    ingenic_adc_ts_fetch(s);
                 data = mask | (s->y << 16) | s->x;
                 s->adtch_fifo = mask | (s->z[type + 1] << 16) | s->z[type + 0];
             } else {
@@ -288,6 +338,14 @@ static void ingenic_adc_write(void *opaque, hwaddr addr, uint64_t data, unsigned
         break;
     case REG_ADSTATE:
         s->adstate &= ~(data & 0x3f);
+        if (data & BIT(2)) {
+            // Keep DTCH asserted while samples are queued,
+            // otherwise wait one sampling interval for the next one
+            if (s->ts_count)
+                s->adstate |= BIT(2);
+            else if ((s->adena & BIT(2)) && s->pressed)
+                ingenic_adc_ts_arm(s);
+        }
         ingenic_adc_update_irq(s);
         break;
     case REG_ADSAME:
@@ -350,8 +408,66 @@ static void ingenic_adc_finalize(Object *obj)
     timer_del(&s->ts_timer);
 }
 
+static const VMStateDescription vmstate_ingenic_adc_ts_sample = {
+    .name = "ingenic-adc/ts-sample",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_INT32(x, struct IngenicAdcTsSample),
+        VMSTATE_INT32(y, struct IngenicAdcTsSample),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static int ingenic_adc_post_load(void *opaque, int version_id)
+{
+    IngenicAdc *s = INGENIC_ADC(opaque);
+    if (s->ts_rd >= INGENIC_ADC_TS_FIFO_DEPTH || s->ts_count > INGENIC_ADC_TS_FIFO_DEPTH)
+        return -EINVAL;
+    return 0;
+}
+
+static const VMStateDescription vmstate_ingenic_adc = {
+    .name = "ingenic-adc",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_adc_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_TIMER(sampler_timer, IngenicAdc),
+        VMSTATE_TIMER(ts_timer, IngenicAdc),
+        VMSTATE_UINT32(sampler, IngenicAdc),
+        VMSTATE_UINT8(adtch_state, IngenicAdc),
+        VMSTATE_UINT16(x, IngenicAdc),
+        VMSTATE_UINT16(y, IngenicAdc),
+        VMSTATE_UINT16_ARRAY(z, IngenicAdc, 4),
+        VMSTATE_UINT32(adtch_fifo, IngenicAdc),
+        VMSTATE_UINT8(prev_state, IngenicAdc),
+        VMSTATE_BOOL(pressed, IngenicAdc),
+        VMSTATE_INT32(ts_last.x, IngenicAdc),
+        VMSTATE_INT32(ts_last.y, IngenicAdc),
+        VMSTATE_UINT8(ts_rd, IngenicAdc),
+        VMSTATE_UINT8(ts_count, IngenicAdc),
+        VMSTATE_STRUCT_ARRAY(ts_fifo, IngenicAdc, INGENIC_ADC_TS_FIFO_DEPTH, 1,
+                             vmstate_ingenic_adc_ts_sample, struct IngenicAdcTsSample),
+        VMSTATE_UINT8(adena, IngenicAdc),
+        VMSTATE_UINT32(adcfg, IngenicAdc),
+        VMSTATE_UINT8(adctrl, IngenicAdc),
+        VMSTATE_UINT8(adstate, IngenicAdc),
+        VMSTATE_UINT16(adsame, IngenicAdc),
+        VMSTATE_UINT16(adwait, IngenicAdc),
+        VMSTATE_UINT16(adbdat, IngenicAdc),
+        VMSTATE_UINT16(adsdat, IngenicAdc),
+        VMSTATE_UINT16(adflt, IngenicAdc),
+        VMSTATE_UINT32(adclk, IngenicAdc),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static void ingenic_adc_class_init(ObjectClass *class, void *data)
 {
+    DeviceClass *dc = DEVICE_CLASS(class);
+    dc->vmsd = &vmstate_ingenic_adc;
+
     IngenicAdcClass *bch_class = INGENIC_ADC_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
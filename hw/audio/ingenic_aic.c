@@ -24,7 +24,10 @@
 
 #include "qemu/osdep.h"
 #include "hw/sysbus.h"
+#include "hw/irq.h"
+#include "hw/qdev-properties.h"
 #include "migration/vmstate.h"
+#include "qapi/error.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
 #include "hw/audio/ingenic_aic.h"
@@ -52,8 +55,79 @@
 #define REG_RGADW   0xa4
 #define REG_RGDATA  0xa8
 
+// AICCR bits
+#define AICCR_EREC  BIT(0)
+#define AICCR_ERPL  BIT(1)
+#define AICCR_ETFS  BIT(3)
+#define AICCR_ERFS  BIT(4)
+#define AICCR_RFLUSH    BIT(7)
+#define AICCR_TFLUSH    BIT(8)
+#define AICCR_M2S   BIT(11)
+#define AICCR_RDMS  BIT(14)
+#define AICCR_TDMS  BIT(15)
+
+// AICSR bits, the FIFO levels are filled in on read
+#define AICSR_TUR   BIT(5)
+#define AICSR_ROR   BIT(6)
+
+// Hardware FIFO depth in samples, as reported through AICSR
+#define AIC_FIFO_DEPTH  32
+
 void qmp_stop(Error **errp);
 
+static void ingenic_aic_update_voices(IngenicAic *s);
+
+// Sample size in bytes and left shift into the backend format for OSS/ISS
+static void ingenic_aic_sample_format(uint32_t ss, uint32_t *bytes, uint32_t *shift)
+{
+    static const uint8_t bits[8] = {8, 16, 18, 20, 24, 24, 24, 24};
+    *bytes = bits[ss & 7] <= 16 ? bits[ss & 7] / 8 : 4;
+    *shift = *bytes * 8 - bits[ss & 7];
+}
+
+static uint32_t ingenic_aic_sample_bytes(IngenicAic *s, bool tx)
+{
+    uint32_t bytes, shift;
+    ingenic_aic_sample_format(s->reg.aiccr >> (tx ? 16 : 19), &bytes, &shift);
+    return bytes;
+}
+
+static void ingenic_aic_ring_flush(struct IngenicAicRing *r)
+{
+    r->rd = 0;
+    r->level = 0;
+}
+
+static uint32_t ingenic_aic_ring_push(struct IngenicAicRing *r, const uint8_t *buf, uint32_t len)
+{
+    len = MIN(len, INGENIC_AIC_RING_SIZE - r->level);
+    uint32_t wr = (r->rd + r->level) % INGENIC_AIC_RING_SIZE;
+    uint32_t l = MIN(len, INGENIC_AIC_RING_SIZE - wr);
+    memcpy(&r->buf[wr], buf, l);
+    memcpy(&r->buf[0], buf + l, len - l);
+    r->level += len;
+    return len;
+}
+
+static uint32_t ingenic_aic_ring_pop(struct IngenicAicRing *r, uint8_t *buf, uint32_t len)
+{
+    len = MIN(len, r->level);
+    uint32_t l = MIN(len, INGENIC_AIC_RING_SIZE - r->rd);
+    memcpy(buf, &r->buf[r->rd], l);
+    memcpy(buf + l, &r->buf[0], len - l);
+    r->rd = (r->rd + len) % INGENIC_AIC_RING_SIZE;
+    r->level -= len;
+    return len;
+}
+
+static void ingenic_aic_update_irq(IngenicAic *s)
+{
+    bool tfs = INGENIC_AIC_RING_SIZE - s->tx.level >= INGENIC_AIC_RING_SIZE / 2;
+    bool rfs = s->rx.level >= INGENIC_AIC_RING_SIZE / 2;
+    qemu_set_irq(s->irq, ((s->reg.aiccr & AICCR_ETFS) && tfs) ||
+                         ((s->reg.aiccr & AICCR_ERFS) && rfs));
+}
+
 static void ingenic_aic_reset(Object *obj, ResetType type)
 {
     IngenicAic *s = INGENIC_AIC(obj);
@@ -63,9 +137,172 @@ static void ingenic_aic_reset(Object *obj, ResetType type)
     }
     s->reg.aiccr = 0x00240000;
     s->reg.i2scr = 0;
-    s->reg.aicsr = BIT(3);
+    s->reg.aicsr = 0;
     s->reg.cdccr1 = 0x001b2302;
     s->reg.cdccr2 = 0x00170803;
+    ingenic_aic_ring_flush(&s->tx);
+    ingenic_aic_ring_flush(&s->rx);
+    if (type == -1) {
+        ingenic_aic_update_voices(s);
+        ingenic_aic_update_irq(s);
+    }
+}
+
+static void ingenic_aic_reset_hold(Object *obj)
+{
+    IngenicAic *s = INGENIC_AIC(obj);
+    ingenic_aic_update_voices(s);
+    ingenic_aic_update_irq(s);
+}
+
+uint32_t ingenic_aic_available(IngenicAic *s, bool tx)
+{
+    // Bytes the DMAC may move now, assuming port width matches sample size
+    if (unlikely(!s))
+        return 0;
+    if (tx)
+        return INGENIC_AIC_RING_SIZE - s->tx.level;
+    return s->rx.level;
+}
+
+uint32_t ingenic_aic_tx_write(IngenicAic *s, const uint8_t *buf, uint32_t len, uint32_t width)
+{
+    uint32_t bytes, shift, accepted = 0;
+    ingenic_aic_sample_format(s->reg.aiccr >> 16, &bytes, &shift);
+    // A full FIFO has no status flag, samples that don't fit are dropped
+    if (width == bytes && shift == 0) {
+        // Samples already in backend format
+        accepted = ingenic_aic_ring_push(&s->tx, buf, len);
+    } else {
+        // One sample per port transfer, LSB aligned
+        for (; accepted + width <= len; accepted += width) {
+            uint32_t v = 0;
+            memcpy(&v, &buf[accepted], MIN(width, 4));
+            v = le32_to_cpu(v) << shift;
+            v = cpu_to_le32(v);
+            if (ingenic_aic_ring_push(&s->tx, (uint8_t *)&v, bytes) != bytes)
+                break;
+        }
+    }
+    trace_ingenic_aic_tx(accepted, s->tx.level);
+    ingenic_aic_update_irq(s);
+    return accepted;
+}
+
+uint32_t ingenic_aic_rx_read(IngenicAic *s, uint8_t *buf, uint32_t len, uint32_t width)
+{
+    uint32_t bytes, shift;
+    ingenic_aic_sample_format(s->reg.aiccr >> 19, &bytes, &shift);
+    if (width == bytes && shift == 0) {
+        uint32_t popped = ingenic_aic_ring_pop(&s->rx, buf, len);
+        if (popped != len) {
+            // Empty FIFO, pad with silence
+            memset(&buf[popped], 0, len - popped);
+        }
+    } else {
+        for (uint32_t i = 0; i + width <= len; i += width) {
+            int32_t v = 0;
+            ingenic_aic_ring_pop(&s->rx, (uint8_t *)&v, bytes);
+            v = (int32_t)le32_to_cpu(v) >> shift;
+            v = cpu_to_le32(v);
+            memcpy(&buf[i], &v, MIN(width, 4));
+        }
+    }
+    trace_ingenic_aic_rx(len, s->rx.level);
+    ingenic_aic_update_irq(s);
+    return len;
+}
+
+static void ingenic_aic_out_cb(void *opaque, int avail)
+{
+    IngenicAic *s = INGENIC_AIC(opaque);
+    // Drain the ring into the backend as far as it will take
+    while (avail > 0 && s->tx.level) {
+        uint32_t len = MIN(MIN(avail, s->tx.level), INGENIC_AIC_RING_SIZE - s->tx.rd);
+        size_t written = AUD_write(s->voice_out, &s->tx.buf[s->tx.rd], len);
+        if (written == 0)
+            break;
+        s->tx.rd = (s->tx.rd + written) % INGENIC_AIC_RING_SIZE;
+        s->tx.level -= written;
+        avail -= written;
+    }
+    // The backend wanted more than the FIFO held
+    if (avail > 0 && !s->tx.level)
+        s->reg.aicsr |= AICSR_TUR;
+    // Ask for another large chunk once half the ring is free
+    if ((s->reg.aiccr & AICCR_TDMS) &&
+        INGENIC_AIC_RING_SIZE - s->tx.level >= INGENIC_AIC_RING_SIZE / 2)
+        qemu_irq_pulse(s->dma_tx);
+    ingenic_aic_update_irq(s);
+}
+
+static void ingenic_aic_in_cb(void *opaque, int avail)
+{
+    IngenicAic *s = INGENIC_AIC(opaque);
+    while (avail > 0 && s->rx.level < INGENIC_AIC_RING_SIZE) {
+        uint32_t wr = (s->rx.rd + s->rx.level) % INGENIC_AIC_RING_SIZE;
+        uint32_t len = MIN(MIN(avail, INGENIC_AIC_RING_SIZE - s->rx.level),
+                           INGENIC_AIC_RING_SIZE - wr);
+        size_t read = AUD_read(s->voice_in, &s->rx.buf[wr], len);
+        if (read == 0)
+            break;
+        s->rx.level += read;
+        avail -= read;
+    }
+    // Captured samples that found the FIFO full are lost
+    if (avail > 0 && s->rx.level == INGENIC_AIC_RING_SIZE)
+        s->reg.aicsr |= AICSR_ROR;
+    if ((s->reg.aiccr & AICCR_RDMS) && s->rx.level >= INGENIC_AIC_RING_SIZE / 2)
+        qemu_irq_pulse(s->dma_rx);
+    ingenic_aic_update_irq(s);
+}
+
+static void ingenic_aic_settings(IngenicAic *s, bool tx, struct audsettings *as)
+{
+    static const int rates[16] = {
+        8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100,
+        48000, 48000, 48000, 48000, 48000, 48000, 48000, 48000,
+    };
+    static const AudioFormat fmts[3] = {
+        AUDIO_FORMAT_S8, AUDIO_FORMAT_S16, AUDIO_FORMAT_S32,
+    };
+    uint32_t bytes = ingenic_aic_sample_bytes(s, tx);
+    as->freq = rates[(s->reg.cdccr2 >> 8) & 0x0f];
+    as->nchannels = tx && (s->reg.aiccr & AICCR_M2S) ? 1 : 2;
+    as->fmt = fmts[bytes / 2];
+    as->endianness = 0;
+}
+
+static void ingenic_aic_update_voices(IngenicAic *s)
+{
+    if (!s->card.name)
+        return;
+    bool en = s->reg.aicfr & BIT(0);
+    struct audsettings as;
+
+    // Playback
+    bool play = en && (s->reg.aiccr & AICCR_ERPL);
+    ingenic_aic_settings(s, true, &as);
+    if (play && (!s->voice_out || memcmp(&as, &s->as_out, sizeof(as)) != 0)) {
+        s->as_out = as;
+        s->voice_out = AUD_open_out(&s->card, s->voice_out, "ingenic-aic.out",
+                                    s, ingenic_aic_out_cb, &s->as_out);
+        trace_ingenic_aic_voice("out", as.freq, as.nchannels, as.fmt);
+    }
+    if (s->voice_out)
+        AUD_set_active_out(s->voice_out, play);
+
+    // Capture
+    bool rec = en && (s->reg.aiccr & AICCR_EREC);
+    ingenic_aic_settings(s, false, &as);
+    if (rec && (!s->voice_in || memcmp(&as, &s->as_in, sizeof(as)) != 0)) {
+        s->as_in = as;
+        s->voice_in = AUD_open_in(&s->card, s->voice_in, "ingenic-aic.in",
+                                  s, ingenic_aic_in_cb, &s->as_in);
+        trace_ingenic_aic_voice("in", as.freq, as.nchannels, as.fmt);
+    }
+    if (s->voice_in)
+        AUD_set_active_in(s->voice_in, rec);
 }
 
 static uint64_t ingenic_aic_read(void *opaque, hwaddr addr, unsigned size)
@@ -82,12 +319,26 @@ static uint64_t ingenic_aic_read(void *opaque, hwaddr addr, unsigned size)
     case REG_I2SCR:
         data = s->reg.i2scr;
         break;
-    case REG_AICSR:
-        data = s->reg.aicsr;
+    case REG_AICSR: {
+        // FIFO levels reflect the rings, saturated at the hardware depth
+        uint32_t tfl = MIN(s->tx.level / ingenic_aic_sample_bytes(s, true), AIC_FIFO_DEPTH);
+        uint32_t rfl = MIN(s->rx.level / ingenic_aic_sample_bytes(s, false), AIC_FIFO_DEPTH);
+        data = s->reg.aicsr | (rfl << 24) | (tfl << 8);
+        if (INGENIC_AIC_RING_SIZE - s->tx.level >= INGENIC_AIC_RING_SIZE / 2)
+            data |= BIT(3);
+        if (s->rx.level >= INGENIC_AIC_RING_SIZE / 2)
+            data |= BIT(4);
         break;
+    }
     case REG_I2SDIV:
         data = s->reg.i2sdiv;
         break;
+    case REG_AICDR: {
+        uint32_t v = 0;
+        ingenic_aic_rx_read(s, (uint8_t *)&v, 4, 4);
+        data = le32_to_cpu(v);
+        break;
+    }
     case REG_CDCCR1:
         data = s->reg.cdccr1;
         break;
@@ -112,25 +363,39 @@ static void ingenic_aic_write(void *opaque, hwaddr addr, uint64_t data, unsigned
         if (data & BIT(3))
             ingenic_aic_reset(opaque, -1);
         s->reg.aicfr = data & 0xff77;
+        ingenic_aic_update_voices(s);
         break;
     case REG_AICCR:
-        s->reg.aiccr = data & 0x003fce7f;
-        if (data & (BIT(8) | BIT(7))) {
-            qemu_log_mask(LOG_UNIMP, "%s: TODO\n", __func__);
-            qmp_stop(NULL);
-        }
+        // Flush bits are self-clearing
+        if (data & AICCR_RFLUSH)
+            ingenic_aic_ring_flush(&s->rx);
+        if (data & AICCR_TFLUSH)
+            ingenic_aic_ring_flush(&s->tx);
+        s->reg.aiccr = data & 0x003fce7f & ~(AICCR_TFLUSH | AICCR_RFLUSH);
+        ingenic_aic_update_voices(s);
+        ingenic_aic_update_irq(s);
         break;
     case REG_I2SCR:
         s->reg.i2scr = data & 0x1011;
         break;
+    case REG_AICSR:
+        // Only ROR/TUR are writable, cleared by writing 0
+        s->reg.aicsr &= data | ~(AICSR_ROR | AICSR_TUR);
+        break;
     case REG_I2SDIV:
         s->reg.i2sdiv = data & 0x0f;
         break;
+    case REG_AICDR: {
+        uint32_t v = cpu_to_le32(data);
+        ingenic_aic_tx_write(s, (uint8_t *)&v, 4, 4);
+        break;
+    }
     case REG_CDCCR1:
         s->reg.cdccr1 = data & 0x3f1f7f03;
         break;
     case REG_CDCCR2:
         s->reg.cdccr2 = data & 0x001f0f33;
+        ingenic_aic_update_voices(s);
         break;
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "%s: Unknown address " HWADDR_FMT_plx " 0x%"PRIx64"\n",
@@ -152,19 +417,85 @@ static void ingenic_aic_init(Object *obj)
     IngenicAic *s = INGENIC_AIC(obj);
     memory_region_init_io(&s->mr, OBJECT(s), &adc_ops, s, "adc", 0x1000);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mr);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->irq, "irq-out", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_tx, "dma-tx-req", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_rx, "dma-rx-req", 1);
 }
 
 static void ingenic_aic_finalize(Object *obj)
 {
 }
 
+static void ingenic_aic_realize(DeviceState *dev, Error **errp)
+{
+    IngenicAic *s = INGENIC_AIC(dev);
+    if (!AUD_register_card("ingenic-aic", &s->card, errp))
+        return;
+}
+
+static void ingenic_aic_unrealize(DeviceState *dev)
+{
+    IngenicAic *s = INGENIC_AIC(dev);
+    if (s->voice_out)
+        AUD_close_out(&s->card, s->voice_out);
+    if (s->voice_in)
+        AUD_close_in(&s->card, s->voice_in);
+    s->voice_out = NULL;
+    s->voice_in = NULL;
+    AUD_remove_card(&s->card);
+}
+
+static int ingenic_aic_post_load(void *opaque, int version_id)
+{
+    IngenicAic *s = INGENIC_AIC(opaque);
+    if (s->tx.rd >= INGENIC_AIC_RING_SIZE || s->tx.level > INGENIC_AIC_RING_SIZE ||
+        s->rx.rd >= INGENIC_AIC_RING_SIZE || s->rx.level > INGENIC_AIC_RING_SIZE)
+        return -EINVAL;
+    ingenic_aic_update_voices(s);
+    return 0;
+}
+
+static const VMStateDescription vmstate_ingenic_aic = {
+    .name = "ingenic-aic",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_aic_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT16(reg.aicfr, IngenicAic),
+        VMSTATE_UINT32(reg.aiccr, IngenicAic),
+        VMSTATE_UINT16(reg.i2scr, IngenicAic),
+        VMSTATE_UINT32(reg.aicsr, IngenicAic),
+        VMSTATE_UINT8(reg.i2sdiv, IngenicAic),
+        VMSTATE_UINT32(reg.cdccr1, IngenicAic),
+        VMSTATE_UINT32(reg.cdccr2, IngenicAic),
+        VMSTATE_UINT8_ARRAY(tx.buf, IngenicAic, INGENIC_AIC_RING_SIZE),
+        VMSTATE_UINT32(tx.rd, IngenicAic),
+        VMSTATE_UINT32(tx.level, IngenicAic),
+        VMSTATE_UINT8_ARRAY(rx.buf, IngenicAic, INGENIC_AIC_RING_SIZE),
+        VMSTATE_UINT32(rx.rd, IngenicAic),
+        VMSTATE_UINT32(rx.level, IngenicAic),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static Property ingenic_aic_properties[] = {
+    DEFINE_AUDIO_PROPERTIES(IngenicAic, card),
+    DEFINE_PROP_END_OF_LIST(),
+};
+
 static void ingenic_aic_class_init(ObjectClass *class, void *data)
 {
+    DeviceClass *dc = DEVICE_CLASS(class);
+    device_class_set_props(dc, ingenic_aic_properties);
+    dc->realize = ingenic_aic_realize;
+    dc->unrealize = ingenic_aic_unrealize;
+    dc->vmsd = &vmstate_ingenic_aic;
+
     IngenicAicClass *bch_class = INGENIC_AIC_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
                                        ingenic_aic_reset,
-                                       NULL,
+                                       ingenic_aic_reset_hold,
                                        NULL,
                                        &bch_class->parent_phases);
 }
@@ -22,6 +22,7 @@
 #include "qapi/error.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
+#include "qemu/host-utils.h"
 #include "migration/vmstate.h"
 #include "exec/address-spaces.h"
 #include "hw/sysbus.h"
@@ -49,12 +50,347 @@
 #define REG_BHINTES 0x3c
 #define REG_BHINTEC 0x40
 
+#define BHCR_BSEL8  BIT(2)
+#define BHCR_ENCE   BIT(3)
+
+#define BHINT_ERR   BIT(0)
+#define BHINT_UNCOR BIT(1)
+#define BHINT_ENCF  BIT(2)
+#define BHINT_DECF  BIT(3)
+#define BHINT_ALLF  BIT(4)
+#define BHINT_ALL0  BIT(5)
+#define BHINT_ERRC_SHIFT    28
+
 void qmp_stop(Error **errp);
 
+// BCH codec over GF(2^13)
+
+#define GF_M        13
+#define GF_N        ((1 << GF_M) - 1)
+#define GF_POLY     0x201b
+
+static uint16_t gf_exp[2 * GF_N];
+static uint16_t gf_log[GF_N + 1];
+
+typedef struct IngenicBchCode {
+    unsigned t;         // Correctable bits
+    unsigned r;         // Parity bits
+    uint64_t rem[256][2];
+} IngenicBchCode;
+
+static IngenicBchCode bch_code[2] = {
+    { .t = 4, .r = 4 * GF_M },
+    { .t = 8, .r = 8 * GF_M },
+};
+
+static inline uint16_t gf_mul(uint16_t a, uint16_t b)
+{
+    if (!a || !b)
+        return 0;
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static inline uint16_t gf_div(uint16_t a, uint16_t b)
+{
+    if (!a)
+        return 0;
+    return gf_exp[gf_log[a] + GF_N - gf_log[b]];
+}
+
+static inline void rem_shl(uint64_t v[2], unsigned n)
+{
+    v[1] = (v[1] << n) | (v[0] >> (64 - n));
+    v[0] <<= n;
+}
+
+static inline bool rem_bit(const uint64_t v[2], unsigned bit)
+{
+    return (v[bit / 64] >> (bit % 64)) & 1;
+}
+
+static void bch_code_init(IngenicBchCode *code)
+{
+    // Generator polynomial, product of the minimal polynomials of
+    // alpha^1, alpha^3, ..., alpha^(2t-1), stored as bits of g
+    uint64_t g[2] = {1, 0};
+    bool done[2 * 8 + 1] = {false};
+    for (unsigned i = 1; i < 2 * code->t; i += 2) {
+        if (done[i])
+            continue;
+        // Minimal polynomial over GF(2^13), roots are the conjugates of alpha^i
+        uint16_t mp[GF_M + 1] = {1};
+        unsigned deg = 0;
+        unsigned e = i;
+        do {
+            if (e < ARRAY_SIZE(done))
+                done[e] = true;
+            // mp *= (x + alpha^e)
+            uint16_t root = gf_exp[e];
+            for (unsigned k = ++deg; k > 0; k--)
+                mp[k] = mp[k - 1] ^ gf_mul(mp[k], root);
+            mp[0] = gf_mul(mp[0], root);
+            e = (e * 2) % GF_N;
+        } while (e != i);
+        // g *= mp, coefficients of mp are 0 or 1
+        uint64_t prod[2] = {0, 0};
+        for (unsigned k = 0; k <= deg; k++) {
+            if (mp[k]) {
+                uint64_t sh[2] = {g[0], g[1]};
+                if (k)
+                    rem_shl(sh, k);
+                prod[0] ^= sh[0];
+                prod[1] ^= sh[1];
+            }
+        }
+        g[0] = prod[0];
+        g[1] = prod[1];
+    }
+
+    // Byte-wise remainder table, rem[v] = v(x) * x^r mod g(x)
+    unsigned r = code->r;
+    for (unsigned v = 0; v < 256; v++) {
+        uint64_t acc[2] = {0, 0};
+        for (int bit = 7; bit >= 0; bit--) {
+            bool top = rem_bit(acc, r - 1) ^ ((v >> bit) & 1);
+            rem_shl(acc, 1);
+            if (top) {
+                acc[0] ^= g[0];
+                acc[1] ^= g[1];
+            }
+            // Keep r bits
+            if (r < 64) {
+                acc[0] &= BIT_ULL(r) - 1;
+                acc[1] = 0;
+            } else {
+                acc[1] &= BIT_ULL(r - 64) - 1;
+            }
+        }
+        code->rem[v][0] = acc[0];
+        code->rem[v][1] = acc[1];
+    }
+}
+
+static void bch_tables_init(void)
+{
+    static bool initialized;
+    if (initialized)
+        return;
+    initialized = true;
+
+    uint32_t x = 1;
+    for (int i = 0; i < GF_N; i++) {
+        gf_exp[i] = x;
+        gf_exp[i + GF_N] = x;
+        gf_log[x] = i;
+        x <<= 1;
+        if (x & BIT(GF_M))
+            x ^= GF_POLY;
+    }
+    gf_log[0] = 0;
+
+    for (int i = 0; i < ARRAY_SIZE(bch_code); i++)
+        bch_code_init(&bch_code[i]);
+}
+
+// Remainder of the data polynomial times x^r modulo g(x).
+// Data bits are LSB first, the first bit is the highest power.
+static void bch_remainder(const IngenicBchCode *code, const uint8_t *data,
+                          unsigned len, uint64_t rem[2])
+{
+    unsigned r = code->r;
+    uint64_t lo = 0, hi = 0;
+    if (r <= 64) {
+        uint64_t mask = BIT_ULL(r) - 1;
+        for (unsigned i = 0; i < len; i++) {
+            uint8_t top = (lo >> (r - 8)) ^ revbit8(data[i]);
+            lo = ((lo << 8) & mask) ^ code->rem[top][0];
+        }
+    } else {
+        uint64_t mask = BIT_ULL(r - 64) - 1;
+        for (unsigned i = 0; i < len; i++) {
+            uint8_t top = (hi >> (r - 64 - 8)) ^ revbit8(data[i]);
+            hi = (((hi << 8) | (lo >> 56)) & mask) ^ code->rem[top][1];
+            lo = (lo << 8) ^ code->rem[top][0];
+        }
+    }
+    rem[0] = lo;
+    rem[1] = hi;
+}
+
+// Parity bit j is stored LSB first and corresponds to x^(r-1-j)
+static void bch_parity_to_rem(const IngenicBchCode *code, const uint8_t *par,
+                              uint64_t rem[2])
+{
+    rem[0] = rem[1] = 0;
+    for (unsigned j = 0; j < code->r; j++) {
+        if ((par[j / 8] >> (j % 8)) & 1) {
+            unsigned p = code->r - 1 - j;
+            rem[p / 64] |= BIT_ULL(p % 64);
+        }
+    }
+}
+
+static void bch_encode(const IngenicBchCode *code, const uint8_t *data,
+                       unsigned len, uint8_t *par)
+{
+    uint64_t rem[2];
+    bch_remainder(code, data, len, rem);
+    memset(par, 0, DIV_ROUND_UP(code->r, 8));
+    for (unsigned j = 0; j < code->r; j++)
+        if (rem_bit(rem, code->r - 1 - j))
+            par[j / 8] |= BIT(j % 8);
+}
+
+// Returns number of errors found and their 1-based bit indices,
+// or -1 if the errors are uncorrectable
+static int bch_decode(const IngenicBchCode *code, const uint8_t *data,
+                      unsigned len, const uint8_t *par, uint16_t *err_idx)
+{
+    unsigned t = code->t, r = code->r;
+    uint64_t rem[2], prem[2];
+    bch_remainder(code, data, len, rem);
+    bch_parity_to_rem(code, par, prem);
+    rem[0] ^= prem[0];
+    rem[1] ^= prem[1];
+    if (!rem[0] && !rem[1])
+        return 0;
+
+    // Syndromes S[i] = R(alpha^i), i = 1..2t
+    uint16_t syn[2 * 8 + 1] = {0};
+    for (unsigned i = 1; i <= 2 * t; i += 2) {
+        uint16_t s = 0;
+        for (unsigned p = 0; p < r; p++)
+            if (rem_bit(rem, p))
+                s ^= gf_exp[(i * p) % GF_N];
+        syn[i] = s;
+    }
+    for (unsigned i = 2; i <= 2 * t; i += 2)
+        syn[i] = gf_mul(syn[i / 2], syn[i / 2]);
+
+    // Berlekamp-Massey
+    uint16_t lambda[8 + 2] = {1}, prev[8 + 2] = {1}, tmp[8 + 2];
+    unsigned deg = 0, m = 1;
+    uint16_t b = 1;
+    for (unsigned n = 0; n < 2 * t; n++) {
+        uint16_t d = syn[n + 1];
+        for (unsigned i = 1; i <= deg; i++)
+            d ^= gf_mul(lambda[i], syn[n + 1 - i]);
+        if (!d) {
+            m++;
+            continue;
+        }
+        uint16_t coef = gf_div(d, b);
+        memcpy(tmp, lambda, sizeof(tmp));
+        for (unsigned i = 0; i + m < ARRAY_SIZE(lambda); i++)
+            lambda[i + m] ^= gf_mul(coef, prev[i]);
+        if (2 * deg <= n) {
+            deg = n + 1 - deg;
+            memcpy(prev, tmp, sizeof(prev));
+            b = d;
+            m = 1;
+        } else {
+            m++;
+        }
+    }
+    if (deg > t)
+        return -1;
+
+    // Chien search over all codeword positions
+    unsigned nbits = 8 * len + r;
+    int nerr = 0;
+    for (unsigned p = 0; p < nbits && nerr < deg; p++) {
+        // Evaluate lambda(alpha^-p)
+        uint16_t v = 1;
+        unsigned inv = (GF_N - p % GF_N) % GF_N;
+        for (unsigned i = 1; i <= deg; i++)
+            if (lambda[i])
+                v ^= gf_exp[(gf_log[lambda[i]] + inv * i) % GF_N];
+        if (v)
+            continue;
+        if (p >= r)
+            err_idx[nerr++] = (r + 8 * len - 1 - p) + 1;
+        else
+            err_idx[nerr++] = 8 * len + (r - 1 - p) + 1;
+    }
+    if (nerr != deg)
+        return -1;
+    return nerr;
+}
+
+static void ingenic_bch_process(IngenicBch *s)
+{
+    const IngenicBchCode *code = &bch_code[!!(s->bhcr & BHCR_BSEL8)];
+    unsigned pbytes = DIV_ROUND_UP(code->r, 8);
+    unsigned len = MIN(s->nbytes, sizeof(s->buf));
+
+    if (s->mask_and == s->mask_or && s->mask_or == 0)
+        s->bhint |= BHINT_ALL0;
+    if (s->mask_and == s->mask_or && s->mask_or == 0xff)
+        s->bhint |= BHINT_ALLF;
+
+    if (s->bhcr & BHCR_ENCE) {
+        uint8_t par[16] = {0};
+        bch_encode(code, s->buf, len, par);
+        for (int i = 0; i < 4; i++)
+            s->bhpar[i] = ldl_le_p(&par[4 * i]);
+        trace_ingenic_bch_encode(len, code->t);
+        s->bhint |= BHINT_ENCF;
+        return;
+    }
+
+    // Decoding, parity bytes follow the data
+    int nerr = 0;
+    uint16_t err_idx[8];
+    if (len < pbytes) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Decoding %u bytes without parity\n", __func__, len);
+        nerr = -1;
+    } else if (!(s->bhint & BHINT_ALLF)) {
+        // Erased pages have no valid parity
+        len -= pbytes;
+        nerr = bch_decode(code, s->buf, len, &s->buf[len], err_idx);
+    }
+    trace_ingenic_bch_decode(len, code->t, nerr);
+    for (int i = 0; i < 4; i++)
+        s->bherr[i] = 0;
+    if (nerr < 0) {
+        s->bhint |= BHINT_ERR | BHINT_UNCOR;
+    } else if (nerr > 0) {
+        s->bhint |= BHINT_ERR | (nerr << BHINT_ERRC_SHIFT);
+        for (int i = 0; i < nerr; i++)
+            s->bherr[i / 2] |= (uint32_t)err_idx[i] << (16 * (i % 2));
+    }
+    s->bhint |= BHINT_DECF;
+}
+
+void ingenic_bch_feed(IngenicBch *s, const uint8_t *buf, uint32_t len)
+{
+    uint32_t count = (s->bhcr & BHCR_ENCE) ?
+        /* Encoding */ s->bhcnt & 0xffff :
+        /* Decoding */ s->bhcnt >> 16;
+    while (len && s->nbytes < count) {
+        uint32_t n = MIN(len, count - s->nbytes);
+        for (uint32_t i = 0; i < n; i++) {
+            s->mask_and &= buf[i];
+            s->mask_or  |= buf[i];
+        }
+        if (s->nbytes < sizeof(s->buf))
+            memcpy(&s->buf[s->nbytes], buf, MIN(n, sizeof(s->buf) - s->nbytes));
+        s->nbytes += n;
+        buf += n;
+        len -= n;
+        if (s->nbytes == count) {
+            // ECC done, update interrupts
+            ingenic_bch_process(s);
+        }
+    }
+}
+
 static void ingenic_bch_reset(Object *obj, ResetType type)
 {
     IngenicBch *s = INGENIC_BCH(obj);
     s->nbytes = 0;
+    s->mask_and = 0xff;
+    s->mask_or = 0;
 
     s->bhcr = 0;
     s->bhcnt = 0;
@@ -83,8 +419,12 @@ static uint64_t ingenic_bch_read(void *opaque, hwaddr addr, unsigned size)
     case REG_BHINTE:
         data = s->bhinte;
         break;
-    case REG_BHPAR0 ... REG_BHPAR3:
-        data = 0xdeadbeef; //s->bhpar[(addr - REG_BHPAR0) / 4];
+    case REG_BHPAR0 ... REG_BHPAR3 + 3:
+        // Parity may be read byte by byte
+        for (int i = 0; i < size && addr + i <= REG_BHPAR3 + 3; i++) {
+            uint32_t ofs = addr - REG_BHPAR0 + i;
+            data |= (uint64_t)((s->bhpar[ofs / 4] >> (8 * (ofs % 4))) & 0xff) << (8 * i);
+        }
         break;
     case REG_BHERR0 ... REG_BHERR3:
         data = s->bherr[(addr - REG_BHERR0) / 4];
@@ -126,26 +466,12 @@ static void ingenic_bch_write(void *opaque, hwaddr addr, uint64_t data, unsigned
     case REG_BHCNT:
         s->bhcnt = data & 0x03ff03ff;
         break;
-    case REG_BHDR:
-        // Data register
-        // Only update interrupts, ECC algorithm isn't implemented yet
-        s->mask_and &= data;
-        s->mask_or  |= data;
-        s->nbytes   += 1;
-        if (s->nbytes == ((s->bhcr & BIT(3)) ?
-            /* Encoding */ s->bhcnt & 0xffff :
-            /* Decoding */ s->bhcnt >> 16)) {
-            // ECC done, update interrupts
-            if (s->mask_and == s->mask_or && s->mask_or == 0)
-                s->bhint |= BIT(5);     // All 0x00
-            if (s->mask_and == s->mask_or && s->mask_or == 0xff)
-                s->bhint |= BIT(4);     // All 0xff
-            if (s->bhcr & BIT(3))
-                s->bhint |= BIT(2);     // Encoding finished
-            else
-                s->bhint |= BIT(3);     // Decoding finished
-        }
+    case REG_BHDR: {
+        // Data register, buffered until the whole block arrived
+        uint8_t b = data;
+        ingenic_bch_feed(s, &b, 1);
         break;
+    }
     case REG_BHINT:
         s->bhint &= ~data & 0x3f;
         break;
@@ -191,8 +517,32 @@ static void ingenic_bch_finalize(Object *obj)
 {
 }
 
+static const VMStateDescription vmstate_ingenic_bch = {
+    .name = "ingenic-bch",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT8_ARRAY(buf, IngenicBch, 1024),
+        VMSTATE_UINT32(nbytes, IngenicBch),
+        VMSTATE_UINT8(mask_and, IngenicBch),
+        VMSTATE_UINT8(mask_or, IngenicBch),
+        VMSTATE_UINT8(bhcr, IngenicBch),
+        VMSTATE_UINT8(bhinte, IngenicBch),
+        VMSTATE_UINT32(bhint, IngenicBch),
+        VMSTATE_UINT32(bhcnt, IngenicBch),
+        VMSTATE_UINT32_ARRAY(bhpar, IngenicBch, 4),
+        VMSTATE_UINT32_ARRAY(bherr, IngenicBch, 4),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static void ingenic_bch_class_init(ObjectClass *class, void *data)
 {
+    DeviceClass *dc = DEVICE_CLASS(class);
+    dc->vmsd = &vmstate_ingenic_bch;
+
+    bch_tables_init();
+
     IngenicBchClass *bch_class = INGENIC_BCH_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
@@ -285,8 +285,47 @@ static void ingenic_emc_finalize(Object *obj)
 {
 }
 
+static int ingenic_emc_post_load(void *opaque, int version_id)
+{
+    IngenicEmc *s = opaque;
+    ingenic_emc_sdram_post_load(s);
+    return 0;
+}
+
+static const VMStateDescription vmstate_ingenic_emc = {
+    .name = "ingenic-emc",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_emc_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(BCR, IngenicEmc),
+        VMSTATE_UINT32_ARRAY(SMCR, IngenicEmc, 4),
+        VMSTATE_UINT16_ARRAY(SACR, IngenicEmc, 4),
+        VMSTATE_UINT32(NFCSR, IngenicEmc),
+        // SDRAM configuration
+        VMSTATE_UINT32(sdram_cfg.reg.dmcr, IngenicEmc),
+        VMSTATE_UINT16(sdram_cfg.reg.rtcsr, IngenicEmc),
+        VMSTATE_UINT16(sdram_cfg.reg.rtcnt, IngenicEmc),
+        VMSTATE_UINT16(sdram_cfg.reg.rtcor, IngenicEmc),
+        VMSTATE_UINT16_ARRAY(sdram_cfg.reg.dmar, IngenicEmc, 2),
+        // NAND ECC
+        VMSTATE_UINT8_ARRAY(nand_ecc.buf, IngenicEmc, 512 + 2),
+        VMSTATE_UINT32(nand_ecc.data_count, IngenicEmc),
+        VMSTATE_UINT8(nand_ecc.reg.nfeccr, IngenicEmc),
+        VMSTATE_UINT32(nand_ecc.reg.nfecc, IngenicEmc),
+        VMSTATE_UINT32_ARRAY(nand_ecc.reg.nfpar, IngenicEmc, 3),
+        VMSTATE_UINT32(nand_ecc.reg.nfints, IngenicEmc),
+        VMSTATE_UINT8(nand_ecc.reg.nfinte, IngenicEmc),
+        VMSTATE_UINT32_ARRAY(nand_ecc.reg.nferr, IngenicEmc, 4),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static void ingenic_emc_class_init(ObjectClass *class, void *data)
 {
+    DeviceClass *dc = DEVICE_CLASS(class);
+    dc->vmsd = &vmstate_ingenic_emc;
+
     IngenicEmcClass *emc_class = INGENIC_EMC_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
@@ -22,6 +22,7 @@
 #include "qapi/error.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
+#include "qemu/host-utils.h"
 #include "migration/vmstate.h"
 #include "exec/address-spaces.h"
 #include "sysemu/block-backend.h"
@@ -45,6 +46,19 @@
 #define REG_NFERR2  0x0124
 #define REG_NFERR3  0x0128
 
+#define NFECCR_ECCE     BIT(0)
+#define NFECCR_ERST     BIT(1)
+#define NFECCR_RS       BIT(2)
+#define NFECCR_ENCE     BIT(3)
+#define NFECCR_PRDY     BIT(4)
+
+#define NFINTS_ERR      BIT(0)
+#define NFINTS_UNCOR    BIT(1)
+#define NFINTS_ENCF     BIT(2)
+#define NFINTS_DECF     BIT(3)
+#define NFINTS_PADF     BIT(4)
+#define NFINTS_ERRC_SHIFT   29
+
 #define CMD_READ            0x00
 #define CMD_READ_NORMAL     0x30
 #define CMD_READ_STATUS     0x70
@@ -57,39 +71,190 @@
 
 void qmp_stop(Error **errp);
 
+static void nand_io_complete(void *opaque, int ret)
+{
+    IngenicEmcNand *nand = opaque;
+    nand->aiocb = NULL;
+    if (unlikely(ret < 0)) {
+        printf("%s: I/O error at address 0x%"PRIx64"\n", __func__, nand->addr);
+        qmp_stop(NULL);
+    }
+    // Ready
+    trace_ingenic_nand_ready(nand->cs, ret);
+    nand->status |= BIT(6);
+    qemu_irq_raise(nand->emc->io_nand_rb);
+}
+
+// Inverted media stores every byte complemented, so erased blocks are zeros
+static void nand_invert(IngenicEmcNand *nand, uint8_t *buf, size_t len)
+{
+    if (!nand->invert)
+        return;
+    for (size_t i = 0; i < len; i++)
+        buf[i] = ~buf[i];
+}
+
+static void nand_read_complete(void *opaque, int ret)
+{
+    IngenicEmcNand *nand = opaque;
+    nand_invert(nand, nand->buf, nand->page_size + nand->oob_size);
+    nand_io_complete(nand, ret);
+}
+
+static void nand_io_wait(IngenicEmcNand *nand)
+{
+    // Guest did not wait for R/B#, complete pending I/O first
+    if (unlikely(nand->aiocb))
+        blk_drain(nand->blk);
+}
+
+// Sequential read prefetch cache
+
+typedef struct IngenicEmcNandReadahead {
+    IngenicEmcNand *nand;
+    QEMUIOVector qiov;
+    uint8_t *buf;
+    uint32_t row;
+    uint32_t pages;
+    uint32_t gen;
+    bool sync;
+} IngenicEmcNandReadahead;
+
+static int nand_cache_lookup(IngenicEmcNand *nand, uint32_t row)
+{
+    for (int i = 0; i < nand->cache_pages; i++)
+        if (nand->cache_row[i] == row)
+            return i;
+    return -1;
+}
+
+static void nand_cache_insert(IngenicEmcNand *nand, uint32_t row, const uint8_t *data)
+{
+    uint32_t len = nand->page_size + nand->oob_size;
+    int idx = nand_cache_lookup(nand, row);
+    if (idx < 0) {
+        // Replace the least recently used entry
+        idx = 0;
+        for (int i = 1; i < nand->cache_pages; i++)
+            if (nand->cache_lru[i] < nand->cache_lru[idx])
+                idx = i;
+        nand->cache_row[idx] = row;
+    }
+    nand->cache_lru[idx] = ++nand->cache_clock;
+    memcpy(&nand->cache_data[idx * len], data, len);
+}
+
+static void nand_cache_invalidate(IngenicEmcNand *nand, uint32_t row, uint32_t pages)
+{
+    // Drop cached pages and any readahead still in flight
+    nand->cache_gen++;
+    for (int i = 0; i < nand->cache_pages; i++) {
+        if (nand->cache_row[i] >= row && nand->cache_row[i] - row < pages) {
+            nand->cache_row[i] = UINT32_MAX;
+            nand->cache_lru[i] = 0;
+        }
+    }
+}
+
+static void nand_readahead_complete(void *opaque, int ret)
+{
+    IngenicEmcNandReadahead *ra = opaque;
+    IngenicEmcNand *nand = ra->nand;
+    uint32_t len = nand->page_size + nand->oob_size;
+    nand_invert(nand, ra->buf, (size_t)ra->pages * len);
+    if (ret >= 0 && ra->gen == nand->cache_gen)
+        for (uint32_t i = 0; i < ra->pages; i++)
+            nand_cache_insert(nand, ra->row + i, &ra->buf[i * len]);
+    trace_ingenic_nand_readahead(nand->cs, ra->row, ra->pages, ra->sync);
+    if (ra->sync) {
+        memcpy(nand->buf, ra->buf, len);
+        nand_io_complete(nand, ret);
+    } else {
+        nand->prefetch_aiocb = NULL;
+    }
+    g_free(ra->buf);
+    g_free(ra);
+}
+
+static BlockAIOCB *nand_readahead(IngenicEmcNand *nand, uint32_t row, bool sync)
+{
+    uint32_t len = nand->page_size + nand->oob_size;
+    IngenicEmcNandReadahead *ra = g_new0(IngenicEmcNandReadahead, 1);
+    ra->nand = nand;
+    ra->row = row;
+    ra->pages = MIN(nand->prefetch_pages, nand->total_pages - row);
+    ra->gen = nand->cache_gen;
+    ra->sync = sync;
+    ra->buf = g_malloc((size_t)ra->pages * len);
+    qemu_iovec_init_buf(&ra->qiov, ra->buf, (size_t)ra->pages * len);
+    return blk_aio_preadv(nand->blk, (uint64_t)row * len, &ra->qiov, 0,
+                          nand_readahead_complete, ra);
+}
+
 static void nand_read_page(IngenicEmcNand *nand)
 {
     uint64_t row = nand->addr >> 16;
+    uint32_t len = nand->page_size + nand->oob_size;
     nand->page_ofs = nand->addr % (nand->page_size * 2);
-    if (unlikely(blk_pread(nand->blk, row * (nand->page_size + nand->oob_size),
-                           nand->page_size + nand->oob_size, nand->buf, 0) < 0)) {
-        printf("%s: read error at address 0x%"PRIx64"\n", __func__, nand->addr);
-        qmp_stop(NULL);
+    if (!nand->prefetch_pages || row >= nand->total_pages) {
+        qemu_iovec_init_buf(&nand->qiov, nand->buf, len);
+        nand->aiocb = blk_aio_preadv(nand->blk, row * len,
+                                     &nand->qiov, 0, nand_read_complete, nand);
+        return;
+    }
+
+    int idx = nand_cache_lookup(nand, row);
+    if (idx < 0) {
+        // Fetch the requested page together with the following window
+        nand->cache_misses++;
+        nand->aiocb = nand_readahead(nand, row, true);
+        return;
+    }
+
+    nand->cache_hits++;
+    nand->cache_lru[idx] = ++nand->cache_clock;
+    memcpy(nand->buf, &nand->cache_data[idx * len], len);
+    // Refill the window once the guest is halfway through it
+    uint32_t next = row + nand->prefetch_pages / 2;
+    if (!nand->prefetch_aiocb && next < nand->total_pages &&
+        nand_cache_lookup(nand, next) < 0) {
+        while (nand_cache_lookup(nand, row + 1) >= 0)
+            row++;
+        if (row + 1 < nand->total_pages)
+            nand->prefetch_aiocb = nand_readahead(nand, row + 1, false);
     }
+    nand_io_complete(nand, 0);
 }
 
 static void nand_write_page(IngenicEmcNand *nand)
 {
     uint64_t row = nand->addr >> 16;
     uint64_t page_ofs = nand->addr % (nand->page_size * 2);
-    if (unlikely(blk_pwrite(nand->blk,
-                            row * (nand->page_size + nand->oob_size) + page_ofs,
-                            nand->page_ofs, nand->buf, 0) < 0)) {
-        printf("%s: write error at address 0x%"PRIx64"\n", __func__, nand->addr);
-        qmp_stop(NULL);
-    }
+    nand_cache_invalidate(nand, row, 1);
+    nand_invert(nand, nand->buf, nand->page_ofs);
+    qemu_iovec_init_buf(&nand->qiov, nand->buf, nand->page_ofs);
+    nand->aiocb = blk_aio_pwritev(nand->blk,
+                                  row * (nand->page_size + nand->oob_size) + page_ofs,
+                                  &nand->qiov, 0, nand_io_complete, nand);
 }
 
 static void nand_erase_block(IngenicEmcNand *nand)
 {
+    // Erased NAND reads back as 0xff, write from the pre-filled erase buffer
     uint64_t row = nand->addr;
     uint32_t block_ofs = row / nand->block_pages;
     uint32_t block_len = nand->block_pages * (nand->page_size + nand->oob_size);
-    memset(nand->buf, 0xff, block_len);
-    if (unlikely(blk_pwrite(nand->blk, block_ofs * block_len, block_len, nand->buf, 0) < 0)) {
-        printf("%s: write error at address 0x%"PRIx64"\n", __func__, nand->addr);
-        qmp_stop(NULL);
+    nand_cache_invalidate(nand, block_ofs * nand->block_pages, nand->block_pages);
+    if (nand->invert) {
+        // Zeroes are a metadata-only update on qcow2 overlays and sparse files
+        nand->aiocb = blk_aio_pwrite_zeroes(nand->blk, (uint64_t)block_ofs * block_len,
+                                            block_len, BDRV_REQ_MAY_UNMAP,
+                                            nand_io_complete, nand);
+        return;
     }
+    qemu_iovec_init_buf(&nand->qiov, nand->erase_buf, block_len);
+    nand->aiocb = blk_aio_pwritev(nand->blk, (uint64_t)block_ofs * block_len,
+                                  &nand->qiov, 0, nand_io_complete, nand);
 }
 
 static uint64_t ingenic_nand_io_read(void *opaque, hwaddr addr, unsigned size)
@@ -104,6 +269,15 @@ static uint64_t ingenic_nand_io_read(void *opaque, hwaddr addr, unsigned size)
         return 0;
     }
 
+    if (nand->prev_cmd == CMD_READ_STATUS) {
+        // Status can be polled while busy
+        for (int i = 0; i < size; i++)
+            data |= (uint64_t)nand->status << (8 * i);
+        trace_ingenic_nand_read(addr, data);
+        return data;
+    }
+
+    nand_io_wait(nand);
     for (int i = 0; i < size; i++) {
         if (unlikely(nand->page_ofs >= nand->page_size + nand->oob_size)) {
             qemu_log_mask(LOG_GUEST_ERROR, "%s: Bank %u read beyond page+oob size\n", __func__, bank);
@@ -113,10 +287,39 @@ static uint64_t ingenic_nand_io_read(void *opaque, hwaddr addr, unsigned size)
             nand->page_ofs++;
         }
     }
+    // ECC snoops the data bus
+    if (nand->page_ofs >= size)
+        ingenic_emc_nand_ecc_feed(nand->emc, &nand->buf[nand->page_ofs - size], size);
     trace_ingenic_nand_read(addr, data);
     return data;
 }
 
+uint32_t ingenic_emc_nand_data_read(IngenicEmcNand *nand, uint8_t *buf, uint32_t len)
+{
+    if (nand->prev_cmd == CMD_READ_STATUS) {
+        memset(buf, nand->status, len);
+        trace_ingenic_nand_read_bulk(nand->cs, nand->page_ofs, len);
+        return len;
+    }
+
+    // Same as a run of data port reads, with a single copy and ECC feed
+    nand_io_wait(nand);
+    uint32_t end = nand->page_size + nand->oob_size;
+    uint32_t n = nand->page_ofs < end ? MIN(len, end - nand->page_ofs) : 0;
+    memcpy(buf, &nand->buf[nand->page_ofs], n);
+    if (unlikely(n < len)) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bank %u read beyond page+oob size\n", __func__, nand->cs);
+        qmp_stop(NULL);
+        memset(&buf[n], 0, len - n);
+    }
+    trace_ingenic_nand_read_bulk(nand->cs, nand->page_ofs, n);
+    nand->page_ofs += n;
+    // ECC snoops the data bus
+    if (n)
+        ingenic_emc_nand_ecc_feed(nand->emc, buf, n);
+    return len;
+}
+
 static void ingenic_nand_io_write(void *opaque, hwaddr addr, uint64_t data, unsigned size)
 {
     IngenicEmcNand *nand = INGENIC_EMC_NAND(opaque);
@@ -135,6 +338,9 @@ static void ingenic_nand_io_write(void *opaque, hwaddr addr, uint64_t data, unsi
         qmp_stop(NULL);
     }
     addr = addr % 0x00100000;
+    // Only status polling may proceed while the page I/O is in flight
+    if (!(addr >= 0x008000 && addr < 0x010000 && data == CMD_READ_STATUS))
+        nand_io_wait(nand);
 
     if (addr >= 0x0c0000) {
         // Reserved
@@ -194,8 +400,6 @@ static void ingenic_nand_io_write(void *opaque, hwaddr addr, uint64_t data, unsi
             nand->status = nand->writable ? BIT(7) : 0;
             qemu_irq_lower(emc->io_nand_rb);
             nand_read_page(nand);
-            nand->status |= BIT(6);
-            qemu_irq_raise(emc->io_nand_rb);
             break;
         case CMD_PROGRAM:
             trace_ingenic_nand_cmd(bank, "CMD_PROGRAM", 0);
@@ -212,8 +416,6 @@ static void ingenic_nand_io_write(void *opaque, hwaddr addr, uint64_t data, unsi
             nand->status = nand->writable ? BIT(7) : 0;
             qemu_irq_lower(emc->io_nand_rb);
             nand_write_page(nand);
-            nand->status |= BIT(6);
-            qemu_irq_raise(emc->io_nand_rb);
             break;
         case CMD_ERASE:
             trace_ingenic_nand_cmd(bank, "CMD_ERASE", 0);
@@ -230,13 +432,10 @@ static void ingenic_nand_io_write(void *opaque, hwaddr addr, uint64_t data, unsi
             nand->status = nand->writable ? BIT(7) : 0;
             qemu_irq_lower(emc->io_nand_rb);
             nand_erase_block(nand);
-            nand->status |= BIT(6);
-            qemu_irq_raise(emc->io_nand_rb);
             break;
         case CMD_READ_STATUS:
             trace_ingenic_nand_cmd(bank, "CMD_READ_STATUS", nand->status);
             nand->page_ofs = 0;
-            nand->buf[0] = nand->status;
             break;
         case CMD_READ_ID:
             trace_ingenic_nand_cmd(bank, "CMD_READ_ID", nand->nand_id);
@@ -253,16 +452,18 @@ static void ingenic_nand_io_write(void *opaque, hwaddr addr, uint64_t data, unsi
 
     } else {
         // Data space
+        uint8_t bytes[8];
+        stq_le_p(bytes, data);
         for (int i = 0; i < size; i++) {
             if (unlikely(nand->page_ofs >= nand->page_size + nand->oob_size)) {
                 qemu_log_mask(LOG_GUEST_ERROR, "%s: Bank %u write beyond page+oob size\n", __func__, bank);
                 qmp_stop(NULL);
             } else {
-                nand->buf[nand->page_ofs] = data >> (8 * i);
+                nand->buf[nand->page_ofs] = bytes[i];
                 nand->page_ofs++;
             }
         }
-        ingenic_emc_nand_ecc_data(nand->emc, data, size);
+        ingenic_emc_nand_ecc_feed(nand->emc, bytes, size);
     }
 }
 
@@ -329,15 +530,31 @@ static void ingenic_emc_nand_realize(DeviceState *dev, Error **errp)
     }
     //qemu_log("\n");
 
-    s->buf = g_new(uint8_t, s->block_pages * (s->page_size + s->oob_size));
+    s->buf_size = s->page_size + s->oob_size;
+    s->buf = g_new(uint8_t, s->buf_size);
+    s->erase_buf = g_malloc(s->block_pages * (s->page_size + s->oob_size));
+    memset(s->erase_buf, 0xff, s->block_pages * (s->page_size + s->oob_size));
+
+    // Keep two prefetch windows in the page cache
+    s->cache_pages = 2 * s->prefetch_pages;
+    s->cache_data = g_malloc((size_t)s->cache_pages * (s->page_size + s->oob_size));
+    s->cache_row = g_new(uint32_t, s->cache_pages);
+    s->cache_lru = g_new0(uint64_t, s->cache_pages);
+    for (int i = 0; i < s->cache_pages; i++)
+        s->cache_row[i] = UINT32_MAX;
 }
 
 static void ingenic_emc_nand_unrealize(DeviceState *dev)
 {
     // Deregister with EMC
     IngenicEmcNand *s = INGENIC_EMC_NAND(dev);
+    blk_drain(s->blk);
     s->emc->nand[s->cs - 1] = NULL;
     g_free(s->buf);
+    g_free(s->erase_buf);
+    g_free(s->cache_data);
+    g_free(s->cache_row);
+    g_free(s->cache_lru);
 }
 
 OBJECT_DEFINE_TYPE(IngenicEmcNand, ingenic_emc_nand, INGENIC_EMC_NAND, DEVICE)
@@ -346,19 +563,49 @@ static void ingenic_emc_nand_init(Object *obj)
 {
     IngenicEmcNand *s = INGENIC_EMC_NAND(obj);
     memory_region_init_io(&s->mr, obj, &nand_io_ops, s, "emc.nand", 0x04000000);
+    object_property_add_uint64_ptr(obj, "prefetch-hits", &s->cache_hits,
+                                   OBJ_PROP_FLAG_READ);
+    object_property_add_uint64_ptr(obj, "prefetch-misses", &s->cache_misses,
+                                   OBJ_PROP_FLAG_READ);
 }
 
 static void ingenic_emc_nand_finalize(Object *obj)
 {
 }
 
+static int ingenic_emc_nand_post_load(void *opaque, int version_id)
+{
+    IngenicEmcNand *s = opaque;
+    // Prefetched pages are not migrated, the image may have changed meanwhile
+    nand_cache_invalidate(s, 0, UINT32_MAX);
+    return 0;
+}
+
+static const VMStateDescription vmstate_ingenic_emc_nand = {
+    .name = "ingenic-emc-nand",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_emc_nand_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT8(prev_cmd, IngenicEmcNand),
+        VMSTATE_UINT8(status, IngenicEmcNand),
+        VMSTATE_UINT32(addr_ofs, IngenicEmcNand),
+        VMSTATE_UINT64(addr, IngenicEmcNand),
+        VMSTATE_VBUFFER_UINT32(buf, IngenicEmcNand, 1, NULL, buf_size),
+        VMSTATE_UINT32(page_ofs, IngenicEmcNand),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static Property ingenic_emc_nand_properties[] = {
     DEFINE_PROP_DRIVE("drive", IngenicEmcNand, blk),
     DEFINE_PROP_UINT32("block-pages", IngenicEmcNand, block_pages, 128),
     DEFINE_PROP_UINT32("page-size", IngenicEmcNand, page_size, 2048),
     DEFINE_PROP_UINT32("oob-size", IngenicEmcNand, oob_size, 64),
     DEFINE_PROP_UINT32("cs", IngenicEmcNand, cs, 1),
+    DEFINE_PROP_UINT32("prefetch-pages", IngenicEmcNand, prefetch_pages, 8),
     DEFINE_PROP_STRING("nand-id", IngenicEmcNand, nand_id_str),
+    DEFINE_PROP_BOOL("invert", IngenicEmcNand, invert, false),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -369,13 +616,240 @@ static void ingenic_emc_nand_class_init(ObjectClass *class, void *data)
     set_bit(DEVICE_CATEGORY_STORAGE, dc->categories);
     dc->realize = ingenic_emc_nand_realize;
     dc->unrealize = ingenic_emc_nand_unrealize;
+    dc->vmsd = &vmstate_ingenic_emc_nand;
 }
 
 
 // EMC NAND ECC module
 
+// JZ4740 Reed-Solomon ECC, 9-bit symbols, 4 symbol errors per 512 bytes
+
+#define RS_M        9
+#define RS_N        ((1 << RS_M) - 1)
+#define RS_POLY     0x211
+#define RS_FCR      1
+#define RS_NPAR     8
+#define RS_DATA     DIV_ROUND_UP(512 * 8, RS_M)
+
+static uint16_t rs_exp[2 * RS_N];
+static uint16_t rs_log[RS_N + 1];
+static uint16_t rs_gen[RS_NPAR + 1];
+
+static inline uint16_t rs_mul(uint16_t a, uint16_t b)
+{
+    if (!a || !b)
+        return 0;
+    return rs_exp[rs_log[a] + rs_log[b]];
+}
+
+static void rs_tables_init(void)
+{
+    static bool initialized;
+    if (initialized)
+        return;
+    initialized = true;
+
+    uint32_t x = 1;
+    for (int i = 0; i < RS_N; i++) {
+        rs_exp[i] = x;
+        rs_exp[i + RS_N] = x;
+        rs_log[x] = i;
+        x <<= 1;
+        if (x & BIT(RS_M))
+            x ^= RS_POLY;
+    }
+
+    // Generator polynomial, product of (x + alpha^(FCR+i)), rs_gen[0] is x^8
+    rs_gen[0] = 1;
+    for (int i = 0; i < RS_NPAR; i++) {
+        uint16_t root = rs_exp[RS_FCR + i];
+        for (int j = i + 1; j > 0; j--)
+            rs_gen[j] ^= rs_mul(rs_gen[j - 1], root);
+    }
+}
+
+// Symbol i covers data bits [9i, 9i+9), LSB first, zero padded
+static inline uint16_t rs_get_sym(const uint8_t *buf, unsigned len, unsigned i)
+{
+    unsigned bit = i * RS_M;
+    uint32_t v = 0;
+    for (unsigned b = bit / 8; b <= (bit + RS_M - 1) / 8 && b < len; b++)
+        v |= (uint32_t)buf[b] << (8 * (b - bit / 8));
+    return (v >> (bit % 8)) & RS_N;
+}
+
+static inline void rs_put_sym(uint8_t *buf, unsigned i, uint16_t sym)
+{
+    unsigned bit = i * RS_M;
+    for (unsigned k = 0; k < RS_M; k++, bit++) {
+        if ((sym >> k) & 1)
+            buf[bit / 8] |= BIT(bit % 8);
+        else
+            buf[bit / 8] &= ~BIT(bit % 8);
+    }
+}
+
+// The first data symbol is the highest power of the codeword polynomial
+static void rs_encode(const uint8_t *data, uint16_t *par)
+{
+    memset(par, 0, sizeof(uint16_t) * RS_NPAR);
+    for (unsigned i = 0; i < RS_DATA; i++) {
+        uint16_t fb = rs_get_sym(data, 512, i) ^ par[0];
+        memmove(&par[0], &par[1], sizeof(uint16_t) * (RS_NPAR - 1));
+        par[RS_NPAR - 1] = 0;
+        if (fb)
+            for (int j = 0; j < RS_NPAR; j++)
+                par[j] ^= rs_mul(fb, rs_gen[j + 1]);
+    }
+}
+
+// Returns number of errors, or -1 if uncorrectable.
+// err_pos is the 0-based symbol index, parity symbols follow the data.
+// err_val holds the bits to flip.
+static int rs_decode(const uint8_t *data, const uint16_t *par,
+                     uint16_t *err_pos, uint16_t *err_val)
+{
+    const unsigned n = RS_DATA + RS_NPAR;
+    uint16_t syn[RS_NPAR];
+    bool has_err = false;
+    for (int i = 0; i < RS_NPAR; i++) {
+        // Horner evaluation at alpha^(FCR+i), highest power first
+        uint16_t root = rs_exp[RS_FCR + i];
+        uint16_t s = 0;
+        for (unsigned k = 0; k < n; k++) {
+            uint16_t c = k < RS_DATA ? rs_get_sym(data, 512, k) : par[k - RS_DATA];
+            s = rs_mul(s, root) ^ c;
+        }
+        syn[i] = s;
+        has_err |= s != 0;
+    }
+    if (!has_err)
+        return 0;
+
+    // Berlekamp-Massey
+    uint16_t lambda[RS_NPAR + 1] = {1}, prev[RS_NPAR + 1] = {1}, tmp[RS_NPAR + 1];
+    unsigned deg = 0, m = 1;
+    uint16_t b = 1;
+    for (unsigned r = 0; r < RS_NPAR; r++) {
+        uint16_t d = syn[r];
+        for (unsigned i = 1; i <= deg; i++)
+            d ^= rs_mul(lambda[i], syn[r - i]);
+        if (!d) {
+            m++;
+            continue;
+        }
+        uint16_t coef = rs_exp[rs_log[d] + RS_N - rs_log[b]];
+        memcpy(tmp, lambda, sizeof(tmp));
+        for (unsigned i = 0; i + m <= RS_NPAR; i++)
+            lambda[i + m] ^= rs_mul(coef, prev[i]);
+        if (2 * deg <= r) {
+            deg = r + 1 - deg;
+            memcpy(prev, tmp, sizeof(prev));
+            b = d;
+            m = 1;
+        } else {
+            m++;
+        }
+    }
+    if (deg > RS_NPAR / 2)
+        return -1;
+
+    // Error evaluator omega = (S * lambda) mod x^NPAR
+    uint16_t omega[RS_NPAR] = {0};
+    for (int i = 0; i < RS_NPAR; i++)
+        for (int j = 0; j <= i && j <= deg; j++)
+            omega[i] ^= rs_mul(lambda[j], syn[i - j]);
+
+    // Chien search and Forney
+    int nerr = 0;
+    for (unsigned p = 0; p < n; p++) {
+        // Position p is x^p, check lambda(alpha^-p)
+        unsigned inv = (RS_N - p) % RS_N;
+        uint16_t v = 0, dv = 0;
+        for (unsigned i = 0; i <= deg; i++) {
+            if (!lambda[i])
+                continue;
+            uint16_t t = rs_exp[(rs_log[lambda[i]] + inv * i) % RS_N];
+            v ^= t;
+            // Formal derivative keeps odd terms, divided by x
+            if (i & 1)
+                dv ^= rs_exp[(rs_log[lambda[i]] + inv * (i - 1)) % RS_N];
+        }
+        if (v)
+            continue;
+        if (!dv || nerr >= RS_NPAR / 2)
+            return -1;
+        uint16_t om = 0;
+        for (int i = 0; i < RS_NPAR; i++)
+            if (omega[i])
+                om ^= rs_exp[(rs_log[omega[i]] + inv * i) % RS_N];
+        // e = X^(1-FCR) * omega(X^-1) / lambda'(X^-1)
+        unsigned xe = (p * (1 + RS_N - RS_FCR)) % RS_N;
+        uint16_t e = om ? rs_exp[(rs_log[om] + xe + RS_N - rs_log[dv]) % RS_N] : 0;
+        err_pos[nerr] = n - 1 - p;
+        err_val[nerr] = e;
+        nerr++;
+    }
+    if (nerr != deg)
+        return -1;
+    return nerr;
+}
+
+// Hamming ECC over 256 bytes, 1-bit correction and 2-bit detection
+static uint32_t hamming_encode(const uint8_t *data)
+{
+    uint16_t lp = 0;    // Line parities, rp0..rp15
+    uint8_t col = 0;    // XOR of all bytes
+    for (int i = 0; i < 256; i++) {
+        uint8_t b = data[i];
+        col ^= b;
+        if (ctpop8(b) & 1) {
+            for (int k = 0; k < 8; k++)
+                lp ^= BIT(2 * k + ((i >> k) & 1));
+        }
+    }
+    uint8_t cp = 0;
+    cp |= (ctpop8(col & 0x55) & 1) << 2;    // cp0
+    cp |= (ctpop8(col & 0xaa) & 1) << 3;    // cp1
+    cp |= (ctpop8(col & 0x33) & 1) << 4;    // cp2
+    cp |= (ctpop8(col & 0xcc) & 1) << 5;    // cp3
+    cp |= (ctpop8(col & 0x0f) & 1) << 6;    // cp4
+    cp |= (ctpop8(col & 0xf0) & 1) << 7;    // cp5
+    return ~((uint32_t)lp | ((uint32_t)cp << 16)) & 0x00ffffff;
+}
+
+static void ingenic_emc_nand_ecc_rs_decode(IngenicEmcNandEcc *s)
+{
+    // Parity registers hold 8 packed 9-bit symbols
+    uint8_t pbuf[12];
+    uint16_t par[RS_NPAR];
+    for (int i = 0; i < 3; i++)
+        stl_le_p(&pbuf[4 * i], s->reg.nfpar[i]);
+    for (int i = 0; i < RS_NPAR; i++)
+        par[i] = rs_get_sym(pbuf, 9, i);
+
+    uint16_t err_pos[RS_NPAR / 2], err_val[RS_NPAR / 2];
+    int nerr = rs_decode(s->buf, par, err_pos, err_val);
+    trace_ingenic_nand_ecc_decode(nerr);
+    for (int i = 0; i < 4; i++)
+        s->reg.nferr[i] = 0;
+    if (nerr < 0) {
+        s->reg.nfints |= NFINTS_ERR | NFINTS_UNCOR;
+    } else if (nerr > 0) {
+        // Only report errors in data symbols, index is 1-based
+        int ndata = 0;
+        for (int i = 0; i < nerr; i++)
+            if (err_pos[i] < RS_DATA)
+                s->reg.nferr[ndata++] = ((uint32_t)(err_pos[i] + 1) << 16) | err_val[i];
+        if (ndata)
+            s->reg.nfints |= NFINTS_ERR | (ndata << NFINTS_ERRC_SHIFT);
+    }
+    s->reg.nfints |= NFINTS_PADF | NFINTS_DECF;
+}
+
 void ingenic_emc_nand_ecc_reset(IngenicEmc *emc, ResetType type)
 {
+    rs_tables_init();
     IngenicEmcNandEcc *s = &emc->nand_ecc;
     s->data_count = 0;
     s->reg.nfeccr = 0;
@@ -396,8 +870,12 @@ uint64_t ingenic_emc_nand_ecc_read(IngenicEmc *emc, hwaddr addr, unsigned size)
     case REG_NFECC:
         value = s->reg.nfecc;
         break;
-    case REG_NFPAR0 ... REG_NFPAR2:
-        value = s->reg.nfpar[(addr - REG_NFPAR0) / 4];
+    case REG_NFPAR0 ... REG_NFPAR2 + 3:
+        // Parity may be read byte by byte
+        for (int i = 0; i < size && addr + i <= REG_NFPAR2 + 3; i++) {
+            uint32_t ofs = addr - REG_NFPAR0 + i;
+            value |= (uint64_t)((s->reg.nfpar[ofs / 4] >> (8 * (ofs % 4))) & 0xff) << (8 * i);
+        }
         break;
     case REG_NFINTS:
         value = s->reg.nfints;
@@ -423,16 +901,26 @@ void ingenic_emc_nand_ecc_write(IngenicEmc *emc, hwaddr addr, uint64_t value, un
     IngenicEmcNandEcc *s = &emc->nand_ecc;
     switch (addr) {
     case REG_NFECCR:
-        if (value & BIT(1))
+        if (value & NFECCR_ERST)
             ingenic_emc_nand_ecc_reset(emc, 0);
         s->reg.nfeccr = value & 0x0d;
-        if (!(value & BIT(3)) && (value & BIT(4))) {
+        if (!(value & NFECCR_ENCE) && (value & NFECCR_PRDY)) {
             // Parity ready, decoding done
-            s->reg.nfints |= BIT(4) | BIT(3);
+            if (value & NFECCR_RS)
+                ingenic_emc_nand_ecc_rs_decode(s);
+            else
+                s->reg.nfints |= NFINTS_PADF | NFINTS_DECF;
         }
         break;
-    case REG_NFPAR0 ... REG_NFPAR2:
-        // TODO ECC
+    case REG_NFPAR0 ... REG_NFPAR2 + 3:
+        // Parity for decoding, may be written byte by byte
+        for (int i = 0; i < size && addr + i <= REG_NFPAR2 + 3; i++) {
+            uint32_t ofs = addr - REG_NFPAR0 + i;
+            uint32_t shift = 8 * (ofs % 4);
+            s->reg.nfpar[ofs / 4] = (s->reg.nfpar[ofs / 4] & ~(0xffu << shift)) |
+                                    (((value >> (8 * i)) & 0xff) << shift);
+        }
+        s->reg.nfpar[2] &= 0xff;
         break;
     case REG_NFINTS:
         s->reg.nfints = s->reg.nfints & (0xe0000000 | (value & 0x1f));
@@ -444,17 +932,37 @@ void ingenic_emc_nand_ecc_write(IngenicEmc *emc, hwaddr addr, uint64_t value, un
     }
 }
 
-void ingenic_emc_nand_ecc_data(IngenicEmc *emc, uint64_t value, unsigned size)
+void ingenic_emc_nand_ecc_feed(IngenicEmc *emc, const uint8_t *buf, uint32_t len)
 {
     IngenicEmcNandEcc *s = &emc->nand_ecc;
-    if (!(s->reg.nfeccr & BIT(3)))
+    if (!(s->reg.nfeccr & NFECCR_ECCE))
+        return;
+    bool rs = s->reg.nfeccr & NFECCR_RS;
+    uint32_t block = rs ? 512 : 256;
+    if (s->data_count >= block)
         return;
-    // In encoding mode
-    // TODO Check hamming vs. RS encoding
-    if (s->data_count < 512)
-        s->data_count += size;
-    if (s->data_count >= 512) {
+
+    uint32_t n = MIN(len, block - s->data_count);
+    memcpy(&s->buf[s->data_count], buf, n);
+    s->data_count += n;
+    if (s->data_count < block)
+        return;
+
+    if (!rs) {
+        // Hamming ECC is compared by software in both directions
+        s->reg.nfecc = hamming_encode(s->buf);
+        s->reg.nfints |= (s->reg.nfeccr & NFECCR_ENCE) ? NFINTS_ENCF : 0;
+    } else if (s->reg.nfeccr & NFECCR_ENCE) {
         // Encoding done
-        s->reg.nfints |= BIT(2);
+        uint16_t par[RS_NPAR];
+        uint8_t pbuf[12] = {0};
+        rs_encode(s->buf, par);
+        for (int i = 0; i < RS_NPAR; i++)
+            rs_put_sym(pbuf, i, par[i]);
+        for (int i = 0; i < 3; i++)
+            s->reg.nfpar[i] = ldl_le_p(&pbuf[4 * i]);
+        s->reg.nfpar[2] &= 0xff;
+        s->reg.nfints |= NFINTS_ENCF;
     }
+    // RS decoding waits for the parity to be written
 }
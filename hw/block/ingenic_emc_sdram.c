@@ -53,8 +53,11 @@ static void ingenic_emc_sdram_realize(DeviceState *dev, Error **errp)
     // Disabled for now
     memory_region_set_enabled(&s->mr, false);
     memory_region_add_subregion(sys_mem, 0, &s->mr);
-    // No alias sections yet
-    s->alias_mr = 0;
+    // Mirrors of the bank, resized and moved on DMAR writes
+    memory_region_init_alias_repeat(&s->mirror_mr, obj, "emc.sdram.mirror",
+                                    &s->mr, 0, s->size, s->size);
+    memory_region_set_enabled(&s->mirror_mr, false);
+    memory_region_add_subregion(sys_mem, 0, &s->mirror_mr);
     // Register on EMC main controller
     ingenic_emc_register_sdram(s, s->cs);
 }
@@ -127,29 +130,21 @@ static void ingenic_emc_sdram_write_dmar(IngenicEmc *emc, int bank, uint16_t val
 
     // Update main data region base address
     uint32_t ofs = (dmar & 0xff00) << 16;
+    memory_region_transaction_begin();
     memory_region_set_address(&sdram->mr, ofs);
     memory_region_set_enabled(&sdram->mr, true);
 
-    // Delete existing alias regions
-    MemoryRegion *sys_mem = get_system_memory();
-    if (sdram->alias_mr) {
-        // It is an exception that alias regions may be unparented at any time
-        for (int i = 0; i < sdram->num_aliases; i++) {
-            memory_region_del_subregion(sys_mem, &sdram->alias_mr[i]);
-            object_unparent(OBJECT(&sdram->alias_mr[i]));
-        }
-        g_free(sdram->alias_mr);
-    }
-    // Update alias regions to fill the entire SDRAM bank size
+    // A single repeating alias fills the rest of the SDRAM bank window
     // Holes not handled
-    sdram->num_aliases = (((~dmar & 0xff) + 1) << 24) / sdram->size - 1;
-    sdram->alias_mr = g_new(MemoryRegion, sdram->num_aliases);
-    for (int i = 0; i < sdram->num_aliases; i++) {
-        ofs += sdram->size;
-        memory_region_init_alias(&sdram->alias_mr[i], OBJECT(sdram), "emc.sdram.alias",
-                                 &sdram->mr, 0, sdram->size);
-        memory_region_add_subregion(sys_mem, ofs, &sdram->alias_mr[i]);
+    uint64_t window = (uint64_t)((~dmar & 0xff) + 1) << 24;
+    if (window > sdram->size) {
+        memory_region_set_size(&sdram->mirror_mr, window - sdram->size);
+        memory_region_set_address(&sdram->mirror_mr, ofs + sdram->size);
+        memory_region_set_enabled(&sdram->mirror_mr, true);
+    } else {
+        memory_region_set_enabled(&sdram->mirror_mr, false);
     }
+    memory_region_transaction_commit();
 }
 
 void ingenic_emc_sdram_write(IngenicEmc *emc, hwaddr addr, uint64_t data, unsigned size)
@@ -185,6 +180,14 @@ void ingenic_emc_sdram_write(IngenicEmc *emc, hwaddr addr, uint64_t data, unsign
     }
 }
 
+void ingenic_emc_sdram_post_load(IngenicEmc *emc)
+{
+    // Rebuild the bank mappings from the restored DMAR values
+    IngenicEmcSdramCfg *s = &emc->sdram_cfg;
+    ingenic_emc_sdram_write_dmar(emc, 0, s->reg.dmar[0]);
+    ingenic_emc_sdram_write_dmar(emc, 1, s->reg.dmar[1]);
+}
+
 void ingenic_emc_sdram_reset(IngenicEmc *emc, ResetType type)
 {
     IngenicEmcSdramCfg *s = &emc->sdram_cfg;
@@ -28,10 +28,18 @@
 #include "hw/irq.h"
 #include "hw/qdev-properties.h"
 #include "hw/qdev-properties-system.h"
+#include "migration/vmstate.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
 #include "trace.h"
 
+// 16550 register bits the batched transmitter depends on
+#define UART_LCR_DLAB   0x80
+#define UART_MCR_LOOP   0x10
+#define UART_FCR_FE     0x01
+#define UART_LSR_TEMT   0x40
+#define UART_LSR_THRE   0x20
+
 void qmp_stop(Error **errp);
 
 static void ingenic_uart_reset(Object *obj, ResetType type)
@@ -42,8 +50,138 @@ static void ingenic_uart_reset(Object *obj, ResetType type)
     s->isr = 0;
     s->umr = 0;
     s->uacr = 0;
+    s->tx_len = 0;
+    timer_del(&s->tx_timer);
+    if (s->tx_watch_tag) {
+        g_source_remove(s->tx_watch_tag);
+        s->tx_watch_tag = 0;
+    }
+}
+
+// Batched transmitter, replacing the per-byte 16550 THR path
+
+static void ingenic_uart_tx_flush(IngenicUartState *s);
+
+// The guest may not write THR while the backend is stalled or the FIFO is full
+static bool ingenic_uart_tx_busy(IngenicUartState *s)
+{
+    return s->tx_watch_tag || s->tx_len == INGENIC_UART_FIFO_SIZE;
+}
+
+static gboolean ingenic_uart_tx_watch_cb(void *do_not_use, GIOCondition cond,
+                                         void *opaque)
+{
+    IngenicUartState *s = opaque;
+    s->tx_watch_tag = 0;
+    ingenic_uart_tx_flush(s);
+    return G_SOURCE_REMOVE;
+}
+
+static void ingenic_uart_tx_flush(IngenicUartState *s)
+{
+    SerialState *ss = &SERIAL_MM(s)->serial;
+    timer_del(&s->tx_timer);
+    // Still waiting for the backend, the watch resumes the flush
+    if (!s->tx_len || s->tx_watch_tag)
+        return;
+    trace_ingenic_uart_tx_flush(s->tx_len);
+    int ret = qemu_chr_fe_write(&ss->chr, s->tx_fifo, s->tx_len);
+    if (ret > 0) {
+        s->tx_len -= ret;
+        memmove(s->tx_fifo, &s->tx_fifo[ret], s->tx_len);
+    }
+    if (s->tx_len) {
+        s->tx_watch_tag = qemu_chr_fe_add_watch(&ss->chr, G_IO_OUT | G_IO_HUP,
+                                                ingenic_uart_tx_watch_cb, s);
+        if (s->tx_watch_tag)
+            return;
+        // Backend gone or not watchable, like serial.c drop the rest
+        s->tx_len = 0;
+    }
+    // One THRE interrupt per drained FIFO, LSR.THRE/TEMT read as set again
+    serial_set_thr_ipending(ss, true);
 }
 
+static void ingenic_uart_tx_timeout(void *opaque)
+{
+    ingenic_uart_tx_flush(opaque);
+}
+
+static uint64_t ingenic_uart_thr_read(void *opaque, hwaddr addr, unsigned int size)
+{
+    IngenicUartState *s = INGENIC_UART(opaque);
+    return serial_io_ops.read(&SERIAL_MM(s)->serial, addr >> 2, 1);
+}
+
+static void ingenic_uart_thr_write(void *opaque, hwaddr addr,
+                                   uint64_t data, unsigned int size)
+{
+    IngenicUartState *s = INGENIC_UART(opaque);
+    SerialState *ss = &SERIAL_MM(s)->serial;
+
+    if (addr != 0) {
+        // IER, enabling THRI must not announce room the FIFO does not have
+        serial_io_ops.write(ss, addr >> 2, data & 0xff, 1);
+        if (!(ss->lcr & UART_LCR_DLAB) && ingenic_uart_tx_busy(s))
+            serial_set_thr_ipending(ss, false);
+        return;
+    }
+
+    if ((ss->lcr & UART_LCR_DLAB) || (ss->mcr & UART_MCR_LOOP) ||
+        !(ss->fcr & UART_FCR_FE)) {
+        // Divisor latch, loopback or FIFO disabled, keep the 16550 path
+        ingenic_uart_tx_flush(s);
+        serial_io_ops.write(ss, 0, data & 0xff, 1);
+        return;
+    }
+
+    // Writing THR acknowledges the THRE interrupt
+    if (ss->thr_ipending)
+        serial_set_thr_ipending(ss, false);
+    // LSR.THRE read as clear, a guest writing anyway overruns the FIFO
+    if (s->tx_len == INGENIC_UART_FIFO_SIZE) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Transmit FIFO overrun\n", __func__);
+        return;
+    }
+    s->tx_fifo[s->tx_len++] = data;
+    if (s->tx_len == INGENIC_UART_FIFO_SIZE) {
+        ingenic_uart_tx_flush(s);
+    } else {
+        // Idle timeout of four character times, as for the receive FIFO
+        timer_mod(&s->tx_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) +
+                                4 * ss->char_transmit_time);
+    }
+}
+
+static const MemoryRegionOps ingenic_uart_thr_ops = {
+    .read = ingenic_uart_thr_read,
+    .write = ingenic_uart_thr_write,
+    .endianness = DEVICE_NATIVE_ENDIAN,
+};
+
+static uint64_t ingenic_uart_lsr_read(void *opaque, hwaddr addr, unsigned int size)
+{
+    IngenicUartState *s = INGENIC_UART(opaque);
+    uint64_t lsr = serial_io_ops.read(&SERIAL_MM(s)->serial, 5, 1);
+    // Throttle the guest until the watch callback drains the FIFO
+    if (ingenic_uart_tx_busy(s))
+        lsr &= ~(UART_LSR_THRE | UART_LSR_TEMT);
+    return lsr;
+}
+
+static void ingenic_uart_lsr_write(void *opaque, hwaddr addr,
+                                   uint64_t data, unsigned int size)
+{
+    IngenicUartState *s = INGENIC_UART(opaque);
+    serial_io_ops.write(&SERIAL_MM(s)->serial, 5, data & 0xff, 1);
+}
+
+static const MemoryRegionOps ingenic_uart_lsr_ops = {
+    .read = ingenic_uart_lsr_read,
+    .write = ingenic_uart_lsr_write,
+    .endianness = DEVICE_NATIVE_ENDIAN,
+};
+
 static uint64_t ingenic_uart_read(void *opaque, hwaddr addr,
                                   unsigned int size)
 {
@@ -118,6 +256,11 @@ IngenicUartState *ingenic_uart_init(MemoryRegion *address_space,
     memory_region_add_subregion(address_space, base,
                                 sysbus_mmio_get_region(SYS_BUS_DEVICE(s), 0));
     memory_region_add_subregion(address_space, base + 0x20, &s->mmio);
+    // RBR/THR/DLL, IER/DLM and LSR overlays for the batched transmitter
+    if (s->tx_batch) {
+        memory_region_add_subregion_overlap(address_space, base, &s->thr_mr, 1);
+        memory_region_add_subregion_overlap(address_space, base + 0x14, &s->lsr_mr, 1);
+    }
 
     return s;
 }
@@ -132,15 +275,55 @@ static void ingenic_uart_realize(DeviceState *dev, Error **errp)
 
     memory_region_init_io(&s->mmio, obj, &ingenic_uart_ops, s, TYPE_INGENIC_UART, 0x1000 - 0x20);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    memory_region_init_io(&s->thr_mr, obj, &ingenic_uart_thr_ops, s, "ingenic-uart.thr", 8);
+    memory_region_init_io(&s->lsr_mr, obj, &ingenic_uart_lsr_ops, s, "ingenic-uart.lsr", 4);
+    timer_init_ns(&s->tx_timer, QEMU_CLOCK_VIRTUAL, ingenic_uart_tx_timeout, s);
+}
+
+static int ingenic_uart_post_load(void *opaque, int version_id)
+{
+    IngenicUartState *s = opaque;
+    if (s->tx_len > INGENIC_UART_FIFO_SIZE)
+        return -EINVAL;
+    // A flush that was waiting for the backend on the source restarts here
+    if (s->tx_len && !timer_pending(&s->tx_timer))
+        timer_mod(&s->tx_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL));
+    return 0;
 }
 
+static const VMStateDescription vmstate_ingenic_uart = {
+    .name = "ingenic-uart",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_uart_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_STRUCT(parent_obj.serial, IngenicUartState, 0, vmstate_serial, SerialState),
+        VMSTATE_UINT8(isr, IngenicUartState),
+        VMSTATE_UINT8(umr, IngenicUartState),
+        VMSTATE_UINT16(uacr, IngenicUartState),
+        VMSTATE_UINT8_ARRAY(tx_fifo, IngenicUartState, INGENIC_UART_FIFO_SIZE),
+        VMSTATE_UINT32(tx_len, IngenicUartState),
+        VMSTATE_TIMER(tx_timer, IngenicUartState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static Property ingenic_uart_properties[] = {
+    DEFINE_PROP_BOOL("tx-batch", IngenicUartState, tx_batch, false),
+    DEFINE_PROP_END_OF_LIST(),
+};
+
 static void ingenic_uart_class_init(ObjectClass *class, void *data)
 {
     IngenicUartClass *idc = INGENIC_UART_CLASS(class);
     DeviceClass *dc = DEVICE_CLASS(class);
 
+    device_class_set_props(dc, ingenic_uart_properties);
     idc->smm_realize = dc->realize;
     dc->realize = ingenic_uart_realize;
+    // Replaces the serial-mm description, serial state is saved as a member
+    dc->vmsd = &vmstate_ingenic_uart;
 
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
@@ -951,6 +951,16 @@ static void serial_unrealize(DeviceState *dev)
     qemu_unregister_reset(serial_reset, s);
 }
 
+/*
+ * Raise or acknowledge the THRE interrupt on behalf of a transmitter that
+ * bypasses THR, e.g. one that batches output to the character backend.
+ */
+void serial_set_thr_ipending(SerialState *s, bool pending)
+{
+    s->thr_ipending = pending && (s->ier & UART_IER_THRI);
+    serial_update_irq(s);
+}
+
 /* Change the main reference oscillator frequency. */
 void serial_set_frequency(SerialState *s, uint32_t frequency)
 {
@@ -175,7 +175,12 @@ void hmp_info_balloon(Monitor *mon, const QDict *qdict)
         return;
     }
 
-    monitor_printf(mon, "balloon: actual=%" PRId64 "\n", info->actual >> 20);
+    monitor_printf(mon, "balloon: actual=%" PRId64, info->actual >> 20);
+    if (info->has_free_page_reported) {
+        monitor_printf(mon, " free_page_reported=%" PRIu64,
+                       info->free_page_reported >> 20);
+    }
+    monitor_printf(mon, "\n");
 
     qapi_free_BalloonInfo(info);
 }
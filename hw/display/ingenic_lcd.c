@@ -33,9 +33,14 @@
 #include "qemu/log.h"
 #include "qemu/module.h"
 #include "exec/address-spaces.h"
+#include "exec/target_page.h"
 #include "hw/display/ingenic_lcd.h"
 #include "trace.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #define FPS             (60)
 #define TIMER_UPDATE_NS ((1000 * 1000 * 1000) / FPS)
 
@@ -91,12 +96,120 @@ static void ingenic_lcd_update_irq(IngenicLcd *s)
     qemu_set_irq(s->irq, irq);
 }
 
-static void draw_row(void *opaque, uint8_t *dst, const uint8_t *src,
-                     int width, int deststep)
+// Row converters to 32bpp, selected once per mode and surface format
+
+static void draw_row_565_32(uint32_t *dst, const uint8_t *src, int width)
 {
-    IngenicLcd *s = INGENIC_LCD(opaque);
-    DisplaySurface *surface = qemu_console_surface(s->con);
-    int bpp = surface_bits_per_pixel(surface);
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mr = _mm_set1_epi32(0xf800), mg = _mm_set1_epi32(0x07e0);
+    const __m128i mb = _mm_set1_epi32(0x001f);
+    for (; i + 8 <= width; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        for (int h = 0; h < 2; h++) {
+            __m128i p = h ? _mm_unpackhi_epi16(v, zero) : _mm_unpacklo_epi16(v, zero);
+            __m128i r = _mm_slli_epi32(_mm_and_si128(p, mr), 8);
+            __m128i g = _mm_slli_epi32(_mm_and_si128(p, mg), 5);
+            __m128i b = _mm_slli_epi32(_mm_and_si128(p, mb), 3);
+            _mm_storeu_si128((__m128i *)(dst + i + 4 * h),
+                             _mm_or_si128(_mm_or_si128(r, g), b));
+        }
+    }
+#endif
+    for (; i < width; i++) {
+        uint32_t v = lduw_le_p(src + 2 * i);
+        dst[i] = ((v & 0xf800) << 8) | ((v & 0x07e0) << 5) | ((v & 0x001f) << 3);
+    }
+}
+
+// DeltaRGB odd rows, colour components rotated to GBR
+static void draw_row_565_32_field(uint32_t *dst, const uint8_t *src, int width)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mr = _mm_set1_epi32(0x001f), mg = _mm_set1_epi32(0xf800);
+    const __m128i mb = _mm_set1_epi32(0x07e0);
+    for (; i + 8 <= width; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        for (int h = 0; h < 2; h++) {
+            __m128i p = h ? _mm_unpackhi_epi16(v, zero) : _mm_unpacklo_epi16(v, zero);
+            __m128i r = _mm_slli_epi32(_mm_and_si128(p, mr), 19);
+            __m128i g = _mm_and_si128(p, mg);
+            __m128i b = _mm_srli_epi32(_mm_and_si128(p, mb), 3);
+            _mm_storeu_si128((__m128i *)(dst + i + 4 * h),
+                             _mm_or_si128(_mm_or_si128(r, g), b));
+        }
+    }
+#endif
+    for (; i < width; i++) {
+        uint32_t v = lduw_le_p(src + 2 * i);
+        dst[i] = ((v & 0x001f) << 19) | (v & 0xf800) | ((v & 0x07e0) >> 3);
+    }
+}
+
+// 666 and 888 are stored as BGRx, which is x8r8g8b8 in little endian
+static inline void draw_row_x888_32(uint32_t *dst, const uint8_t *src,
+                                    int width, uint32_t mask)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i m = _mm_set1_epi32(mask);
+    for (; i + 4 <= width; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_and_si128(v, m));
+    }
+#endif
+    for (; i < width; i++)
+        dst[i] = ldl_le_p(src + 4 * i) & mask;
+}
+
+// DeltaRGB odd rows are stored as RBGx
+static inline void draw_row_x888_32_field(uint32_t *dst, const uint8_t *src,
+                                          int width, uint32_t mask)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i mhi = _mm_set1_epi32(mask & 0xff0000);
+    const __m128i mlo = _mm_set1_epi32(mask & 0x00ffff);
+    for (; i + 4 <= width; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+        __m128i hi = _mm_and_si128(_mm_slli_epi32(v, 16), mhi);
+        __m128i lo = _mm_and_si128(_mm_srli_epi32(v, 8), mlo);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(hi, lo));
+    }
+#endif
+    for (; i < width; i++) {
+        uint32_t v = ldl_le_p(src + 4 * i);
+        dst[i] = ((v << 16) & mask & 0xff0000) | ((v >> 8) & mask & 0x00ffff);
+    }
+}
+
+static void draw_row_888_32(uint32_t *dst, const uint8_t *src, int width)
+{
+    draw_row_x888_32(dst, src, width, 0x00ffffff);
+}
+
+static void draw_row_888_32_field(uint32_t *dst, const uint8_t *src, int width)
+{
+    draw_row_x888_32_field(dst, src, width, 0x00ffffff);
+}
+
+static void draw_row_666_32(uint32_t *dst, const uint8_t *src, int width)
+{
+    draw_row_x888_32(dst, src, width, 0x00fcfcfc);
+}
+
+static void draw_row_666_32_field(uint32_t *dst, const uint8_t *src, int width)
+{
+    draw_row_x888_32_field(dst, src, width, 0x00fcfcfc);
+}
+
+// Generic per-pixel conversion for other surface formats
+static void draw_row_generic(IngenicLcd *s, uint8_t *dst, const uint8_t *src, int width)
+{
+    int bpp = s->row_bpp;
 
     while (width--) {
         uint32_t tmp;
@@ -167,56 +280,186 @@ static void draw_row(void *opaque, uint8_t *dst, const uint8_t *src,
             break;
         }
     }
-
-    s->field = s->model == IngenicLcdModelDeltaRGB && !s->field;
 }
 
-static void ingenic_lcd_update_display(void *opaque)
-{
-    IngenicLcd *s = INGENIC_LCD(opaque);
-    DisplaySurface *surface = qemu_console_surface(s->con);
 
-    uint32_t src_width = 0;
+static void ingenic_lcd_select_row_fn(IngenicLcd *s, int bpp)
+{
+    bool delta = s->model == IngenicLcdModelDeltaRGB;
+    s->row_mode = s->mode;
+    s->row_bpp = bpp;
+    s->row_fn[0] = NULL;
+    s->row_fn[1] = NULL;
+    // Shared surfaces are the guest framebuffer, nothing to convert
+    if (bpp != 32 || s->shared)
+        return;
     switch (s->mode) {
     case 565:
-        src_width = s->xres * 2;
+        s->row_fn[0] = draw_row_565_32;
+        s->row_fn[1] = delta ? draw_row_565_32_field : draw_row_565_32;
         break;
     case 666:
+        s->row_fn[0] = draw_row_666_32;
+        s->row_fn[1] = delta ? draw_row_666_32_field : draw_row_666_32;
+        break;
     case 888:
-        src_width = s->xres * 4;
+        s->row_fn[0] = draw_row_888_32;
+        s->row_fn[1] = delta ? draw_row_888_32_field : draw_row_888_32;
         break;
-    default:
-        //qemu_log_mask(LOG_GUEST_ERROR, "%s: bad source color depth\n", __func__);
+    }
+}
+
+static void draw_row(void *opaque, uint8_t *dst, const uint8_t *src,
+                     int width, int deststep)
+{
+    IngenicLcd *s = opaque;
+    if (s->row_fn[s->field])
+        s->row_fn[s->field]((uint32_t *)dst, src, width);
+    else if (!s->shared)
+        draw_row_generic(s, dst, src, width);
+    s->field = s->model == IngenicLcdModelDeltaRGB && !s->field;
+}
+
+// Share the guest framebuffer with the console when the formats line up
+static void ingenic_lcd_update_share(IngenicLcd *s, uint32_t src_width)
+{
+    bool share = !HOST_BIG_ENDIAN && s->model == IngenicLcdModelNormal &&
+                 (s->mode == 565 || s->mode == 888) &&
+                 s->fbsection.mr && memory_region_is_ram(s->fbsection.mr);
+    uint32_t sa = s->desc[0].lcdsa;
+    if (share && (!s->shared || s->shared_sa != sa)) {
+        pixman_format_code_t format = s->mode == 565 ? PIXMAN_r5g6b5 : PIXMAN_x8r8g8b8;
+        uint8_t *ptr = memory_region_get_ram_ptr(s->fbsection.mr) +
+                       s->fbsection.offset_within_region;
+        DisplaySurface *surface = qemu_create_displaysurface_from(s->xres, s->yres,
+                                                                  format, src_width, ptr);
+        dpy_gfx_replace_surface(s->con, surface);
+        s->shared = true;
+        s->shared_sa = sa;
+        s->invalidate = true;
+        s->row_mode = 0;
+    } else if (!share && s->shared) {
+        qemu_console_resize(s->con, s->xres, s->yres);
+        s->shared = false;
+        s->invalidate = true;
+        s->row_mode = 0;
+    }
+}
+
+static void ingenic_lcd_desc_invalidate(IngenicLcd *s)
+{
+    for (int i = 0; i < INGENIC_LCD_DESC_CACHE; i++)
+        s->desc_cache[i].valid = false;
+}
+
+// Dirty snapshots are taken in whole bitmap words, so nearby ranges of the
+// same region clear each other's dirty bits
+static bool ingenic_lcd_dirty_overlap(MemoryRegion *mr, hwaddr start, hwaddr end,
+                                      MemoryRegionSection *section)
+{
+    if (section->mr != mr)
+        return false;
+    hwaddr blk = (hwaddr)qemu_target_page_size() * BITS_PER_LONG;
+    hwaddr ofs = section->offset_within_region;
+    hwaddr len = int128_get64(section->size);
+    return start / blk <= (ofs + len - 1) / blk && ofs / blk <= (end - 1) / blk;
+}
+
+// Drop cached descriptors the guest wrote to since the last frame
+static void ingenic_lcd_desc_sync(IngenicLcd *s)
+{
+    MemoryRegion *mr = NULL;
+    hwaddr start = HWADDR_MAX, end = 0;
+    for (int i = 0; i < INGENIC_LCD_DESC_CACHE; i++) {
+        IngenicLcdDescCache *e = &s->desc_cache[i];
+        if (!e->valid)
+            continue;
+        if (!mr)
+            mr = e->section.mr;
+        if (e->section.mr != mr) {
+            // Only one region is watched at a time
+            e->valid = false;
+            continue;
+        }
+        start = MIN(start, e->section.offset_within_region);
+        end = MAX(end, e->section.offset_within_region + 4 * e->nwords);
+    }
+    if (!mr)
+        return;
+
+    if (ingenic_lcd_dirty_overlap(mr, start, end, &s->fbsection)) {
+        // Snapshots would race with framebuffer dirty tracking, read every frame
+        ingenic_lcd_desc_invalidate(s);
         return;
     }
 
-    uint32_t dest_width = 0;
-    switch (surface_bits_per_pixel(surface)) {
-    case 8:
-        dest_width = s->xres;
-        break;
-    case 15:
-    case 16:
-        dest_width = s->xres * 2;
-        break;
-    case 24:
-        dest_width = s->xres * 3;
-        break;
-    case 32:
-        dest_width = s->xres * 4;
-        break;
+    DirtyBitmapSnapshot *snap = memory_region_snapshot_and_clear_dirty(mr, start, end - start,
+                                                                       DIRTY_MEMORY_VGA);
+    for (int i = 0; i < INGENIC_LCD_DESC_CACHE; i++) {
+        IngenicLcdDescCache *e = &s->desc_cache[i];
+        if (e->valid && memory_region_snapshot_get_dirty(mr, snap, e->section.offset_within_region,
+                                                         4 * e->nwords))
+            e->valid = false;
+    }
+    g_free(snap);
+}
+
+static const uint32_t *ingenic_lcd_fetch_desc(IngenicLcd *s, uint32_t da, uint32_t nwords)
+{
+    IngenicLcdDescCache *e = NULL;
+    for (int i = 0; i < INGENIC_LCD_DESC_CACHE; i++) {
+        if (s->desc_cache[i].da == da && s->desc_cache[i].nwords == nwords) {
+            e = &s->desc_cache[i];
+            break;
+        }
+    }
+
+    if (!e) {
+        e = &s->desc_cache[s->desc_victim];
+        s->desc_victim = (s->desc_victim + 1) % INGENIC_LCD_DESC_CACHE;
+        framebuffer_update_memory_section(&e->section, get_system_memory(), da, 1, 4 * nwords);
+        e->da = da;
+        e->nwords = nwords;
+        e->valid = false;
+    }
+
+    if (!e->valid) {
+        cpu_physical_memory_read(da, &e->desc[0], 4 * nwords);
+        // Descriptors outside RAM can not be watched
+        e->valid = e->section.mr != NULL;
+    }
+    return &e->desc[0];
+}
+
+static uint32_t ingenic_lcd_src_width(IngenicLcd *s)
+{
+    switch (s->mode) {
+    case 565:
+        return s->xres * 2;
+    case 666:
+    case 888:
+        return s->xres * 4;
     default:
-        qemu_log_mask(LOG_GUEST_ERROR, "%s: bad surface color depth\n", __func__);
+        return 0;
+    }
+}
+
+// Guest visible frame processing, runs at the panel refresh rate
+static void ingenic_lcd_frame(IngenicLcd *s)
+{
+    uint32_t src_width = ingenic_lcd_src_width(s);
+    if (!src_width) {
+        //qemu_log_mask(LOG_GUEST_ERROR, "%s: bad source color depth\n", __func__);
         return;
     }
 
     // Find a framebuffer from descriptor chain
+    ingenic_lcd_desc_sync(s);
     for (;;) {
         uint32_t idesc = 0;
         uint32_t da = s->desc[idesc].lcdda;
-        uint32_t desc[8];
         uint32_t nwords = s->lcdcfg & BIT(28) ? 8 : 4;
-        cpu_physical_memory_read(da, &desc[0], 4 * nwords);
+        const uint32_t *desc = ingenic_lcd_fetch_desc(s, da, nwords);
         s->desc[idesc].lcdda  = desc[0];
         s->desc[idesc].lcdsa  = desc[1];
         s->desc[idesc].lcdfid = desc[2];
@@ -251,9 +494,16 @@ static void ingenic_lcd_update_display(void *opaque)
             ingenic_lcd_update_irq(s);
         }
 
-        framebuffer_update_memory_section(&s->fbsection, get_system_memory(),
-                                          s->desc[idesc].lcdsa,
-                                          s->yres, src_width);
+        uint32_t fb_len = s->yres * src_width;
+        if (!s->fbsection.mr || s->fb_sa != s->desc[idesc].lcdsa || s->fb_len != fb_len) {
+            framebuffer_update_memory_section(&s->fbsection, get_system_memory(),
+                                              s->desc[idesc].lcdsa,
+                                              s->yres, src_width);
+            s->fb_sa = s->desc[idesc].lcdsa;
+            s->fb_len = fb_len;
+            s->invalidate = true;
+            ingenic_lcd_desc_invalidate(s);
+        }
 
         if (s->desc[0].lcdcmd & BIT(30)) {
             // EOFINT End of frame interrupt
@@ -263,13 +513,48 @@ static void ingenic_lcd_update_display(void *opaque)
 
         break;
     }
+}
+
+// Host side update, called from the console refresh
+static void ingenic_lcd_update_display(void *opaque)
+{
+    IngenicLcd *s = INGENIC_LCD(opaque);
+    uint32_t src_width = ingenic_lcd_src_width(s);
+    if (!src_width || !s->fbsection.mr)
+        return;
+
+    ingenic_lcd_update_share(s, src_width);
+    DisplaySurface *surface = qemu_console_surface(s->con);
+    uint32_t dest_width = 0;
+    switch (surface_bits_per_pixel(surface)) {
+    case 8:
+        dest_width = s->xres;
+        break;
+    case 15:
+    case 16:
+        dest_width = s->xres * 2;
+        break;
+    case 24:
+        dest_width = s->xres * 3;
+        break;
+    case 32:
+        dest_width = s->xres * 4;
+        break;
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: bad surface color depth\n", __func__);
+        return;
+    }
+
+    if (s->row_mode != s->mode || s->row_bpp != surface_bits_per_pixel(surface))
+        ingenic_lcd_select_row_fn(s, surface_bits_per_pixel(surface));
 
     int first = 0, last = 0;
     framebuffer_update_display(surface, &s->fbsection,
                                s->xres, s->yres,
                                src_width, dest_width, 0, s->invalidate,
                                &draw_row, s, &first, &last);
-    dpy_gfx_update(s->con, 0, first, s->xres, last - first + 1);
+    if (first >= 0)
+        dpy_gfx_update(s->con, 0, first, s->xres, last - first + 1);
 
     s->invalidate = false;
 }
@@ -292,7 +577,10 @@ static void ingenic_lcd_schedule(IngenicLcd *s)
     trace_ingenic_lcd_schedule(next);
     timer_mod_anticipate_ns(&s->timer, next);
 
-    graphic_hw_update(s->con);
+    ingenic_lcd_frame(s);
+    // Adaptive refresh leaves idle consoles to the display's own refresh timer
+    if (s->refresh_policy == IngenicLcdRefreshFixed || qemu_console_is_visible(s->con))
+        graphic_hw_update(s->con);
 }
 
 static void ingenic_lcd_timer(void *opaque)
@@ -347,6 +635,9 @@ static void ingenic_lcd_enable(IngenicLcd *s, bool en)
     }
 
     qemu_console_resize(s->con, s->xres, s->yres);
+    s->shared = false;
+    s->row_mode = 0;
+    s->fb_len = 0;
 
     // Restart frame tick timer
     timer_del(&s->timer);
@@ -360,6 +651,7 @@ static void ingenic_lcd_reset(Object *obj, ResetType type)
     timer_del(&s->timer);
     s->mode = 0;
     s->field = false;
+    ingenic_lcd_desc_invalidate(s);
 }
 
 static uint64_t ingenic_lcd_read(void *opaque, hwaddr addr, unsigned size)
@@ -579,6 +871,16 @@ static void ingenic_lcd_realize(DeviceState *dev, Error **errp)
         if (strcmp(s->model_str, "delta-rgb") == 0)
             s->model = IngenicLcdModelDeltaRGB;
     }
+
+    s->refresh_policy = IngenicLcdRefreshFixed;
+    if (s->refresh_policy_str) {
+        if (strcmp(s->refresh_policy_str, "adaptive") == 0) {
+            s->refresh_policy = IngenicLcdRefreshAdaptive;
+        } else if (strcmp(s->refresh_policy_str, "fixed") != 0) {
+            error_setg(errp, "Unknown refresh-policy \"%s\"", s->refresh_policy_str);
+            return;
+        }
+    }
 }
 
 static void ingenic_lcd_finalize(Object *obj)
@@ -586,10 +888,94 @@ static void ingenic_lcd_finalize(Object *obj)
     IngenicLcd *s = INGENIC_LCD(obj);
     timer_del(&s->timer);
     s->mode = 0;
+    for (int i = 0; i < INGENIC_LCD_DESC_CACHE; i++) {
+        MemoryRegion *mr = s->desc_cache[i].section.mr;
+        if (mr) {
+            memory_region_set_log(mr, false, DIRTY_MEMORY_VGA);
+            memory_region_unref(mr);
+        }
+    }
+}
+
+static int ingenic_lcd_post_load(void *opaque, int version_id)
+{
+    IngenicLcd *s = opaque;
+    // Console surface and conversion caches are rebuilt on the next frame
+    if (s->mode)
+        qemu_console_resize(s->con, s->xres, s->yres);
+    s->shared = false;
+    s->row_mode = 0;
+    s->fb_len = 0;
+    s->invalidate = true;
+    ingenic_lcd_desc_invalidate(s);
+    return 0;
 }
 
+static const VMStateDescription vmstate_ingenic_lcd_fg = {
+    .name = "ingenic-lcd/fg",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(lcdkey, struct IngenicLcdFg),
+        VMSTATE_UINT32(lcdxyp, struct IngenicLcdFg),
+        VMSTATE_UINT32(lcdsize, struct IngenicLcdFg),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_ingenic_lcd_desc = {
+    .name = "ingenic-lcd/desc",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(lcdda, struct IngenicLcdDesc),
+        VMSTATE_UINT32(lcdsa, struct IngenicLcdDesc),
+        VMSTATE_UINT32(lcdfid, struct IngenicLcdDesc),
+        VMSTATE_UINT32(lcdcmd, struct IngenicLcdDesc),
+        VMSTATE_UINT32(lcdoffs, struct IngenicLcdDesc),
+        VMSTATE_UINT32(lcdpw, struct IngenicLcdDesc),
+        VMSTATE_UINT32(lcdcnum, struct IngenicLcdDesc),
+        VMSTATE_UINT32(lcddessize, struct IngenicLcdDesc),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_ingenic_lcd = {
+    .name = "ingenic-lcd",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_lcd_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_TIMER(timer, IngenicLcd),
+        VMSTATE_INT64(timer_ns, IngenicLcd),
+        VMSTATE_UINT32(xres, IngenicLcd),
+        VMSTATE_UINT32(yres, IngenicLcd),
+        VMSTATE_UINT32(mode, IngenicLcd),
+        VMSTATE_UINT32_ARRAY(osd_mode, IngenicLcd, 2),
+        VMSTATE_BOOL(field, IngenicLcd),
+        VMSTATE_UINT32(lcdcfg, IngenicLcd),
+        VMSTATE_UINT32(lcdvsync, IngenicLcd),
+        VMSTATE_UINT32(lcdhsync, IngenicLcd),
+        VMSTATE_UINT32(lcdvat, IngenicLcd),
+        VMSTATE_UINT32(lcddah, IngenicLcd),
+        VMSTATE_UINT32(lcddav, IngenicLcd),
+        VMSTATE_UINT32(lcdctrl, IngenicLcd),
+        VMSTATE_UINT8(lcdstate, IngenicLcd),
+        VMSTATE_UINT16(lcdrgbc, IngenicLcd),
+        VMSTATE_UINT16(lcdosdc, IngenicLcd),
+        VMSTATE_UINT16(lcdosdctrl, IngenicLcd),
+        VMSTATE_UINT32(lcdbgc, IngenicLcd),
+        VMSTATE_UINT8(lcdalpha, IngenicLcd),
+        VMSTATE_UINT32(lcdipur, IngenicLcd),
+        VMSTATE_STRUCT_ARRAY(fg, IngenicLcd, 2, 1, vmstate_ingenic_lcd_fg, struct IngenicLcdFg),
+        VMSTATE_STRUCT_ARRAY(desc, IngenicLcd, 2, 1, vmstate_ingenic_lcd_desc, struct IngenicLcdDesc),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static Property ingenic_lcd_properties[] = {
     DEFINE_PROP_STRING("model", IngenicLcd, model_str),
+    DEFINE_PROP_STRING("refresh-policy", IngenicLcd, refresh_policy_str),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -598,6 +984,7 @@ static void ingenic_lcd_class_init(ObjectClass *class, void *data)
     DeviceClass *dc = DEVICE_CLASS(class);
     device_class_set_props(dc, ingenic_lcd_properties);
     dc->realize = ingenic_lcd_realize;
+    dc->vmsd = &vmstate_ingenic_lcd;
     IngenicLcdClass *bch_class = INGENIC_LCD_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
@@ -446,11 +446,43 @@ static void virtio_gpu_resource_unref(VirtIOGPU *g,
     virtio_gpu_resource_destroy(g, res, NULL);
 }
 
+/*
+ * Copy @height rows of @len bytes, @stride apart in both the backing
+ * iov and the destination image.  The iov is walked once instead of
+ * being rescanned from its start for every row, and rows that lie
+ * within a single iov element are copied with a plain memcpy.
+ */
+static void virtio_gpu_iov_to_rows(const struct iovec *iov,
+                                   unsigned int iov_cnt, size_t offset,
+                                   size_t stride, uint8_t *dst, size_t len,
+                                   unsigned int height)
+{
+    unsigned int i = 0;
+    size_t base = 0;
+
+    while (height--) {
+        while (i < iov_cnt && offset >= base + iov[i].iov_len) {
+            base += iov[i].iov_len;
+            i++;
+        }
+        if (i == iov_cnt) {
+            return;
+        }
+        if (offset + len <= base + iov[i].iov_len) {
+            memcpy(dst, (uint8_t *)iov[i].iov_base + (offset - base), len);
+        } else {
+            iov_to_buf(iov + i, iov_cnt - i, offset - base, dst, len);
+        }
+        offset += stride;
+        dst += stride;
+    }
+}
+
 static void virtio_gpu_transfer_to_host_2d(VirtIOGPU *g,
                                            struct virtio_gpu_ctrl_command *cmd)
 {
     struct virtio_gpu_simple_resource *res;
-    int h, bpp;
+    int bpp;
     uint32_t src_offset, dst_offset, stride;
     pixman_format_code_t format;
     struct virtio_gpu_transfer_to_host_2d t2d;
@@ -486,14 +518,11 @@ static void virtio_gpu_transfer_to_host_2d(VirtIOGPU *g,
     img_data = pixman_image_get_data(res->image);
 
     if (t2d.r.x || t2d.r.width != pixman_image_get_width(res->image)) {
-        for (h = 0; h < t2d.r.height; h++) {
-            src_offset = t2d.offset + stride * h;
-            dst_offset = (t2d.r.y + h) * stride + (t2d.r.x * bpp);
-
-            iov_to_buf(res->iov, res->iov_cnt, src_offset,
-                       (uint8_t *)img_data + dst_offset,
-                       t2d.r.width * bpp);
-        }
+        src_offset = t2d.offset;
+        dst_offset = t2d.r.y * stride + (t2d.r.x * bpp);
+        virtio_gpu_iov_to_rows(res->iov, res->iov_cnt, src_offset, stride,
+                               (uint8_t *)img_data + dst_offset,
+                               t2d.r.width * bpp, t2d.r.height);
     } else {
         src_offset = t2d.offset;
         dst_offset = t2d.r.y * stride + t2d.r.x * bpp;
@@ -23,20 +23,35 @@
  */
 
 #include "qemu/osdep.h"
+#include "qapi/error.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
 #include "qemu/main-loop.h"
+#include "qemu/error-report.h"
+#include "sysemu/runstate.h"
 #include "migration/vmstate.h"
+#include "qemu/rcu.h"
 #include "block/aio.h"
+#include "exec/address-spaces.h"
 #include "hw/qdev-properties.h"
 #include "hw/sysbus.h"
 #include "hw/irq.h"
 #include "hw/ssi/ingenic_msc.h"
+#include "hw/audio/ingenic_aic.h"
+#include "hw/block/ingenic_bch.h"
+#include "hw/block/ingenic_emc.h"
 #include "hw/dma/ingenic_dmac.h"
 #include "trace.h"
 
 #define MSC_RX_PASS_THROUGH 1
 #define MSC_TX_PASS_THROUGH 1
+#define NAND_RX_PASS_THROUGH 1
+// Smallest RAM-to-RAM transfer worth handing to the iothread
+#define OFFLOAD_MIN_BYTES   (64 * 1024)
+// Bytes a channel may move per arbitration round in timed mode
+#define TIMED_CHUNK_BYTES   4096
+// Descriptors a channel may follow in one pass before yielding to the main loop
+#define LINK_BUDGET         256
 
 #define REG_CH_DSA  0x00
 #define REG_CH_DTA  0x04
@@ -57,17 +72,24 @@
 #define REQ_BCH_ENC 2
 #define REQ_BCH_DEC 3
 #define REQ_AUTO    8
+#define REQ_AIC_TX  24
+#define REQ_AIC_RX  25
 #define REQ_MSC0_TX 26
 #define REQ_MSC0_RX 27
 
 void qmp_stop(Error **errp);
 
+static void ingenic_dmac_offload_drain(IngenicDmac *s);
+
 static void ingenic_dmac_reset(Object *obj, ResetType type)
 {
     IngenicDmac *s = INGENIC_DMAC(obj);
+    // Copies on the iothread must not write RAM after the reset
+    ingenic_dmac_offload_drain(s);
     for (int dmac = 0; dmac < INGENIC_DMAC_NUM_DMAC; dmac++) {
         for (int ch = 0; ch < INGENIC_DMAC_NUM_CH; ch++) {
             s->dma[dmac].ch[ch].state = IngenicDmacChIdle;
+            s->dma[dmac].ch[ch].gen++;
             s->reg[dmac].ch[ch].dsa = 0;
             s->reg[dmac].ch[ch].dta = 0;
             s->reg[dmac].ch[ch].dtc = 0;
@@ -82,10 +104,31 @@ static void ingenic_dmac_reset(Object *obj, ResetType type)
         s->reg[dmac].ddr   = 0;
         s->reg[dmac].dcke  = 0;
     }
+    timer_del(&s->timer);
+    s->round_ns = 0;
 
     // Find MSC
     s->msc = INGENIC_MSC(object_resolve_path_type("", TYPE_INGENIC_MSC, NULL));
+    // Find BCH, only available on some models
+    Object *bch = object_resolve_path_type("", TYPE_INGENIC_BCH, NULL);
+    s->bch = bch ? INGENIC_BCH(bch) : NULL;
+    // Find AIC
+    Object *aic = object_resolve_path_type("", TYPE_INGENIC_AIC, NULL);
+    s->aic = aic ? INGENIC_AIC(aic) : NULL;
+}
+
+#if NAND_RX_PASS_THROUGH
+// NAND bank whose data port is currently mapped at addr, if any
+static IngenicEmcNand *ingenic_dmac_nand_at(hwaddr addr)
+{
+    MemoryRegionSection sec = memory_region_find(get_system_memory(), addr, 1);
+    if (!sec.mr)
+        return NULL;
+    Object *obj = object_dynamic_cast(sec.mr->owner, TYPE_INGENIC_EMC_NAND);
+    memory_region_unref(sec.mr);
+    return obj ? INGENIC_EMC_NAND(obj) : NULL;
 }
+#endif
 
 static void ingenic_dmac_update_irq(IngenicDmac *s, int dmac, int ch)
 {
@@ -109,6 +152,135 @@ static void ingenic_dmac_update_irq(IngenicDmac *s, int dmac, int ch)
     }
 }
 
+static void *ingenic_dmac_map(hwaddr addr, hwaddr *plen, bool is_write)
+{
+    // Only map RAM, device FIFOs and registers go through MMIO dispatch
+    hwaddr xlat, len = *plen;
+    RCU_READ_LOCK_GUARD();
+    MemoryRegion *mr = address_space_translate(&address_space_memory, addr, &xlat, &len,
+                                               is_write, MEMTXATTRS_UNSPECIFIED);
+    if (!memory_access_is_direct(mr, is_write))
+        return NULL;
+    *plen = len;
+    return address_space_map(&address_space_memory, addr, plen, is_write,
+                             MEMTXATTRS_UNSPECIFIED);
+}
+
+static void ingenic_dmac_channel_done(IngenicDmac *s, int dmac, int ch);
+static void ingenic_dmac_wait_req(IngenicDmac *s, int dmac, int ch);
+
+struct IngenicDmacOffload {
+    IngenicDmac *s;
+    int dmac, ch;
+    uint32_t gen;
+    uint8_t *sptr, *dptr;
+    hwaddr len;
+    bool done;      // Set by the iothread under offload_lock
+    QTAILQ_ENTRY(IngenicDmacOffload) next;
+};
+
+// Complete finished copies, with wait set block until every copy has finished
+static void ingenic_dmac_offload_complete(IngenicDmac *s, bool wait)
+{
+    IngenicDmacOffload *job, *tmp;
+    QTAILQ_HEAD(, IngenicDmacOffload) done = QTAILQ_HEAD_INITIALIZER(done);
+
+    qemu_mutex_lock(&s->offload_lock);
+    for (;;) {
+        bool busy = false;
+        QTAILQ_FOREACH_SAFE(job, &s->offload_jobs, next, tmp) {
+            if (job->done) {
+                QTAILQ_REMOVE(&s->offload_jobs, job, next);
+                QTAILQ_INSERT_TAIL(&done, job, next);
+            } else {
+                busy = true;
+            }
+        }
+        if (!wait || !busy)
+            break;
+        qemu_cond_wait(&s->offload_cond, &s->offload_lock);
+    }
+    qemu_mutex_unlock(&s->offload_lock);
+
+    // With the BQL held, publish the results in submission order
+    QTAILQ_FOREACH_SAFE(job, &done, next, tmp) {
+        int dmac = job->dmac, ch = job->ch;
+        address_space_unmap(&address_space_memory, job->sptr, job->len, false, job->len);
+        address_space_unmap(&address_space_memory, job->dptr, job->len, true, job->len);
+        if (job->gen == s->dma[dmac].ch[ch].gen &&
+            s->dma[dmac].ch[ch].state == IngenicDmacChBusy) {
+            trace_ingenic_dmac_transfer_path(dmac, ch, job->len, 0, 0);
+            s->reg[dmac].ch[ch].dtc = 0;
+            ingenic_dmac_channel_done(s, dmac, ch);
+        }
+        g_free(job);
+    }
+}
+
+static void ingenic_dmac_offload_bh(void *opaque)
+{
+    ingenic_dmac_offload_complete(INGENIC_DMAC(opaque), false);
+}
+
+// Let running copies finish so no guest RAM changes behind our back
+static void ingenic_dmac_offload_drain(IngenicDmac *s)
+{
+    ingenic_dmac_offload_complete(s, true);
+}
+
+static void ingenic_dmac_offload_run(void *opaque)
+{
+    // Runs in the iothread, touches nothing but the mapped RAM and the job
+    IngenicDmacOffload *job = opaque;
+    IngenicDmac *s = job->s;
+    memmove(job->dptr, job->sptr, job->len);
+    qemu_mutex_lock(&s->offload_lock);
+    job->done = true;
+    qemu_bh_schedule(s->offload_bh);
+    qemu_cond_broadcast(&s->offload_cond);
+    qemu_mutex_unlock(&s->offload_lock);
+}
+
+static bool ingenic_dmac_offload(IngenicDmac *s, int dmac, int ch,
+                                 uint32_t src, uint32_t dst, uint32_t size)
+{
+    // Both ends must be RAM mapped in one piece
+    hwaddr slen = size, dlen = size;
+    uint8_t *sptr = ingenic_dmac_map(src, &slen, false);
+    uint8_t *dptr = ingenic_dmac_map(dst, &dlen, true);
+    if (!sptr || !dptr || slen != size || dlen != size) {
+        if (sptr)
+            address_space_unmap(&address_space_memory, sptr, slen, false, 0);
+        if (dptr)
+            address_space_unmap(&address_space_memory, dptr, dlen, true, 0);
+        return false;
+    }
+
+    IngenicDmacOffload *job = g_new0(IngenicDmacOffload, 1);
+    job->s = s;
+    job->dmac = dmac;
+    job->ch = ch;
+    job->gen = s->dma[dmac].ch[ch].gen;
+    job->sptr = sptr;
+    job->dptr = dptr;
+    job->len = size;
+    s->dma[dmac].ch[ch].state = IngenicDmacChBusy;
+    qemu_mutex_lock(&s->offload_lock);
+    QTAILQ_INSERT_TAIL(&s->offload_jobs, job, next);
+    qemu_mutex_unlock(&s->offload_lock);
+    aio_bh_schedule_oneshot(iothread_get_aio_context(s->iothread),
+                            ingenic_dmac_offload_run, job);
+    return true;
+}
+
+static uint64_t ingenic_dmac_cost_ns(IngenicDmac *s, uint32_t bytes, uint32_t tsz_b)
+{
+    // Streaming time at the configured bandwidth plus a fixed cost per burst,
+    // so small transfer units are proportionally slower
+    uint64_t ns = (uint64_t)bytes * 1000 / MAX(s->bandwidth, 1);
+    return ns + (uint64_t)DIV_ROUND_UP(bytes, tsz_b) * s->burst_ns;
+}
+
 static void ingenic_dmac_channel_trigger(IngenicDmac *s, int dmac, int ch)
 {
     trace_ingenic_dmac_start1(dmac, ch, s->reg[dmac].dmac,
@@ -179,6 +351,10 @@ static void ingenic_dmac_channel_trigger(IngenicDmac *s, int dmac, int ch)
     case REQ_MSC0_RX:
         avail = MIN(size, ingenic_msc_available(s->msc));
         break;
+    case REQ_AIC_TX:
+    case REQ_AIC_RX:
+        avail = MIN(size, ingenic_aic_available(s->aic, req == REQ_AIC_TX));
+        break;
     case REQ_BCH_DEC:
         // DMA read data from memory pointed by DSAR0 and write to BCH data register BHDR
         dst     = 0x130d0010;
@@ -192,48 +368,118 @@ static void ingenic_dmac_channel_trigger(IngenicDmac *s, int dmac, int ch)
         return;
     }
 
+    // In timed mode each channel gets one chunk per arbitration round,
+    // BCH decoding needs the whole block in one go
+    bool timed = s->timing == IngenicDmacTimingTimed;
+    bool timed_cut = false;
+    if (timed && req != REQ_BCH_DEC && avail > TIMED_CHUNK_BYTES) {
+        avail = TIMED_CHUNK_BYTES;
+        timed_cut = true;
+    }
+    uint32_t moved = avail;
+
     // Continuous transfer, no need to wait
     trace_ingenic_dmac_transfer(dmac, ch, dst, src, avail);
+    // Large memory copies run concurrently with the guest
+    if (!timed && s->iothread && req == REQ_AUTO && src_inc && dst_inc &&
+        size >= OFFLOAD_MIN_BYTES && ingenic_dmac_offload(s, dmac, ch, src, dst, size))
+        return;
+#if NAND_RX_PASS_THROUGH
+    IngenicEmcNand *nand = req == REQ_NAND && !src_inc ? ingenic_dmac_nand_at(src) : NULL;
+#endif
+    uint32_t map_bytes = 0, fifo_bytes = 0, bounce_bytes = 0;
+    bool is_short = false;
     while (avail) {
         uint8_t buf[4096];
-        uint32_t len = MIN(sizeof(buf), avail);
-        avail -= len;
-        size -= len;
-        // Clear last u32 buffer word
-        //*((uint32_t *)&buf[0] + (len % sizeof(buf)) / 4) = 0;
+        // Map RAM backed ranges for direct access
+        hwaddr slen = avail, dlen = avail;
+        uint8_t *sptr = src_inc ? ingenic_dmac_map(src, &slen, false) : NULL;
+        uint8_t *dptr = dst_inc ? ingenic_dmac_map(dst, &dlen, true) : NULL;
+        uint32_t len = avail;
+        if (sptr)
+            len = MIN(len, slen);
+        if (dptr)
+            len = MIN(len, dlen);
+        if (!sptr && !dptr)
+            len = MIN(len, sizeof(buf));
+        uint32_t chunk = len;
         // Read from source
-        if (src_inc) {
-            cpu_physical_memory_read(src, &buf[0], len);
-            src += len;
+        uint8_t *pdata = dptr ? dptr : &buf[0];
+        if (sptr) {
+            pdata = sptr;
+        } else if (src_inc) {
+            cpu_physical_memory_read(src, pdata, len);
 #if MSC_RX_PASS_THROUGH
         } else if (req == REQ_MSC0_RX && src == 0x10021038) {
             // Fast pass-through for MSC RX
-            len = ingenic_msc_sd_read(s->msc, buf, len);
+            len = ingenic_msc_sd_read(s->msc, pdata, len);
 #endif
+#if NAND_RX_PASS_THROUGH
+        } else if (req == REQ_NAND && nand) {
+            // Fast pass-through from the NAND page buffer
+            len = ingenic_emc_nand_data_read(nand, pdata, len);
+#endif
+        } else if (req == REQ_AIC_RX && s->aic) {
+            // Drain the whole chunk from the AIC capture ring
+            len = ingenic_aic_rx_read(s->aic, pdata, len, src_b);
         } else {
-            uint8_t *pbuf = &buf[0];
+            uint8_t *pbuf = pdata;
             for (int32_t i = len; i > 0; i -= src_b) {
                 cpu_physical_memory_read(src, pbuf, src_b);
                 pbuf += src_b;
             }
         }
         // Write to target
-        if (dst_inc) {
-            cpu_physical_memory_write(dst, &buf[0], len);
-            dst += len;
+        if (dptr) {
+            if (pdata != dptr)
+                memmove(dptr, pdata, len);
+        } else if (dst_inc) {
+            cpu_physical_memory_write(dst, pdata, len);
 #if MSC_TX_PASS_THROUGH
         } else if (req == REQ_MSC0_TX && dst == 0x1002103c) {
             // Fast pass-through for MSC TX
-            len = ingenic_msc_sd_write(s->msc, buf, len);
+            len = ingenic_msc_sd_write(s->msc, pdata, len);
 #endif
+        } else if (req == REQ_AIC_TX && s->aic) {
+            // Feed the whole chunk to the AIC playback ring
+            len = ingenic_aic_tx_write(s->aic, pdata, len, dst_b);
+        } else if (req == REQ_BCH_DEC && s->bch) {
+            // Feed the whole block to BCH
+            ingenic_bch_feed(s->bch, pdata, len);
         } else {
-            uint8_t *pbuf = &buf[0];
+            uint8_t *pbuf = pdata;
             for (int32_t i = len; i > 0; i -= dst_b) {
                 cpu_physical_memory_write(dst, pbuf, dst_b);
                 pbuf += dst_b;
             }
         }
+        // A peripheral may take or give less than asked, only that much moved
+        if (src_inc)
+            src += len;
+        if (dst_inc)
+            dst += len;
+        avail -= len;
+        size -= len;
+        // Release mappings
+        if (sptr)
+            address_space_unmap(&address_space_memory, sptr, slen, false, len);
+        if (dptr)
+            address_space_unmap(&address_space_memory, dptr, dlen, true, len);
+        if (sptr && dptr)
+            map_bytes += len;
+        else if (sptr || dptr)
+            fifo_bytes += len;
+        else
+            bounce_bytes += len;
+        if (len < chunk) {
+            is_short = true;
+            break;
+        }
     }
+    moved -= avail;
+    trace_ingenic_dmac_transfer_path(dmac, ch, map_bytes, fifo_bytes, bounce_bytes);
+    if (timed)
+        s->round_ns += ingenic_dmac_cost_ns(s, moved, tsz_b);
 
     // Update registers
     switch (req) {
@@ -241,13 +487,21 @@ static void ingenic_dmac_channel_trigger(IngenicDmac *s, int dmac, int ch)
     case REQ_NAND:
     case REQ_MSC0_TX:
     case REQ_MSC0_RX:
+        // A timed round may stop early, the next one resumes from here
+        s->reg[dmac].ch[ch].dtc = size / tsz_b;
+        s->reg[dmac].ch[ch].dsa = src;
+        s->reg[dmac].ch[ch].dta = dst;
+        break;
+    case REQ_AIC_TX:
+    case REQ_AIC_RX:
+        // Audio buffers usually span several requests, resume where we stopped
         s->reg[dmac].ch[ch].dtc = size / tsz_b;
-        //s->reg[dmac].ch[ch].dsa = src;
-        //s->reg[dmac].ch[ch].dta = dst;
+        s->reg[dmac].ch[ch].dsa = src;
+        s->reg[dmac].ch[ch].dta = dst;
         break;
     case REQ_BCH_DEC:
         s->reg[dmac].ch[ch].dtc = size / tsz_b;
-        //s->reg[dmac].ch[ch].dsa = src;
+        s->reg[dmac].ch[ch].dsa = src;
         if (blast) {
             // after BCH decoding finishes, if there is error in the data block
             // DMA will write BHINT, BHERR0~3 (8-bit BCH) or BHERR0~1 (4-bit BCH)
@@ -283,12 +537,36 @@ static void ingenic_dmac_channel_trigger(IngenicDmac *s, int dmac, int ch)
     }
 
     if (size != 0) {
-        s->dma[dmac].ch[ch].state = IngenicDmacChIdle;
+        if (is_short) {
+            // The peripheral ran dry or full, wait for its next request
+            // unless it is ready again already
+            ingenic_dmac_wait_req(s, dmac, ch);
+            if (moved && s->dma[dmac].ch[ch].state == IngenicDmacChTxfr)
+                qemu_bh_schedule(s->trigger_bh);
+            else
+                s->dma[dmac].ch[ch].state = IngenicDmacChIdle;
+            return;
+        }
+        // Keep going next round if only the arbiter stopped us
+        s->dma[dmac].ch[ch].state = timed_cut ? IngenicDmacChTxfr : IngenicDmacChIdle;
+        return;
+    }
+    if (timed) {
+        s->dma[dmac].ch[ch].state = IngenicDmacChDrain;
         return;
     }
+    ingenic_dmac_channel_done(s, dmac, ch);
+}
+
+static void ingenic_dmac_channel_done(IngenicDmac *s, int dmac, int ch)
+{
+    uint32_t dcs  = s->reg[dmac].ch[ch].dcs;
+    uint32_t dcm  = s->reg[dmac].ch[ch].dcm;
+    uint8_t  ndes = (dcs >> 31) & 1;
+    uint8_t  vm   = (dcm >>  3) & 1;
+    uint8_t  link = (dcm >>  0) & 1;
 
     // Transfer complete
-    // TODO generate interrupts
     if (vm) {
         // If VM=1, clear V to 0
         s->reg[dmac].ch[ch].dcm &= ~BIT(4);
@@ -309,15 +587,51 @@ static void ingenic_dmac_channel_trigger(IngenicDmac *s, int dmac, int ch)
         // Parse next descriptor
         trace_ingenic_dmac_terminate(dmac, ch, "LINK");
         s->dma[dmac].ch[ch].state = IngenicDmacChDesc;
-        qemu_bh_schedule(s->trigger_bh);
+        // A running pass follows the link itself
+        if (!s->in_pass)
+            qemu_bh_schedule(s->trigger_bh);
+    }
+}
+
+// Descriptors of a chain share the 4 KiB page selected by DDA,
+// keep that page mapped for the whole pass instead of reading each one
+typedef struct IngenicDmacDescPage {
+    hwaddr base;
+    hwaddr len;
+    uint8_t *ptr;
+} IngenicDmacDescPage;
+
+static void ingenic_dmac_desc_page_release(IngenicDmacDescPage *page)
+{
+    if (page->ptr)
+        address_space_unmap(&address_space_memory, page->ptr, page->len, false, page->len);
+    page->ptr = NULL;
+    page->base = HWADDR_MAX;
+}
+
+static void ingenic_dmac_fetch_descriptor(IngenicDmacDescPage *page, uint32_t addr,
+                                          uint32_t *desc, uint32_t nwords)
+{
+    hwaddr base = addr & ~(hwaddr)0xfff;
+    hwaddr ofs = addr - base;
+    if (page->base != base) {
+        ingenic_dmac_desc_page_release(page);
+        page->base = base;
+        page->len = 0x1000;
+        page->ptr = ingenic_dmac_map(base, &page->len, false);
     }
+    if (page->ptr && ofs + 4 * nwords <= page->len)
+        memcpy(desc, &page->ptr[ofs], 4 * nwords);
+    else
+        cpu_physical_memory_read(addr, desc, 4 * nwords);
 }
 
-static void ingenic_dmac_parse_descriptor(IngenicDmac *s, int dmac, int ch, uint32_t addr, uint32_t nwords)
+static void ingenic_dmac_parse_descriptor(IngenicDmac *s, int dmac, int ch, uint32_t addr, uint32_t nwords,
+                                          IngenicDmacDescPage *page)
 {
     uint32_t desc[8] = {0};
     s->reg[dmac].ddr &= ~BIT(ch);
-    cpu_physical_memory_read(addr, &desc[0], 4 * nwords);
+    ingenic_dmac_fetch_descriptor(page, addr, &desc[0], nwords);
     trace_ingenic_dmac_desc(dmac, ch, nwords, addr, desc[0], desc[1], desc[2], desc[3], desc[4], desc[5]);
 
     // 4-word descriptor
@@ -401,6 +715,13 @@ static void ingenic_dmac_wait_req(IngenicDmac *s, int dmac, int ch)
             s->dma[dmac].ch[ch].state = IngenicDmacChTxfr;
         }
         break;
+    case REQ_AIC_TX:
+    case REQ_AIC_RX:
+        // Wait for the AIC to ask for data, unless its ring can take some now
+        s->dma[dmac].ch[ch].state = IngenicDmacChIdle;
+        if (ingenic_aic_available(s->aic, req == REQ_AIC_TX))
+            s->dma[dmac].ch[ch].state = IngenicDmacChTxfr;
+        break;
     case REQ_BCH_ENC:
     case REQ_BCH_DEC:
     case REQ_AUTO:
@@ -418,25 +739,68 @@ static void ingenic_dmac_wait_req(IngenicDmac *s, int dmac, int ch)
 static void ingenic_dmac_trigger_bh(void *opaque)
 {
     IngenicDmac *s = INGENIC_DMAC(opaque);
+    IngenicDmacDescPage page = { .base = HWADDR_MAX };
+    bool more = false;
+    s->in_pass = true;
     for (int dmac = 0; dmac < INGENIC_DMAC_NUM_DMAC; dmac++) {
         for (int ch = 0; ch < INGENIC_DMAC_NUM_CH; ch++) {
-            if (s->dma[dmac].ch[ch].state == IngenicDmacChDesc) {
-                // Fetch descriptor
-                uint32_t dcs = s->reg[dmac].ch[ch].dcs;
-                if (!(dcs & BIT(31))) {
-                    // Fetch descriptor
-                    int nwords = dcs & BIT(30) ? 8 : 4;
-                    uint32_t addr = s->reg[dmac].ch[ch].dda;
-                    ingenic_dmac_parse_descriptor(s, dmac, ch, addr, nwords);
+            // Walk linked descriptors in this pass, up to the budget
+            for (int links = 0; links < LINK_BUDGET; links++) {
+                if (s->dma[dmac].ch[ch].state == IngenicDmacChDesc) {
+                    uint32_t dcs = s->reg[dmac].ch[ch].dcs;
+                    if (!(dcs & BIT(31))) {
+                        // Fetch descriptor
+                        int nwords = dcs & BIT(30) ? 8 : 4;
+                        uint32_t addr = s->reg[dmac].ch[ch].dda;
+                        ingenic_dmac_parse_descriptor(s, dmac, ch, addr, nwords, &page);
+                    }
+                    ingenic_dmac_wait_req(s, dmac, ch);
                 }
-                ingenic_dmac_wait_req(s, dmac, ch);
+                // A pending timer means the bus is still busy with the last round
+                if (s->dma[dmac].ch[ch].state == IngenicDmacChTxfr &&
+                    !(s->timing == IngenicDmacTimingTimed && timer_pending(&s->timer)))
+                    ingenic_dmac_channel_trigger(s, dmac, ch);
+                if (s->dma[dmac].ch[ch].state != IngenicDmacChDesc)
+                    break;
             }
-            if (s->dma[dmac].ch[ch].state == IngenicDmacChTxfr)
-                ingenic_dmac_channel_trigger(s, dmac, ch);
+            more |= s->dma[dmac].ch[ch].state == IngenicDmacChDesc;
+        }
+    }
+    ingenic_dmac_desc_page_release(&page);
+    s->in_pass = false;
+    // Out of budget, continue the chains on the next main loop iteration
+    if (more)
+        qemu_bh_schedule(s->trigger_bh);
+
+    // Hold the bus for as long as this round's transfers take
+    if (s->timing == IngenicDmacTimingTimed && !timer_pending(&s->timer)) {
+        bool active = false;
+        for (int dmac = 0; dmac < INGENIC_DMAC_NUM_DMAC; dmac++)
+            for (int ch = 0; ch < INGENIC_DMAC_NUM_CH; ch++)
+                if (s->dma[dmac].ch[ch].state == IngenicDmacChTxfr ||
+                    s->dma[dmac].ch[ch].state == IngenicDmacChDrain)
+                    active = true;
+        if (active || s->round_ns) {
+            trace_ingenic_dmac_timed_round(s->round_ns);
+            int64_t now_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+            timer_mod_ns(&s->timer, now_ns + MAX(s->round_ns, 1));
+            s->round_ns = 0;
         }
     }
 }
 
+static void ingenic_dmac_timer(void *opaque)
+{
+    IngenicDmac *s = INGENIC_DMAC(opaque);
+    // Bus time for the last round elapsed, publish finished channels
+    for (int dmac = 0; dmac < INGENIC_DMAC_NUM_DMAC; dmac++)
+        for (int ch = 0; ch < INGENIC_DMAC_NUM_CH; ch++)
+            if (s->dma[dmac].ch[ch].state == IngenicDmacChDrain)
+                ingenic_dmac_channel_done(s, dmac, ch);
+    // Then start the next round
+    ingenic_dmac_trigger_bh(s);
+}
+
 static int ingenic_dmac_channel_is_enabled(IngenicDmac *s, int dmac, int ch)
 {
     // HLT, AR, DMAE
@@ -453,6 +817,8 @@ static void ingenic_dmac_channel_req_detect(IngenicDmac *s, int dmac, int ch, in
     switch (req) {
     case REQ_NAND:
     case REQ_MSC0_RX:
+    case REQ_AIC_TX:
+    case REQ_AIC_RX:
         if (level) {
             // Trigger on rising edge
             s->dma[dmac].ch[ch].state = IngenicDmacChTxfr;
@@ -593,8 +959,12 @@ static void ingenic_dmac_write(void *opaque, hwaddr addr, uint64_t data, unsigne
             case REG_CH_DCS:
                 s->reg[dmac].ch[ch].dcs = data & 0xc0ff00df;
                 ingenic_dmac_update_irq(s, dmac, ch);
-                // Start DMA transfer
-                if (ingenic_dmac_channel_is_enabled(s, dmac, ch)) {
+                // Start DMA transfer, unless still copying on the iothread
+                if ((s->dma[dmac].ch[ch].state == IngenicDmacChBusy ||
+                     s->dma[dmac].ch[ch].state == IngenicDmacChDrain) &&
+                    ingenic_dmac_channel_is_enabled(s, dmac, ch)) {
+                    break;
+                } else if (ingenic_dmac_channel_is_enabled(s, dmac, ch)) {
                     s->dma[dmac].ch[ch].state = IngenicDmacChDesc;
                     qemu_bh_schedule(s->trigger_bh);
                 } else {
@@ -625,7 +995,11 @@ static void ingenic_dmac_write(void *opaque, hwaddr addr, uint64_t data, unsigne
             }
             // Start DMA transfer
             for (ch = 0; ch < INGENIC_DMAC_NUM_CH; ch++) {
-                if (ingenic_dmac_channel_is_enabled(s, dmac, ch)) {
+                if ((s->dma[dmac].ch[ch].state == IngenicDmacChBusy ||
+                     s->dma[dmac].ch[ch].state == IngenicDmacChDrain) &&
+                    ingenic_dmac_channel_is_enabled(s, dmac, ch)) {
+                    continue;
+                } else if (ingenic_dmac_channel_is_enabled(s, dmac, ch)) {
                     s->dma[dmac].ch[ch].state = IngenicDmacChDesc;
                     qemu_bh_schedule(s->trigger_bh);
                 } else {
@@ -671,14 +1045,153 @@ static void ingenic_dmac_init(Object *obj)
     qdev_init_gpio_out_named(dev, &s->irq[0], "irq-out", INGENIC_DMAC_NUM_DMAC);
     // To avoid re-entrancy, defer DMA triggers to main loop
     s->trigger_bh = aio_bh_new(qemu_get_aio_context(), &ingenic_dmac_trigger_bh, s);
+    timer_init_ns(&s->timer, QEMU_CLOCK_VIRTUAL, &ingenic_dmac_timer, s);
+    qemu_mutex_init(&s->offload_lock);
+    qemu_cond_init(&s->offload_cond);
+    QTAILQ_INIT(&s->offload_jobs);
+    s->offload_bh = aio_bh_new(qemu_get_aio_context(), &ingenic_dmac_offload_bh, s);
 }
 
 static void ingenic_dmac_finalize(Object *obj)
 {
+    IngenicDmac *s = INGENIC_DMAC(obj);
+    if (s->vmstate_change)
+        qemu_del_vm_change_state_handler(s->vmstate_change);
+    // Nothing on the iothread may reference s once it is freed
+    ingenic_dmac_offload_drain(s);
+    qemu_bh_delete(s->offload_bh);
+    qemu_bh_delete(s->trigger_bh);
+    qemu_cond_destroy(&s->offload_cond);
+    qemu_mutex_destroy(&s->offload_lock);
+    timer_del(&s->timer);
+}
+
+static void ingenic_dmac_vm_state_change(void *opaque, bool running, RunState state)
+{
+    // A stopped VM sees no DMA progress, finish what the iothread started
+    if (!running)
+        ingenic_dmac_offload_drain(INGENIC_DMAC(opaque));
 }
 
+static void ingenic_dmac_realize(DeviceState *dev, Error **errp)
+{
+    IngenicDmac *s = INGENIC_DMAC(dev);
+    s->timing = IngenicDmacTimingInstant;
+    if (s->timing_str) {
+        if (strcmp(s->timing_str, "timed") == 0) {
+            s->timing = IngenicDmacTimingTimed;
+        } else if (strcmp(s->timing_str, "instant") != 0) {
+            error_setg(errp, "Unknown timing \"%s\"", s->timing_str);
+            return;
+        }
+    }
+    if (s->iothread)
+        s->vmstate_change = qemu_add_vm_change_state_handler(ingenic_dmac_vm_state_change, s);
+}
+
+static int ingenic_dmac_pre_save(void *opaque)
+{
+    IngenicDmac *s = opaque;
+    // Offloaded copies complete before saving, no channel is saved busy
+    ingenic_dmac_offload_drain(s);
+    return 0;
+}
+
+static int ingenic_dmac_post_load(void *opaque, int version_id)
+{
+    IngenicDmac *s = opaque;
+    // Resume channels that were in flight when the state was saved
+    for (int dmac = 0; dmac < INGENIC_DMAC_NUM_DMAC; dmac++) {
+        for (int ch = 0; ch < INGENIC_DMAC_NUM_CH; ch++) {
+            // pre_save drains the iothread, replaying a half done copy
+            // whose source and target overlap would corrupt the target
+            if (s->dma[dmac].ch[ch].state == IngenicDmacChBusy) {
+                error_report("ingenic-dmac: channel %d.%d saved mid-copy", dmac, ch);
+                return -EINVAL;
+            }
+            if (s->dma[dmac].ch[ch].state != IngenicDmacChIdle)
+                qemu_bh_schedule(s->trigger_bh);
+        }
+    }
+    return 0;
+}
+
+static const VMStateDescription vmstate_ingenic_dmac_ch_state = {
+    .name = "ingenic-dmac/ch-state",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(state, struct IngenicDmacChState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_ingenic_dmac_state = {
+    .name = "ingenic-dmac/state",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_STRUCT_ARRAY(ch, struct IngenicDmacState, INGENIC_DMAC_NUM_CH, 1,
+                             vmstate_ingenic_dmac_ch_state, struct IngenicDmacChState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_ingenic_dmac_ch_regs = {
+    .name = "ingenic-dmac/ch-regs",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(dsa, struct IngenicDmacChRegs),
+        VMSTATE_UINT32(dta, struct IngenicDmacChRegs),
+        VMSTATE_UINT32(dtc, struct IngenicDmacChRegs),
+        VMSTATE_UINT8(drt, struct IngenicDmacChRegs),
+        VMSTATE_UINT32(dcs, struct IngenicDmacChRegs),
+        VMSTATE_UINT32(dcm, struct IngenicDmacChRegs),
+        VMSTATE_UINT32(dda, struct IngenicDmacChRegs),
+        VMSTATE_UINT32(dsd, struct IngenicDmacChRegs),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_ingenic_dmac_regs = {
+    .name = "ingenic-dmac/regs",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_STRUCT_ARRAY(ch, struct IngenicDmacRegs, INGENIC_DMAC_NUM_CH, 1,
+                             vmstate_ingenic_dmac_ch_regs, struct IngenicDmacChRegs),
+        VMSTATE_UINT32(dmac, struct IngenicDmacRegs),
+        VMSTATE_UINT32(dirqp, struct IngenicDmacRegs),
+        VMSTATE_UINT8(ddr, struct IngenicDmacRegs),
+        VMSTATE_UINT8(dcke, struct IngenicDmacRegs),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_ingenic_dmac = {
+    .name = "ingenic-dmac",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .pre_save = ingenic_dmac_pre_save,
+    .post_load = ingenic_dmac_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_TIMER(timer, IngenicDmac),
+        VMSTATE_UINT64(round_ns, IngenicDmac),
+        VMSTATE_STRUCT_ARRAY(dma, IngenicDmac, INGENIC_DMAC_NUM_DMAC, 1,
+                             vmstate_ingenic_dmac_state, struct IngenicDmacState),
+        VMSTATE_STRUCT_ARRAY(reg, IngenicDmac, INGENIC_DMAC_NUM_DMAC, 1,
+                             vmstate_ingenic_dmac_regs, struct IngenicDmacRegs),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static Property ingenic_dmac_properties[] = {
     DEFINE_PROP_UINT32("model", IngenicDmac, model, 0x4755),
+    DEFINE_PROP_LINK("iothread", IngenicDmac, iothread, TYPE_IOTHREAD, IOThread *),
+    DEFINE_PROP_STRING("timing", IngenicDmac, timing_str),
+    DEFINE_PROP_UINT32("bandwidth", IngenicDmac, bandwidth, 400),
+    DEFINE_PROP_UINT32("burst-overhead-ns", IngenicDmac, burst_ns, 20),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -686,6 +1199,8 @@ static void ingenic_dmac_class_init(ObjectClass *class, void *data)
 {
     DeviceClass *dc = DEVICE_CLASS(class);
     device_class_set_props(dc, ingenic_dmac_properties);
+    dc->realize = ingenic_dmac_realize;
+    dc->vmsd = &vmstate_ingenic_dmac;
 
     IngenicDmacClass *bch_class = INGENIC_DMAC_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
@@ -22,6 +22,8 @@
 #include "hw/irq.h"
 #include "hw/qdev-properties.h"
 #include "migration/vmstate.h"
+#include "qapi/error.h"
+#include "qapi/visitor.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
 #include "trace.h"
@@ -240,23 +242,40 @@ static MemoryRegionOps ingenic_gpio_ops = {
     .endianness = DEVICE_NATIVE_ENDIAN,
 };
 
-static void ingenic_gpio_input_irq(void *opaque, int n, int level)
+void ingenic_gpio_set_pins(IngenicGpio *gpio, uint32_t mask, uint32_t value)
 {
-    IngenicGpio *gpio = opaque;
-    trace_ingenic_gpio_in(gpio->name, n, level);
-    uint32_t mask = 1 << n;
-    uint32_t val = level << n;
     // Update pin state
     uint32_t pin = gpio->pin;
-    gpio->pin = (gpio->pin & ~mask) | val;
-    if (level)
-        gpio->pending_raise |= mask;
-    else
-        gpio->pending_fall |= mask;
+    uint32_t changed = ((pin & ~mask) | (value & mask)) ^ pin;
+    // Unchanged levels cannot set any new edge or level flag
+    if (!changed)
+        return;
+    gpio->pin ^= changed;
+    gpio->pending_raise |= changed & gpio->pin;
+    gpio->pending_fall |= changed & ~gpio->pin;
     ingenic_gpio_update_irq(gpio, pin);
     trace_ingenic_gpio_status(gpio->name, gpio->pin, gpio->dat, gpio->flg);
 }
 
+static void ingenic_gpio_input_irq(void *opaque, int n, int level)
+{
+    IngenicGpio *gpio = opaque;
+    trace_ingenic_gpio_in(gpio->name, n, level);
+    ingenic_gpio_set_pins(gpio, 1 << n, (level ? 1 : 0) << n);
+}
+
+// Drive several input pins at once: mask in bits 63..32, levels in bits 31..0
+static void ingenic_gpio_set_drive_pins(Object *obj, Visitor *v, const char *name,
+                                        void *opaque, Error **errp)
+{
+    IngenicGpio *gpio = INGENIC_GPIO(obj);
+    uint64_t value;
+    if (!visit_type_uint64(v, name, &value, errp))
+        return;
+    trace_ingenic_gpio_drive(gpio->name, value >> 32, value);
+    ingenic_gpio_set_pins(gpio, value >> 32, value);
+}
+
 OBJECT_DEFINE_TYPE(IngenicGpio, ingenic_gpio, INGENIC_GPIO, SYS_BUS_DEVICE)
 
 static void ingenic_gpio_init(Object *obj)
@@ -272,6 +291,9 @@ static void ingenic_gpio_init(Object *obj)
     qdev_init_gpio_in_named_with_opaque(dev, &ingenic_gpio_input_irq, s, "gpio-in", 32);
     qdev_init_gpio_out_named(dev, &s->output[0], "gpio-out", 32);
     qdev_init_gpio_out_named(dev, &s->irq_out, "irq-out", 1);
+
+    object_property_add(obj, "drive-pins", "uint64", NULL,
+                        ingenic_gpio_set_drive_pins, NULL, NULL);
 }
 
 static void ingenic_gpio_finalize(Object *obj)
@@ -285,9 +307,32 @@ static Property ingenic_gpio_properties[] = {
     DEFINE_PROP_END_OF_LIST(),
 };
 
+static const VMStateDescription vmstate_ingenic_gpio = {
+    .name = "ingenic-gpio",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(pending_raise, IngenicGpio),
+        VMSTATE_UINT32(pending_fall, IngenicGpio),
+        VMSTATE_INT32(prev_irq_level, IngenicGpio),
+        VMSTATE_UINT32(pin, IngenicGpio),
+        VMSTATE_UINT32(dat, IngenicGpio),
+        VMSTATE_UINT32(im, IngenicGpio),
+        VMSTATE_UINT32(pe, IngenicGpio),
+        VMSTATE_UINT32(fun, IngenicGpio),
+        VMSTATE_UINT32(sel, IngenicGpio),
+        VMSTATE_UINT32(dir, IngenicGpio),
+        VMSTATE_UINT32(trg, IngenicGpio),
+        VMSTATE_UINT32(flg, IngenicGpio),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static void ingenic_gpio_class_init(ObjectClass *class, void *data)
 {
-    device_class_set_props(DEVICE_CLASS(class), ingenic_gpio_properties);
+    DeviceClass *dc = DEVICE_CLASS(class);
+    device_class_set_props(dc, ingenic_gpio_properties);
+    dc->vmsd = &vmstate_ingenic_gpio;
     IngenicGpioClass *gpio_class = INGENIC_GPIO_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
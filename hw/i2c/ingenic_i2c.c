@@ -215,8 +215,26 @@ static void ingenic_i2c_finalize(Object *obj)
 {
 }
 
+static const VMStateDescription vmstate_ingenic_i2c = {
+    .name = "ingenic-i2c",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(state, IngenicI2c),
+        VMSTATE_INT32(delay, IngenicI2c),
+        VMSTATE_UINT8(dr, IngenicI2c),
+        VMSTATE_UINT8(cr, IngenicI2c),
+        VMSTATE_UINT8(sr, IngenicI2c),
+        VMSTATE_UINT16(gr, IngenicI2c),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static void ingenic_i2c_class_init(ObjectClass *class, void *data)
 {
+    DeviceClass *dc = DEVICE_CLASS(class);
+    dc->vmsd = &vmstate_ingenic_i2c;
+
     IngenicI2cClass *bch_class = INGENIC_I2C_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
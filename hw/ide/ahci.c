@@ -920,6 +920,24 @@ static int prdt_tbl_entry_size(const AHCI_SG *tbl)
     return (le32_to_cpu(tbl->flags_size) & AHCI_PRDT_SIZE_MASK) + 1;
 }
 
+/*
+ * Drivers commonly describe a physically contiguous buffer with one
+ * PRDT entry per page.  Fold such runs into the previous scatter/gather
+ * element so that the DMA helpers map and submit fewer segments.
+ */
+static void ahci_sglist_add(QEMUSGList *sglist, dma_addr_t addr,
+                            dma_addr_t len)
+{
+    ScatterGatherEntry *last = &sglist->sg[sglist->nsg - 1];
+
+    if (last->base + last->len == addr) {
+        last->len += len;
+        sglist->size += len;
+        return;
+    }
+    qemu_sglist_add(sglist, addr, len);
+}
+
 /**
  * Fetch entries in a guest-provided PRDT and convert it into a QEMU SGlist.
  * @ad: The AHCIDevice for whom we are building the SGList.
@@ -1000,7 +1018,7 @@ static int ahci_populate_sglist(AHCIDevice *ad, QEMUSGList *sglist,
                             limit));
 
         for (i = off_idx + 1; i < prdtl && sglist->size < limit; i++) {
-            qemu_sglist_add(sglist, le64_to_cpu(tbl[i].addr),
+            ahci_sglist_add(sglist, le64_to_cpu(tbl[i].addr),
                             MIN(prdt_tbl_entry_size(&tbl[i]),
                                 limit - sglist->size));
         }
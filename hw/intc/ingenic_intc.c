@@ -24,8 +24,10 @@
 
 #include "qemu/osdep.h"
 #include "hw/sysbus.h"
+#include "hw/qdev-properties.h"
 #include "migration/vmstate.h"
 #include "qemu/log.h"
+#include "qemu/main-loop.h"
 #include "qemu/module.h"
 #include "qemu/timer.h"
 #include "hw/intc/ingenic_intc.h"
@@ -41,20 +43,46 @@ void qmp_stop(Error **errp);
 
 static void intc_update(IngenicIntc *s)
 {
-    uint32_t diff = s->icpr;
-    s->icpr = s->icsr & ~s->icmr;
-    diff ^= s->icpr;
-    if (diff) {
-        qemu_set_irq(s->irq, !!s->icpr);
-        trace_ingenic_intc_update(s->icsr, s->icpr);
-#if 0
-        int64_t now_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
-        qemu_log("%s: time %.6f pending 0x%"PRIx32" unmasked 0x%"PRIx32"\n",
-                 __func__, (double)now_ns / 1000000000., s->icsr, s->icpr);
-#endif
+    // Deferred until the outermost batch ends
+    if (s->batch)
+        return;
+
+    uint32_t icpr = s->icsr & ~s->icmr;
+    if (icpr == s->icpr)
+        return;
+    // Published to the BQL-free ICPR read path
+    qatomic_set(&s->icpr, icpr);
+    trace_ingenic_intc_update(s->icsr, icpr);
+
+    // Only touch the CPU line when the summary level actually changes
+    bool level = !!icpr;
+    if (level != s->irq_level) {
+        s->irq_level = level;
+        qemu_set_irq(s->irq, level);
     }
 }
 
+IngenicIntc *ingenic_intc_get_intc(void)
+{
+    Object *obj = object_resolve_path_type("", TYPE_INGENIC_INTC, NULL);
+    return obj ? INGENIC_INTC(obj) : NULL;
+}
+
+void ingenic_intc_batch_begin(IngenicIntc *s)
+{
+    if (s)
+        s->batch++;
+}
+
+void ingenic_intc_batch_end(IngenicIntc *s)
+{
+    if (!s)
+        return;
+    assert(s->batch);
+    if (--s->batch == 0)
+        intc_update(s);
+}
+
 static void ingenic_intc_reset(Object *obj, ResetType type)
 {
     IngenicIntc *s = INGENIC_INTC(obj);
@@ -62,6 +90,8 @@ static void ingenic_intc_reset(Object *obj, ResetType type)
     s->icsr = 0;
     s->icmr = 0xffffffff;
     s->icpr = 0;
+    s->batch = 0;
+    s->irq_level = false;
 }
 
 static uint64_t ingenic_intc_read(void *opaque, hwaddr addr, unsigned size)
@@ -75,9 +105,6 @@ static uint64_t ingenic_intc_read(void *opaque, hwaddr addr, unsigned size)
     case REG_ICMR:
         data = s->icmr;
         break;
-    case REG_ICPR:
-        data = s->icpr;
-        break;
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "%s: Unknown address " HWADDR_FMT_plx "\n", __func__, addr);
         qmp_stop(NULL);
@@ -91,6 +118,7 @@ static void ingenic_intc_write(void *opaque, hwaddr addr, uint64_t data, unsigne
 {
     trace_ingenic_intc_write(addr, data);
     IngenicIntc *s = INGENIC_INTC(opaque);
+    ingenic_turbo_break(&s->turbo);
     uint32_t icmr = s->icmr;
     switch (addr) {
     case REG_ICMSR:
@@ -105,9 +133,6 @@ static void ingenic_intc_write(void *opaque, hwaddr addr, uint64_t data, unsigne
             trace_ingenic_intc_enable(s->icmr);
         intc_update(s);
         break;
-    case REG_ICPR:
-        // Datasheet says ICPR is read-only
-        break;
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "%s: Unknown address " HWADDR_FMT_plx " 0x%"PRIx64"\n",
                       __func__, addr, data);
@@ -131,12 +156,39 @@ static MemoryRegionOps intc_ops = {
     .endianness = DEVICE_NATIVE_ENDIAN,
 };
 
+// ICPR is polled by interrupt handlers, read without the BQL
+static uint64_t ingenic_intc_icpr_read(void *opaque, hwaddr addr, unsigned size)
+{
+    IngenicIntc *s = INGENIC_INTC(opaque);
+    // Idle loops spin here waiting for a timer interrupt, the clock warp
+    // shares state with the main loop timers and needs the BQL
+    if (s->turbo.enabled) {
+        BQL_LOCK_GUARD();
+        ingenic_turbo_poll(&s->turbo);
+    }
+    return qatomic_read(&s->icpr);
+}
+
+static void ingenic_intc_icpr_write(void *opaque, hwaddr addr, uint64_t data, unsigned size)
+{
+    // Datasheet says ICPR is read-only
+}
+
+static MemoryRegionOps intc_icpr_ops = {
+    .read = ingenic_intc_icpr_read,
+    .write = ingenic_intc_icpr_write,
+    .endianness = DEVICE_NATIVE_ENDIAN,
+};
+
 OBJECT_DEFINE_TYPE(IngenicIntc, ingenic_intc, INGENIC_INTC, SYS_BUS_DEVICE)
 
 static void ingenic_intc_init(Object *obj)
 {
     IngenicIntc *s = INGENIC_INTC(obj);
     memory_region_init_io(&s->mr, OBJECT(s), &intc_ops, s, "intc", 0x1000);
+    memory_region_init_io(&s->icpr_mr, OBJECT(s), &intc_icpr_ops, s, "intc.icpr", 4);
+    memory_region_enable_lockless_io(&s->icpr_mr);
+    memory_region_add_subregion_overlap(&s->mr, REG_ICPR, &s->icpr_mr, 1);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mr);
 
     qdev_init_gpio_in_named_with_opaque(DEVICE(obj), &intc_irq, s, "irq-in", 32);
@@ -147,8 +199,37 @@ static void ingenic_intc_finalize(Object *obj)
 {
 }
 
+static int ingenic_intc_post_load(void *opaque, int version_id)
+{
+    IngenicIntc *s = opaque;
+    s->irq_level = !!s->icpr;
+    return 0;
+}
+
+static const VMStateDescription vmstate_ingenic_intc = {
+    .name = "ingenic-intc",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_intc_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(icsr, IngenicIntc),
+        VMSTATE_UINT32(icmr, IngenicIntc),
+        VMSTATE_UINT32(icpr, IngenicIntc),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static Property ingenic_intc_properties[] = {
+    DEFINE_PROP_BOOL("turbo", IngenicIntc, turbo.enabled, false),
+    DEFINE_PROP_END_OF_LIST(),
+};
+
 static void ingenic_intc_class_init(ObjectClass *class, void *data)
 {
+    DeviceClass *dc = DEVICE_CLASS(class);
+    device_class_set_props(dc, ingenic_intc_properties);
+    dc->vmsd = &vmstate_ingenic_intc;
+
     IngenicIntcClass *bch_class = INGENIC_INTC_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
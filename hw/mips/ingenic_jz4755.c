@@ -40,6 +40,7 @@
 
 #include "hw/mips/ingenic_jz4755.h"
 #include "hw/misc/ingenic_cgu.h"
+#include "hw/misc/ingenic_sram.h"
 #include "hw/intc/ingenic_intc.h"
 #include "hw/dma/ingenic_dmac.h"
 #include "hw/timer/ingenic_tcu.h"
@@ -75,25 +76,19 @@ IngenicJZ4755 *ingenic_jz4755_init(MachineState *machine)
 
     // 0x00000000 Cache may be used as SRAM, 16kB
     MemoryRegion *sys_mem = get_system_memory();
-    MemoryRegion *cached_sram = g_new(MemoryRegion, 1);
-    memory_region_init_ram(cached_sram, NULL, "sram.cached", 16 * 1024, &error_fatal);
+    IngenicSram *sram = INGENIC_SRAM(qdev_new(TYPE_INGENIC_SRAM));
+    sysbus_realize_and_unref(SYS_BUS_DEVICE(sram), &error_fatal);
     // Higher priority than SDRAM, to keep cached data when SDRAM gets enabled
-    memory_region_add_subregion_overlap(sys_mem, 0, cached_sram, 1);
-
-    // 0xa0000000 Cache write-through SRAM, 16kB
-    // This is a terrible hack:
-    // Bootloader may write to this uncached address to bypass I/D-cache,
-    // whilst running code from I/D-cache.
-    // Simply ignoring writes to this section should be fine,
-    // as invaliding D-cache would write-back cached data to this address anyway.
-    MemoryRegion *uncached_sram = g_new(MemoryRegion, 1);
-    memory_region_init_ram(uncached_sram, NULL, "sram.uncached", 16 * 1024, &error_fatal);
-    memory_region_add_subregion(sys_mem, 0xa0000000, uncached_sram);
+    sysbus_mmio_map_overlap(SYS_BUS_DEVICE(sram), 0, 0, 1);
+    // 0xa0000000 The uncached kseg1 alias bypasses the cache
+    sysbus_mmio_map(SYS_BUS_DEVICE(sram), 1, 0xa0000000);
+    cpu_mips_add_unmapped_window(env, 0xa0000000, 16 * 1024);
 
     // 0xf4000000 TCSM SRAM, 16kB
     MemoryRegion *tcsm = g_new(MemoryRegion, 1);
     memory_region_init_ram(tcsm, NULL, "tcsm", 16 * 1024, &error_fatal);
     memory_region_add_subregion(sys_mem, 0xf4000000, tcsm);
+    cpu_mips_add_unmapped_window(env, 0xf4000000, 0x10000);
 
     MemoryRegion *ahb0 = g_new(MemoryRegion, 1);
     MemoryRegion *ahb1 = g_new(MemoryRegion, 1);
@@ -261,7 +256,7 @@ IngenicJZ4755 *ingenic_jz4755_init(MachineState *machine)
         {DEVICE(gpio['E' - 'A']), "irq-out",  0, 12},
         {DEVICE(gpio['F' - 'A']), "irq-out",  0, 11},
         // 8 UART1
-        // 6 RTC
+        {DEVICE(rtc),  "irq-out", 0, 6},
         {0}
     };
     for (int i = 0; irqs[i].dev != NULL; i++) {
@@ -275,6 +270,10 @@ IngenicJZ4755 *ingenic_jz4755_init(MachineState *machine)
     // Connect DMA requests
     qdev_connect_gpio_out(nand_rb_splitter, 1,
         qdev_get_gpio_in_named(DEVICE(dmac), "req-in", 1));
+    qdev_connect_gpio_out_named(DEVICE(aic), "dma-tx-req", 0,
+        qdev_get_gpio_in_named(DEVICE(dmac), "req-in", 24));
+    qdev_connect_gpio_out_named(DEVICE(aic), "dma-rx-req", 0,
+        qdev_get_gpio_in_named(DEVICE(dmac), "req-in", 25));
 
     return soc;
 }
@@ -66,7 +66,10 @@ static void ingenic_cgu_reset(Object *obj, ResetType type)
 
 static void ingenic_cgu_update_clocks(IngenicCgu *s)
 {
-    // Update clock frequencies
+    // Recalculate the whole tree first, then publish only the clocks whose
+    // period actually changed, so consumers see a consistent tree and get
+    // at most one callback per register write
+    uint64_t pll_period;
     if ((s->reg.cppcr & (BIT(8) | BIT(9))) == BIT(8)) {
         // Switch to PLL
         uint32_t m = (s->reg.cppcr >> 23) + 2;
@@ -74,10 +77,10 @@ static void ingenic_cgu_update_clocks(IngenicCgu *s)
         uint32_t od = (s->reg.cppcr >> 16) & 3;
         static const uint32_t od_map[] = {1, 2, 2, 4};
         od = od_map[od];
-        clock_update(s->clk_pll, clock_get(s->clk_ext) * (n * od) / m);
+        pll_period = clock_get(s->clk_ext) * (n * od) / m;
     } else {
         // Switch to EXT
-        clock_update(s->clk_pll, clock_get(s->clk_ext));
+        pll_period = clock_get(s->clk_ext);
     }
 
     static const uint32_t div_map[16] = {1, 2, 3, 4, 6, 8, 0};
@@ -88,7 +91,6 @@ static void ingenic_cgu_update_clocks(IngenicCgu *s)
         qemu_log_mask(LOG_GUEST_ERROR, "%s: cclk div by 0\n", __func__);
         cdiv = 1;
     }
-    clock_update(s->clk_cclk, clock_get(s->clk_pll) * cdiv);
 
     // MCLK
     uint32_t mdiv = div_map[(s->reg.cpccr >> 12) & 0x0f];
@@ -96,7 +98,6 @@ static void ingenic_cgu_update_clocks(IngenicCgu *s)
         qemu_log_mask(LOG_GUEST_ERROR, "%s: mclk div by 0\n", __func__);
         mdiv = 1;
     }
-    clock_update(s->clk_mclk, clock_get(s->clk_pll) * mdiv);
 
     // PCLK
     uint32_t pdiv = div_map[(s->reg.cpccr >> 8) & 0x0f];
@@ -104,15 +105,26 @@ static void ingenic_cgu_update_clocks(IngenicCgu *s)
         qemu_log_mask(LOG_GUEST_ERROR, "%s: pdiv div by 0\n", __func__);
         pdiv = 1;
     }
-    clock_update(s->clk_pclk, clock_get(s->clk_pll) * pdiv);
 
     // PCS peripherals
-    uint64_t pcs_period = clock_get(s->clk_pll);
+    uint64_t pcs_period = pll_period;
     if (!(s->reg.cpccr & BIT(21)))
         pcs_period *= 2;
-    clock_update(s->clk_lcdpix, pcs_period * (s->reg.lpcdr & 0x07ff));
 
-    trace_ingenic_cgu_cclk_freq(clock_get_hz(s->clk_cclk));
+    Clock *clks[] = {s->clk_pll, s->clk_cclk, s->clk_mclk, s->clk_pclk, s->clk_lcdpix};
+    bool changed[ARRAY_SIZE(clks)] = {
+        clock_set(s->clk_pll, pll_period),
+        clock_set(s->clk_cclk, pll_period * cdiv),
+        clock_set(s->clk_mclk, pll_period * mdiv),
+        clock_set(s->clk_pclk, pll_period * pdiv),
+        clock_set(s->clk_lcdpix, pcs_period * (s->reg.lpcdr & 0x07ff)),
+    };
+    for (int i = 0; i < ARRAY_SIZE(clks); i++)
+        if (changed[i])
+            clock_propagate(clks[i]);
+
+    if (changed[1])
+        trace_ingenic_cgu_cclk_freq(clock_get_hz(s->clk_cclk));
 }
 
 static uint64_t ingenic_cgu_read(void *opaque, hwaddr addr, unsigned size)
@@ -173,13 +185,16 @@ static void ingenic_cgu_write(void *opaque, hwaddr addr, uint64_t data, unsigned
 
     IngenicCgu *cgu = opaque;
     trace_ingenic_cgu_write(addr, data, size);
+    // Rewriting the same value (common with cpufreq) leaves the tree alone
+    uint32_t cpccr = cgu->reg.cpccr;
+    uint32_t cppcr = cgu->reg.cppcr;
+    uint32_t lpcdr = cgu->reg.lpcdr;
     switch (addr) {
     case REG_CPCCR:
         if (cgu->model == 0x4755)
             cgu->reg.cpccr = data & 0xffefffff;
         else
             cgu->reg.cpccr = data;
-        ingenic_cgu_update_clocks(cgu);
         break;
     case REG_LCR:
         cgu->reg.lcr = data & 0xff;
@@ -190,7 +205,6 @@ static void ingenic_cgu_write(void *opaque, hwaddr addr, uint64_t data, unsigned
             // PLL ON
             cgu->reg.cppcr |= BIT(10);
         }
-        ingenic_cgu_update_clocks(cgu);
         break;
     case REG_CLKGR:
         if (cgu->model == 0x4755)
@@ -212,7 +226,6 @@ static void ingenic_cgu_write(void *opaque, hwaddr addr, uint64_t data, unsigned
             cgu->reg.lpcdr = data & 0xc00007ff;
         else
             cgu->reg.lpcdr = data & 0x800007ff;
-        ingenic_cgu_update_clocks(cgu);
         break;
     case REG_MSCCDR:
         cgu->reg.msccdr = data & 0x1f;
@@ -225,6 +238,9 @@ static void ingenic_cgu_write(void *opaque, hwaddr addr, uint64_t data, unsigned
         qmp_stop(NULL);
         return;
     }
+
+    if (cgu->reg.cpccr != cpccr || cgu->reg.cppcr != cppcr || cgu->reg.lpcdr != lpcdr)
+        ingenic_cgu_update_clocks(cgu);
 }
 
 static MemoryRegionOps cgu_ops = {
@@ -284,11 +300,43 @@ static Property ingenic_cgu_properties[] = {
     DEFINE_PROP_END_OF_LIST(),
 };
 
+static int ingenic_cgu_post_load(void *opaque, int version_id)
+{
+    IngenicCgu *s = opaque;
+    ingenic_cgu_update_clocks(s);
+    return 0;
+}
+
+static const VMStateDescription vmstate_ingenic_cgu = {
+    .name = "ingenic-cgu",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_cgu_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(reg.cpccr, IngenicCgu),
+        VMSTATE_UINT8(reg.lcr, IngenicCgu),
+        VMSTATE_UINT32(reg.rsr, IngenicCgu),
+        VMSTATE_UINT32(reg.cppcr, IngenicCgu),
+        VMSTATE_UINT32(reg.cppsr, IngenicCgu),
+        VMSTATE_UINT32(reg.clkgr, IngenicCgu),
+        VMSTATE_UINT16(reg.opcr, IngenicCgu),
+        VMSTATE_UINT16(reg.scr, IngenicCgu),
+        VMSTATE_UINT16(reg.i2scdr, IngenicCgu),
+        VMSTATE_UINT32(reg.lpcdr, IngenicCgu),
+        VMSTATE_UINT8(reg.msccdr, IngenicCgu),
+        VMSTATE_UINT8(reg.uhccdr, IngenicCgu),
+        VMSTATE_UINT32(reg.ssicdr, IngenicCgu),
+        VMSTATE_UINT32(reg.cimcdr, IngenicCgu),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static void ingenic_cgu_class_init(ObjectClass *class, void *data)
 {
     DeviceClass *dc = DEVICE_CLASS(class);
     device_class_set_props(dc, ingenic_cgu_properties);
     dc->realize = ingenic_cgu_realize;
+    dc->vmsd = &vmstate_ingenic_cgu;
 
     IngenicCguClass *cgu_class = INGENIC_CGU_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
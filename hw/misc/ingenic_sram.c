@@ -0,0 +1,74 @@
+/*
+ * Ingenic XBurst cache-as-RAM emulation
+ *
+ * Copyright (c) 2024 Norman Zhi
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qemu/osdep.h"
+#include "qapi/error.h"
+#include "qemu/module.h"
+#include "hw/sysbus.h"
+#include "hw/qdev-properties.h"
+#include "hw/misc/ingenic_sram.h"
+
+// Until SDRAM is configured, the boot ROM and bootloader run out of the
+// locked I/D-cache. The bootloader may write through the uncached kseg1
+// alias to bypass the cache whilst running code from it, so the two views
+// are backed separately. Code only ever gets translated from the cached
+// view, so writes through the uncached one never invalidate TBs.
+
+static void ingenic_sram_realize(DeviceState *dev, Error **errp)
+{
+    IngenicSram *s = INGENIC_SRAM(dev);
+    SysBusDevice *sbd = SYS_BUS_DEVICE(dev);
+
+    if (!s->size) {
+        error_setg(errp, "SRAM size must not be zero");
+        return;
+    }
+
+    if (!memory_region_init_ram(&s->cached_mr, OBJECT(s), "sram.cached",
+                                s->size, errp))
+        return;
+    sysbus_init_mmio(sbd, &s->cached_mr);
+
+    if (!memory_region_init_ram(&s->uncached_mr, OBJECT(s), "sram.uncached",
+                                s->size, errp))
+        return;
+    sysbus_init_mmio(sbd, &s->uncached_mr);
+}
+
+OBJECT_DEFINE_TYPE(IngenicSram, ingenic_sram, INGENIC_SRAM, SYS_BUS_DEVICE)
+
+static void ingenic_sram_init(Object *obj)
+{
+}
+
+static void ingenic_sram_finalize(Object *obj)
+{
+}
+
+static Property ingenic_sram_properties[] = {
+    DEFINE_PROP_UINT32("size", IngenicSram, size, 16 * 1024),
+    DEFINE_PROP_END_OF_LIST(),
+};
+
+static void ingenic_sram_class_init(ObjectClass *class, void *data)
+{
+    DeviceClass *dc = DEVICE_CLASS(class);
+    device_class_set_props(dc, ingenic_sram_properties);
+    dc->realize = ingenic_sram_realize;
+}
@@ -23,10 +23,15 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/cutils.h"
 #include "qemu/timer.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
 #include "migration/vmstate.h"
+#include "sysemu/rtc.h"
+#include "sysemu/sysemu.h"
+#include "hw/irq.h"
+#include "hw/qdev-properties.h"
 #include "hw/sysbus.h"
 #include "hw/rtc/ingenic_rtc.h"
 #include "trace.h"
@@ -43,13 +48,102 @@
 #define REG_HWRSR   0x30
 #define REG_HSPR    0x34
 
+#define RTCCR_RTCE  BIT(0)
+#define RTCCR_AE    BIT(2)
+#define RTCCR_AIE   BIT(3)
+#define RTCCR_AF    BIT(4)
+#define RTCCR_1HZIE BIT(5)
+#define RTCCR_1HZ   BIT(6)
+#define RTCCR_WRDY  BIT(7)
+
 void qmp_stop(Error **errp);
 
+static int64_t ingenic_rtc_now_ns(IngenicRtc *s)
+{
+    return qemu_clock_get_ns(rtc_clock) + s->offset_ns;
+}
+
+static uint32_t ingenic_rtc_seconds(IngenicRtc *s)
+{
+    return (uint64_t)ingenic_rtc_now_ns(s) / NANOSECONDS_PER_SECOND;
+}
+
+// Latch the 1 Hz flag for every second boundary passed since the last look
+static void ingenic_rtc_update_flags(IngenicRtc *s)
+{
+    uint32_t sec = ingenic_rtc_seconds(s);
+    if (sec != s->hz_sec) {
+        s->rtccr |= RTCCR_1HZ;
+        s->hz_sec = sec;
+    }
+}
+
+static void ingenic_rtc_update_irq(IngenicRtc *s)
+{
+    bool level = ((s->rtccr & RTCCR_1HZ) && (s->rtccr & RTCCR_1HZIE)) ||
+                 ((s->rtccr & RTCCR_AF) && (s->rtccr & RTCCR_AIE));
+    qemu_set_irq(s->irq, level);
+}
+
+// Timers only run for the events the guest enabled
+static void ingenic_rtc_rearm(IngenicRtc *s)
+{
+    int64_t now_ns = ingenic_rtc_now_ns(s);
+    int64_t next_sec_ns = ((uint64_t)now_ns / NANOSECONDS_PER_SECOND + 1) * NANOSECONDS_PER_SECOND;
+
+    if (s->rtccr & RTCCR_1HZIE)
+        timer_mod_ns(s->hz_timer, next_sec_ns - s->offset_ns);
+    else
+        timer_del(s->hz_timer);
+
+    uint32_t delta = s->rtcsar - (uint32_t)((uint64_t)now_ns / NANOSECONDS_PER_SECOND);
+    // A target behind the counter will not match again for decades
+    if ((s->rtccr & RTCCR_AE) && !(s->rtccr & RTCCR_AF) && !s->alarm_fired &&
+        (int32_t)delta >= 0) {
+        // Matching the current second means the alarm is already due
+        int64_t alarm_ns = delta ? next_sec_ns + (int64_t)(delta - 1) * NANOSECONDS_PER_SECOND
+                                 : now_ns;
+        timer_mod_ns(s->alarm_timer, alarm_ns - s->offset_ns);
+    } else {
+        timer_del(s->alarm_timer);
+    }
+}
+
+static void ingenic_rtc_hz_tick(void *opaque)
+{
+    IngenicRtc *s = INGENIC_RTC(opaque);
+    ingenic_rtc_update_flags(s);
+    ingenic_rtc_update_irq(s);
+    ingenic_rtc_rearm(s);
+}
+
+static void ingenic_rtc_alarm(void *opaque)
+{
+    IngenicRtc *s = INGENIC_RTC(opaque);
+    // The timer may run late, a target already passed still counts
+    if (!s->alarm_fired && (int32_t)(ingenic_rtc_seconds(s) - s->rtcsar) >= 0) {
+        s->rtccr |= RTCCR_AF;
+        s->alarm_fired = true;
+    }
+    ingenic_rtc_update_flags(s);
+    ingenic_rtc_update_irq(s);
+    ingenic_rtc_rearm(s);
+}
+
 static void ingenic_rtc_reset(Object *obj, ResetType type)
 {
     IngenicRtc *s = INGENIC_RTC(obj);
-    s->rtcsr = 0;
-    s->rtccr = 0x81;
+    struct tm tm;
+
+    // Start from the host date, following -rtc base=
+    qemu_get_timedate(&tm, 0);
+    s->offset_ns = mktimegm(&tm) * NANOSECONDS_PER_SECOND - qemu_clock_get_ns(rtc_clock);
+    s->hz_sec = ingenic_rtc_seconds(s);
+    s->alarm_fired = false;
+    s->rtccr = RTCCR_WRDY | RTCCR_RTCE;
+    timer_del(s->hz_timer);
+    timer_del(s->alarm_timer);
+    qemu_set_irq(s->irq, 0);
 }
 
 static uint64_t ingenic_rtc_read(void *opaque, hwaddr addr, unsigned size)
@@ -58,10 +152,13 @@ static uint64_t ingenic_rtc_read(void *opaque, hwaddr addr, unsigned size)
     uint64_t data = 0;
     switch (addr) {
     case REG_RTCCR:
+        ingenic_turbo_poll(&s->turbo);
+        ingenic_rtc_update_flags(s);
         data = s->rtccr;
         break;
     case REG_RTCSR:
-        data = (uint32_t)(get_clock_realtime() / 1000000000 - s->rtcsr);
+        ingenic_turbo_poll(&s->turbo);
+        data = ingenic_rtc_seconds(s);
         break;
     case REG_RTCSAR:
         data = s->rtcsar;
@@ -99,15 +196,25 @@ static void ingenic_rtc_write(void *opaque, hwaddr addr, uint64_t data, unsigned
 {
     IngenicRtc *s = INGENIC_RTC(opaque);
     trace_ingenic_rtc_write(addr, data);
+    ingenic_turbo_break(&s->turbo);
     switch (addr) {
     case REG_RTCCR:
-        s->rtccr = (data & 0x2f) | BIT(7);
+        // Flags are cleared by writing 0, they cannot be set by software
+        ingenic_rtc_update_flags(s);
+        s->rtccr = (data & 0x2f) | (s->rtccr & data & (RTCCR_1HZ | RTCCR_AF)) | RTCCR_WRDY;
+        ingenic_rtc_update_irq(s);
+        ingenic_rtc_rearm(s);
         break;
     case REG_RTCSR:
-        s->rtcsr = get_clock_realtime() / 1000000000 - data;
+        s->offset_ns = (int64_t)(uint32_t)data * NANOSECONDS_PER_SECOND - qemu_clock_get_ns(rtc_clock);
+        s->hz_sec = data;
+        s->alarm_fired = false;
+        ingenic_rtc_rearm(s);
         break;
     case REG_RTCSAR:
         s->rtcsar = data;
+        s->alarm_fired = false;
+        ingenic_rtc_rearm(s);
         break;
     case REG_RTCGR:
         if ((s->rtcgr & BIT(31)) == 0)
@@ -151,14 +258,69 @@ static void ingenic_rtc_init(Object *obj)
     IngenicRtc *s = INGENIC_RTC(obj);
     memory_region_init_io(&s->mr, OBJECT(s), &rtc_ops, s, "rtc", 0x1000);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mr);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->irq, "irq-out", 1);
+    s->hz_timer = timer_new_ns(rtc_clock, ingenic_rtc_hz_tick, s);
+    s->alarm_timer = timer_new_ns(rtc_clock, ingenic_rtc_alarm, s);
 }
 
 static void ingenic_rtc_finalize(Object *obj)
 {
+    IngenicRtc *s = INGENIC_RTC(obj);
+    timer_free(s->hz_timer);
+    timer_free(s->alarm_timer);
+}
+
+static int ingenic_rtc_pre_save(void *opaque)
+{
+    IngenicRtc *s = INGENIC_RTC(opaque);
+    // rtc_clock differs between hosts, migrate the offset against the VM clock
+    s->offset_vmstate = s->offset_ns + qemu_clock_get_ns(rtc_clock) -
+                        qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    return 0;
+}
+
+static int ingenic_rtc_post_load(void *opaque, int version_id)
+{
+    IngenicRtc *s = INGENIC_RTC(opaque);
+    s->offset_ns = s->offset_vmstate - qemu_clock_get_ns(rtc_clock) +
+                   qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    ingenic_rtc_update_irq(s);
+    ingenic_rtc_rearm(s);
+    return 0;
 }
 
+static const VMStateDescription vmstate_ingenic_rtc = {
+    .name = "ingenic-rtc",
+    .version_id = 2,
+    .minimum_version_id = 2,
+    .pre_save = ingenic_rtc_pre_save,
+    .post_load = ingenic_rtc_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_INT64(offset_vmstate, IngenicRtc),
+        VMSTATE_UINT32(hz_sec, IngenicRtc),
+        VMSTATE_UINT32(rtcsar, IngenicRtc),
+        VMSTATE_UINT32(rtcgr, IngenicRtc),
+        VMSTATE_UINT32(hspr, IngenicRtc),
+        VMSTATE_UINT16(hwfcr, IngenicRtc),
+        VMSTATE_UINT16(hrcr, IngenicRtc),
+        VMSTATE_UINT8(hwcr, IngenicRtc),
+        VMSTATE_UINT8(rtccr, IngenicRtc),
+        VMSTATE_BOOL(alarm_fired, IngenicRtc),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static Property ingenic_rtc_properties[] = {
+    DEFINE_PROP_BOOL("turbo", IngenicRtc, turbo.enabled, false),
+    DEFINE_PROP_END_OF_LIST(),
+};
+
 static void ingenic_rtc_class_init(ObjectClass *class, void *data)
 {
+    DeviceClass *dc = DEVICE_CLASS(class);
+    dc->vmsd = &vmstate_ingenic_rtc;
+    device_class_set_props(dc, ingenic_rtc_properties);
+
     IngenicRtcClass *bch_class = INGENIC_RTC_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
@@ -123,6 +123,10 @@ void sdbus_write_data(SDBus *sdbus, const void *buf, size_t length)
     if (card) {
         SDCardClass *sc = SD_CARD_GET_CLASS(card);
 
+        if (sc->write_data) {
+            sc->write_data(card, buf, length);
+            return;
+        }
         for (size_t i = 0; i < length; i++) {
             trace_sdbus_write(sdbus_name(sdbus), data[i]);
             sc->write_byte(card, data[i]);
@@ -153,6 +157,10 @@ void sdbus_read_data(SDBus *sdbus, void *buf, size_t length)
     if (card) {
         SDCardClass *sc = SD_CARD_GET_CLASS(card);
 
+        if (sc->read_data) {
+            sc->read_data(card, buf, length);
+            return;
+        }
         for (size_t i = 0; i < length; i++) {
             data[i] = sc->read_byte(card);
             trace_sdbus_read(sdbus_name(sdbus), data[i]);
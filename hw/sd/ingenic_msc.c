@@ -243,6 +243,16 @@ err:
     ingenic_msc_update_irq(s);
 }
 
+// Bytes that can bypass the FIFO, whole FIFO multiples or up to the end of the transfer
+static uint32_t ingenic_msc_bulk_len(IngenicMsc *s, uint32_t len)
+{
+    if (s->data_offset % ARRAY_SIZE(s->data_fifo) != 0)
+        return 0;
+    if (s->data_offset + len == s->data_size)
+        return len;
+    return QEMU_ALIGN_DOWN(len, ARRAY_SIZE(s->data_fifo));
+}
+
 uint32_t ingenic_msc_sd_read(IngenicMsc *s, uint8_t *buf, uint32_t len)
 {
     trace_ingenic_msc_sd_read(s->data_size, s->data_offset, len);
@@ -252,18 +262,25 @@ uint32_t ingenic_msc_sd_read(IngenicMsc *s, uint8_t *buf, uint32_t len)
         qmp_stop(NULL);
     }
     len = MIN(len, avail);
-    for (uint32_t ofs = 0; ofs < len; ofs += 4) {
-        if (s->data_offset % ARRAY_SIZE(s->data_fifo) == 0) {
-            // Data buffer is empty, read more data from SD
-            uint32_t rlen = MIN(ARRAY_SIZE(s->data_fifo), avail);
-            trace_ingenic_msc_fifo_offset(s->data_offset, rlen);
-            sdbus_read_data(&s->sdbus, &s->data_fifo[0], rlen);
+    for (uint32_t ofs = 0; ofs < len;) {
+        uint32_t n = ingenic_msc_bulk_len(s, len - ofs);
+        if (n) {
+            // Read straight from SD into the destination
+            trace_ingenic_msc_fifo_offset(s->data_offset, n);
+            sdbus_read_data(&s->sdbus, &buf[ofs], n);
+        } else {
+            uint32_t fifo_ofs = s->data_offset % ARRAY_SIZE(s->data_fifo);
+            if (fifo_ofs == 0) {
+                // Data buffer is empty, read more data from SD
+                uint32_t rlen = MIN(ARRAY_SIZE(s->data_fifo), s->data_size - s->data_offset);
+                trace_ingenic_msc_fifo_offset(s->data_offset, rlen);
+                sdbus_read_data(&s->sdbus, &s->data_fifo[0], rlen);
+            }
+            n = MIN(len - ofs, ARRAY_SIZE(s->data_fifo) - fifo_ofs);
+            memcpy(&buf[ofs], &s->data_fifo[fifo_ofs], n);
         }
-
-        // From host mem to host mem, endianness doesn't matter
-        uint32_t v = ldl_he_p(&s->data_fifo[s->data_offset % ARRAY_SIZE(s->data_fifo)]);
-        stl_he_p(&buf[ofs], v);
-        s->data_offset += 4;
+        ofs += n;
+        s->data_offset += n;
     }
     ingenic_msc_update_rx_flags(s);
     return len;
@@ -278,20 +295,30 @@ uint32_t ingenic_msc_sd_write(IngenicMsc *s, const uint8_t *buf, uint32_t len)
         qmp_stop(NULL);
     }
     len = MIN(len, avail);
-    for (uint32_t ofs = 0; ofs < len; ofs += 4) {
-        // From host mem to host mem, endianness doesn't matter
-        uint32_t v = ldl_he_p(&buf[ofs]);
-        stl_he_p(&s->data_fifo[s->data_offset % ARRAY_SIZE(s->data_fifo)], v);
-        s->data_offset += 4;
-
-        if (s->data_offset % ARRAY_SIZE(s->data_fifo) == 0) {
-            // Data buffer is full, write back to SD
-            uint32_t wlen = ARRAY_SIZE(s->data_fifo);
-            trace_ingenic_msc_fifo_offset(s->data_offset - wlen, wlen);
-            sdbus_write_data(&s->sdbus, &s->data_fifo[0], wlen);
+    bool fifo = s->data_offset % ARRAY_SIZE(s->data_fifo) != 0;
+    for (uint32_t ofs = 0; ofs < len;) {
+        uint32_t n = ingenic_msc_bulk_len(s, len - ofs);
+        fifo = !n;
+        if (n) {
+            // Write straight from the source to SD
+            trace_ingenic_msc_fifo_offset(s->data_offset, n);
+            sdbus_write_data(&s->sdbus, &buf[ofs], n);
+        } else {
+            uint32_t fifo_ofs = s->data_offset % ARRAY_SIZE(s->data_fifo);
+            n = MIN(len - ofs, ARRAY_SIZE(s->data_fifo) - fifo_ofs);
+            memcpy(&s->data_fifo[fifo_ofs], &buf[ofs], n);
+            if (fifo_ofs + n == ARRAY_SIZE(s->data_fifo)) {
+                // Data buffer is full, write back to SD
+                uint32_t wlen = ARRAY_SIZE(s->data_fifo);
+                trace_ingenic_msc_fifo_offset(s->data_offset + n - wlen, wlen);
+                sdbus_write_data(&s->sdbus, &s->data_fifo[0], wlen);
+            }
         }
+        ofs += n;
+        s->data_offset += n;
     }
-    if ((s->data_offset % ARRAY_SIZE(s->data_fifo) != 0) && (len == avail)) {
+    if (fifo && (s->data_offset % ARRAY_SIZE(s->data_fifo) != 0) &&
+        (s->data_offset == s->data_size)) {
         // Data buffer is not full, but at end of data transfer
         uint32_t wlen = s->data_offset % ARRAY_SIZE(s->data_fifo);
         trace_ingenic_msc_fifo_offset(s->data_offset - wlen, wlen);
@@ -436,6 +463,33 @@ static void ingenic_msc_finalize(Object *obj)
 {
 }
 
+static const VMStateDescription vmstate_ingenic_msc = {
+    .name = "ingenic-msc",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT16_ARRAY(resp, IngenicMsc, 8),
+        VMSTATE_UINT8(resp_offset, IngenicMsc),
+        VMSTATE_UINT8_ARRAY(data_fifo, IngenicMsc, 4096),
+        VMSTATE_UINT32(data_offset, IngenicMsc),
+        VMSTATE_UINT32(data_size, IngenicMsc),
+        VMSTATE_UINT16(prev_irq, IngenicMsc),
+        VMSTATE_BOOL(data_fifo_avail, IngenicMsc),
+        VMSTATE_UINT32(reg.stat, IngenicMsc),
+        VMSTATE_UINT8(reg.clkrt, IngenicMsc),
+        VMSTATE_UINT32(reg.cmdat, IngenicMsc),
+        VMSTATE_UINT16(reg.blklen, IngenicMsc),
+        VMSTATE_UINT16(reg.nob, IngenicMsc),
+        VMSTATE_UINT16(reg.snob, IngenicMsc),
+        VMSTATE_UINT16(reg.imask, IngenicMsc),
+        VMSTATE_UINT16(reg.ireg, IngenicMsc),
+        VMSTATE_UINT8(reg.cmd, IngenicMsc),
+        VMSTATE_UINT32(reg.arg, IngenicMsc),
+        VMSTATE_UINT8(reg.lpm, IngenicMsc),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static Property ingenic_msc_properties[] = {
     DEFINE_PROP_UINT32("model", IngenicMsc, model, 0x4755),
     DEFINE_PROP_END_OF_LIST(),
@@ -445,6 +499,7 @@ static void ingenic_msc_class_init(ObjectClass *class, void *data)
 {
     DeviceClass *dc = DEVICE_CLASS(class);
     device_class_set_props(dc, ingenic_msc_properties);
+    dc->vmsd = &vmstate_ingenic_msc;
 
     IngenicMscClass *msc_class = INGENIC_MSC_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
@@ -2124,6 +2124,117 @@ uint8_t sd_read_byte(SDState *sd)
     return ret;
 }
 
+/*
+ * Number of whole blocks a bulk transfer of @length bytes can move in one
+ * block layer request, or 0 if the byte-wise path has to handle it.
+ */
+static uint32_t sd_bulk_blocks(SDState *sd, enum SDCardStates state,
+                               uint32_t blk_len, size_t length)
+{
+    uint32_t nblk;
+
+    if (!sd->blk || !blk_is_inserted(sd->blk) || !sd->enable) {
+        return 0;
+    }
+    if (sd->state != state || sd->data_offset != 0 || !blk_len) {
+        return 0;
+    }
+    if (sd->card_status & (ADDRESS_ERROR | WP_VIOLATION)) {
+        return 0;
+    }
+
+    switch (sd->current_cmd) {
+    case 17:  /* CMD17:  READ_SINGLE_BLOCK */
+    case 24:  /* CMD24:  WRITE_SINGLE_BLOCK */
+        return length >= blk_len ? 1 : 0;
+    case 18:  /* CMD18:  READ_MULTIPLE_BLOCK */
+    case 25:  /* CMD25:  WRITE_MULTIPLE_BLOCK */
+        nblk = MIN(length / blk_len, UINT32_MAX);
+        if (sd->multi_blk_cnt != 0) {
+            nblk = MIN(nblk, sd->multi_blk_cnt);
+        }
+        /* Leave out of range blocks to the byte path to report the error */
+        if (sd->data_start >= sd->size) {
+            return 0;
+        }
+        return MIN(nblk, (sd->size - sd->data_start) / blk_len);
+    default:
+        return 0;
+    }
+}
+
+static void sd_bulk_advance(SDState *sd, uint32_t nblk, uint32_t blk_len)
+{
+    if (sd->current_cmd == 17 || sd->current_cmd == 24) {
+        sd->state = sd_transfer_state;
+        return;
+    }
+    sd->data_start += (uint64_t)nblk * blk_len;
+    if (sd->multi_blk_cnt != 0) {
+        sd->multi_blk_cnt -= nblk;
+        if (sd->multi_blk_cnt == 0) {
+            /* Stop! */
+            sd->state = sd_transfer_state;
+        }
+    }
+}
+
+static void sd_read_data(SDState *sd, void *buf, size_t length)
+{
+    uint8_t *data = buf;
+    size_t ofs = 0;
+
+    while (ofs < length) {
+        uint32_t io_len = (sd->ocr & (1 << 30)) ? 512 : sd->blk_len;
+        uint32_t nblk = sd_bulk_blocks(sd, sd_sendingdata_state, io_len,
+                                       length - ofs);
+        if (nblk) {
+            uint64_t len = (uint64_t)nblk * io_len;
+            trace_sdcard_read_block(sd->data_start, len);
+            if (blk_pread(sd->blk, sd->data_start, len, &data[ofs], 0) < 0) {
+                fprintf(stderr, "sd_read_data: read error on host side\n");
+            }
+            sd_bulk_advance(sd, nblk, io_len);
+            ofs += len;
+        } else {
+            data[ofs++] = sd_read_byte(sd);
+        }
+    }
+}
+
+static void sd_write_data(SDState *sd, const void *buf, size_t length)
+{
+    const uint8_t *data = buf;
+    size_t ofs = 0;
+
+    while (ofs < length) {
+        uint32_t nblk = sd_bulk_blocks(sd, sd_receivingdata_state, sd->blk_len,
+                                       length - ofs);
+        if (nblk && sd->size <= SDSC_MAX_CAPACITY) {
+            /* Stop before the first write protected group */
+            for (uint32_t i = 0; i < nblk; i++) {
+                if (sd_wp_addr(sd, sd->data_start + (uint64_t)i * sd->blk_len)) {
+                    nblk = i;
+                    break;
+                }
+            }
+        }
+        if (nblk) {
+            uint64_t len = (uint64_t)nblk * sd->blk_len;
+            trace_sdcard_write_block(sd->data_start, len);
+            if (blk_pwrite(sd->blk, sd->data_start, len, &data[ofs], 0) < 0) {
+                fprintf(stderr, "sd_write_data: write error on host side\n");
+            }
+            sd->blk_written += nblk;
+            sd->csd[14] |= 0x40;
+            sd_bulk_advance(sd, nblk, sd->blk_len);
+            ofs += len;
+        } else {
+            sd_write_byte(sd, data[ofs++]);
+        }
+    }
+}
+
 static bool sd_receive_ready(SDState *sd)
 {
     return sd->state == sd_receivingdata_state;
@@ -2270,6 +2381,8 @@ static void sd_class_init(ObjectClass *klass, void *data)
     sc->do_command = sd_do_command;
     sc->write_byte = sd_write_byte;
     sc->read_byte = sd_read_byte;
+    sc->write_data = sd_write_data;
+    sc->read_data = sd_read_data;
     sc->receive_ready = sd_receive_ready;
     sc->data_ready = sd_data_ready;
     sc->enable = sd_enable;
@@ -739,11 +739,30 @@ static void get_adma_description(SDHCIState *s, ADMADescr *dscr)
     }
 }
 
+/*
+ * Number of whole blocks an ADMA descriptor of @length bytes can move
+ * without going through the FIFO buffer, 0 if a partial block is pending.
+ */
+static unsigned int sdhci_adma_whole_blocks(SDHCIState *s, unsigned int length,
+                                            uint16_t block_size)
+{
+    unsigned int nblk;
+
+    if (s->data_count || !block_size) {
+        return 0;
+    }
+    nblk = length / block_size;
+    if (s->trnmod & SDHC_TRNS_BLK_CNT_EN) {
+        nblk = MIN(nblk, s->blkcnt);
+    }
+    return nblk;
+}
+
 /* Advanced DMA data transfer */
 
 static void sdhci_do_adma(SDHCIState *s)
 {
-    unsigned int begin, length;
+    unsigned int begin, length, nblk;
     const uint16_t block_size = s->blksize & BLOCK_SIZE_MASK;
     const MemTxAttrs attrs = { .memory = true };
     ADMADescr dscr = {};
@@ -785,6 +804,28 @@ static void sdhci_do_adma(SDHCIState *s)
             if (s->trnmod & SDHC_TRNS_READ) {
                 s->prnsts |= SDHC_DOING_READ;
                 while (length) {
+                    nblk = sdhci_adma_whole_blocks(s, length, block_size);
+                    if (nblk) {
+                        /* Whole blocks go to the card in one request */
+                        size_t len = nblk * block_size;
+                        g_autofree uint8_t *buf = g_malloc(len);
+
+                        sdbus_read_data(&s->sdbus, buf, len);
+                        res = dma_memory_write(s->dma_as, dscr.addr, buf, len,
+                                               attrs);
+                        if (res != MEMTX_OK) {
+                            break;
+                        }
+                        dscr.addr += len;
+                        length -= len;
+                        if (s->trnmod & SDHC_TRNS_BLK_CNT_EN) {
+                            s->blkcnt -= nblk;
+                            if (s->blkcnt == 0) {
+                                break;
+                            }
+                        }
+                        continue;
+                    }
                     if (s->data_count == 0) {
                         sdbus_read_data(&s->sdbus, s->fifo_buffer, block_size);
                     }
@@ -817,6 +858,27 @@ static void sdhci_do_adma(SDHCIState *s)
             } else {
                 s->prnsts |= SDHC_DOING_WRITE;
                 while (length) {
+                    nblk = sdhci_adma_whole_blocks(s, length, block_size);
+                    if (nblk) {
+                        size_t len = nblk * block_size;
+                        g_autofree uint8_t *buf = g_malloc(len);
+
+                        res = dma_memory_read(s->dma_as, dscr.addr, buf, len,
+                                              attrs);
+                        if (res != MEMTX_OK) {
+                            break;
+                        }
+                        sdbus_write_data(&s->sdbus, buf, len);
+                        dscr.addr += len;
+                        length -= len;
+                        if (s->trnmod & SDHC_TRNS_BLK_CNT_EN) {
+                            s->blkcnt -= nblk;
+                            if (s->blkcnt == 0) {
+                                break;
+                            }
+                        }
+                        continue;
+                    }
                     begin = s->data_count;
                     if ((length + begin) < block_size) {
                         s->data_count = length + begin;
@@ -30,6 +30,7 @@
 #include "hw/qdev-clock.h"
 #include "hw/qdev-properties.h"
 #include "hw/timer/ingenic_tcu.h"
+#include "hw/timer/ingenic_tcu_cnt.h"
 #include "hw/misc/ingenic_cgu.h"
 #include "trace.h"
 
@@ -71,6 +72,8 @@ static void update_irq(IngenicTcu *s)
     if (irq != s->irq_state) {
         s->irq_state = irq;
         trace_ingenic_tcu_irq(irq);
+        // Evaluate the CPU interrupt line once for all TCU outputs
+        ingenic_intc_batch_begin(s->intc);
         if (s->model == 0x4755) {
             // OST uses interrupt 0
             qemu_set_irq(s->irq[0], !!(irq & 0x00008000));
@@ -85,6 +88,7 @@ static void update_irq(IngenicTcu *s)
             // Timer 2-7 has one interrupt in common
             qemu_set_irq(s->irq[2], !!(irq & 0x00fc00fc));
         }
+        ingenic_intc_batch_end(s->intc);
     }
 }
 
@@ -159,20 +163,15 @@ static void tmr_update_cnt(IngenicTcuTimerCommon *tmr)
     }
     //qemu_log("%s: delta_ticks %"PRIu64"\n", __func__, delta_ticks);
 
+    uint32_t hits = ingenic_tcu_cnt_advance(&tmr->cnt, tmr->top, tmr->comp,
+                                            tmr->cnt_max, delta_ticks);
     uint32_t irq_mask = 0;
-    for (;;) {
-        // HALF match
-        if (tmr->comp == tmr->cnt)
-            irq_mask |= tmr->irq_comp_mask;
-        // FULL match
-        if (tmr->top == tmr->cnt)
-            irq_mask |= tmr->irq_top_mask;
-        // Update clock & timer counter
-        if (delta_ticks--)
-            tmr->cnt = tmr->top == tmr->cnt ? 0 : tmr->cnt + 1;
-        else
-            break;
-    }
+    // HALF match
+    if (hits & INGENIC_TCU_CNT_HIT_COMP)
+        irq_mask |= tmr->irq_comp_mask;
+    // FULL match
+    if (hits & INGENIC_TCU_CNT_HIT_TOP)
+        irq_mask |= tmr->irq_top_mask;
 
     if (irq_mask) {
         IngenicTcu *s = tmr->tcu;
@@ -215,6 +214,7 @@ static uint64_t ingenic_tcu_timer_read(IngenicTcuTimer *timer, hwaddr addr, unsi
         data = timer->tmr.comp;
         break;
     case REG_TCNT0 & 0x0f:
+        ingenic_turbo_poll(&timer->tmr.tcu->turbo);
         tmr_update_cnt(&timer->tmr);
         data = timer->tmr.cnt;
         break;
@@ -264,6 +264,8 @@ static void ingenic_tcu_timer_write(IngenicTcuTimer *timer, hwaddr addr, uint64_
 static void ingenic_tcu_reset(Object *obj, ResetType type)
 {
     IngenicTcu *s = INGENIC_TCU(obj);
+    // Interrupt controller used for batched line updates, if any
+    s->intc = ingenic_intc_get_intc();
     for (int i = 0; i < INGENIC_TCU_MAX_TIMERS; i++)
         timer_del(&s->tcu.timer[i].tmr.qts);
     timer_del(&s->ost.tmr.qts);
@@ -300,6 +302,7 @@ static uint64_t ingenic_tcu_read(void *opaque, hwaddr addr, unsigned size)
             data = s->ost.tmr.comp;
             break;
         case REG_OSTCNT:
+            ingenic_turbo_poll(&s->turbo);
             tmr_update_cnt(&s->ost.tmr);
             data = s->ost.tmr.cnt;
             break;
@@ -322,6 +325,7 @@ static void ingenic_tcu_write(void *opaque, hwaddr addr, uint64_t data, unsigned
 {
     trace_ingenic_tcu_write(addr, data);
     IngenicTcu *s = INGENIC_TCU(opaque);
+    ingenic_turbo_break(&s->turbo);
     if (addr >= 0x40 && addr < 0xc0) {
         uint32_t timer = (addr - 0x40) / 0x10;
         ingenic_tcu_timer_write(&s->tcu.timer[timer], addr, data, size);
@@ -418,6 +422,7 @@ static void ingenic_tcu_init(Object *obj)
         s->tcu.timer[i].tmr.tcu = s;
         s->tcu.timer[i].tmr.irq_top_mask  = 0x00000001 << i;
         s->tcu.timer[i].tmr.irq_comp_mask = 0x00010000 << i;
+        s->tcu.timer[i].tmr.cnt_max = 0xffff;
         timer_init_ns(&s->tcu.timer[i].tmr.qts, QEMU_CLOCK_VIRTUAL,
                       &tmr_cb, &s->tcu.timer[i].tmr);
     }
@@ -426,6 +431,7 @@ static void ingenic_tcu_init(Object *obj)
     s->ost.tmr.tcu = s;
     s->ost.tmr.irq_top_mask  = 0x00008000;
     s->ost.tmr.irq_comp_mask = 0x00008000;
+    s->ost.tmr.cnt_max = 0xffffffff;
     timer_init_ns(&s->ost.tmr.qts, QEMU_CLOCK_VIRTUAL, &tmr_cb, &s->ost.tmr);
 
     // Interrupts
@@ -440,8 +446,62 @@ static void ingenic_tcu_finalize(Object *obj)
     timer_del(&s->ost.tmr.qts);
 }
 
+static const VMStateDescription vmstate_ingenic_tcu_timer_common = {
+    .name = "ingenic-tcu/timer-common",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_TIMER(qts, IngenicTcuTimerCommon),
+        VMSTATE_INT64(qts_start_ns, IngenicTcuTimerCommon),
+        VMSTATE_UINT64(clk_period, IngenicTcuTimerCommon),
+        VMSTATE_UINT64(clk_ticks, IngenicTcuTimerCommon),
+        VMSTATE_UINT32(top, IngenicTcuTimerCommon),
+        VMSTATE_UINT32(comp, IngenicTcuTimerCommon),
+        VMSTATE_UINT32(cnt, IngenicTcuTimerCommon),
+        VMSTATE_BOOL(enabled, IngenicTcuTimerCommon),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_ingenic_tcu_timer = {
+    .name = "ingenic-tcu/timer",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_STRUCT(tmr, IngenicTcuTimer, 1, vmstate_ingenic_tcu_timer_common,
+                       IngenicTcuTimerCommon),
+        VMSTATE_UINT16(tcsr, IngenicTcuTimer),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_ingenic_tcu = {
+    .name = "ingenic-tcu",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(irq_state, IngenicTcu),
+        VMSTATE_UINT32(tcu.tstr, IngenicTcu),
+        VMSTATE_UINT32(tcu.tsr, IngenicTcu),
+        VMSTATE_UINT16(tcu.ter, IngenicTcu),
+        VMSTATE_UINT32(tcu.tfr, IngenicTcu),
+        VMSTATE_UINT32(tcu.tmr, IngenicTcu),
+        VMSTATE_STRUCT_ARRAY(tcu.timer, IngenicTcu, INGENIC_TCU_MAX_TIMERS, 1,
+                             vmstate_ingenic_tcu_timer, IngenicTcuTimer),
+        VMSTATE_UINT16(ost.tcsr, IngenicTcu),
+        VMSTATE_STRUCT(ost.tmr, IngenicTcu, 1, vmstate_ingenic_tcu_timer_common,
+                       IngenicTcuTimerCommon),
+        VMSTATE_UINT16(wdt.tdr, IngenicTcu),
+        VMSTATE_UINT8(wdt.tcer, IngenicTcu),
+        VMSTATE_UINT16(wdt.tcnt, IngenicTcu),
+        VMSTATE_UINT16(wdt.tcsr, IngenicTcu),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static Property ingenic_tcu_properties[] = {
     DEFINE_PROP_UINT32("model", IngenicTcu, model, 0x4755),
+    DEFINE_PROP_BOOL("turbo", IngenicTcu, turbo.enabled, false),
     DEFINE_PROP_END_OF_LIST(),
 };
 
@@ -449,6 +509,7 @@ static void ingenic_tcu_class_init(ObjectClass *class, void *data)
 {
     DeviceClass *dc = DEVICE_CLASS(class);
     device_class_set_props(dc, ingenic_tcu_properties);
+    dc->vmsd = &vmstate_ingenic_tcu;
 
     IngenicTcuClass *bch_class = INGENIC_TCU_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
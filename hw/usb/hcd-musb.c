@@ -26,6 +26,9 @@
 #include "hw/usb/hcd-musb.h"
 #include "hw/irq.h"
 #include "hw/hw.h"
+#include "migration/blocker.h"
+#include "migration/vmstate.h"
+#include "qapi/error.h"
 
 /* Common USB registers */
 #define MUSB_HDRC_FADDR         0x00    /* 8-bit */
@@ -299,6 +302,7 @@ struct MUSBEndPoint {
     int timeout[2];     /* Always in microframes */
 
     uint8_t *buf[2];
+    bool fifo_set[2];   /* buf[] points at a FIFO the guest configured */
     int fifolen[2];
     int fifostart[2];
     int fifoaddr[2];
@@ -336,6 +340,9 @@ struct MUSBState {
 
     uint8_t buf[0x8000];
 
+    /* Packets to an attached device cannot be migrated */
+    Error *migration_blocker;
+
         /* Duplicating the world since 2008!...  probably we should have 32
          * logical, single endpoints instead.  */
     MUSBEndPoint ep[16];
@@ -391,6 +398,97 @@ struct MUSBState *musb_init(DeviceState *parent_device, int gpio_base)
     return s;
 }
 
+static int musb_post_load(void *opaque, int version_id)
+{
+    MUSBState *s = opaque;
+    int i, dir;
+
+    if (s->idx < 0 || s->idx >= 16) {
+        return -EINVAL;
+    }
+
+    /*
+     * Rebuild the FIFO pointers from the FIFO address registers, only
+     * for the FIFOs the guest set up, so that DMA is still refused on
+     * the others.  The FIFO positions index the buffer directly.
+     */
+    for (i = 0; i < 16; i++) {
+        MUSBEndPoint *ep = &s->ep[i];
+
+        for (dir = 0; dir < 2; dir++) {
+            int offset = (ep->fifoaddr[dir] << 3) & 0x7ff;
+
+            if (ep->fifostart[dir] < 0 || ep->fifolen[dir] < 0 ||
+                offset + ep->fifostart[dir] + ep->fifolen[dir] >
+                sizeof(s->buf)) {
+                return -EINVAL;
+            }
+            ep->buf[dir] = ep->fifo_set[dir] ? s->buf + offset : NULL;
+        }
+        if (((ep->fifoaddr[1] << 3) & 0x7ff) + ep->fifostart[1] +
+            ep->rxcount > sizeof(s->buf)) {
+            return -EINVAL;
+        }
+    }
+    return 0;
+}
+
+static const VMStateDescription vmstate_musb_ep = {
+    .name = "musb/ep",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT16_ARRAY(faddr, MUSBEndPoint, 2),
+        VMSTATE_UINT8_ARRAY(haddr, MUSBEndPoint, 2),
+        VMSTATE_UINT8_ARRAY(hport, MUSBEndPoint, 2),
+        VMSTATE_UINT16_ARRAY(csr, MUSBEndPoint, 2),
+        VMSTATE_UINT16_ARRAY(maxp, MUSBEndPoint, 2),
+        VMSTATE_UINT16(rxcount, MUSBEndPoint),
+        VMSTATE_UINT8_ARRAY(type, MUSBEndPoint, 2),
+        VMSTATE_UINT8_ARRAY(interval, MUSBEndPoint, 2),
+        VMSTATE_UINT8(config, MUSBEndPoint),
+        VMSTATE_UINT8(fifosize, MUSBEndPoint),
+        VMSTATE_INT32_ARRAY(timeout, MUSBEndPoint, 2),
+        VMSTATE_INT32_ARRAY(fifolen, MUSBEndPoint, 2),
+        VMSTATE_INT32_ARRAY(fifostart, MUSBEndPoint, 2),
+        VMSTATE_INT32_ARRAY(fifoaddr, MUSBEndPoint, 2),
+        VMSTATE_BOOL_ARRAY(fifo_set, MUSBEndPoint, 2),
+        VMSTATE_INT32_ARRAY(status, MUSBEndPoint, 2),
+        VMSTATE_INT32_ARRAY(ext_size, MUSBEndPoint, 2),
+        VMSTATE_INT32_ARRAY(interrupt, MUSBEndPoint, 2),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+/*
+ * Register, FIFO and endpoint state.  Packets in flight to an attached
+ * device are not covered, a migration blocker is held while one is
+ * attached.
+ */
+const VMStateDescription vmstate_musb = {
+    .name = "musb",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = musb_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_INT32(idx, MUSBState),
+        VMSTATE_UINT8(devctl, MUSBState),
+        VMSTATE_UINT8(power, MUSBState),
+        VMSTATE_UINT8(faddr, MUSBState),
+        VMSTATE_UINT8(intr, MUSBState),
+        VMSTATE_UINT8(mask, MUSBState),
+        VMSTATE_UINT16(tx_intr, MUSBState),
+        VMSTATE_UINT16(tx_mask, MUSBState),
+        VMSTATE_UINT16(rx_intr, MUSBState),
+        VMSTATE_UINT16(rx_mask, MUSBState),
+        VMSTATE_INT32(setup_len, MUSBState),
+        VMSTATE_INT32(session, MUSBState),
+        VMSTATE_UINT8_ARRAY(buf, MUSBState, 0x8000),
+        VMSTATE_STRUCT_ARRAY(ep, MUSBState, 16, 1, vmstate_musb_ep, MUSBEndPoint),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static void musb_vbus_set(MUSBState *s, int level)
 {
     if (level)
@@ -507,6 +605,12 @@ static void musb_attach(USBPort *port)
 {
     MUSBState *s = (MUSBState *) port->opaque;
 
+    if (!s->migration_blocker) {
+        error_setg(&s->migration_blocker,
+                   "Migration is disabled while a USB device is attached to the MUSB port");
+        migrate_add_blocker(&s->migration_blocker, NULL);
+    }
+
     musb_intr_set(s, musb_irq_vbus_request, 1);
     musb_session_update(s, 0, s->session);
 }
@@ -517,6 +621,10 @@ static void musb_detach(USBPort *port)
 
     musb_async_cancel_device(s, port->dev);
 
+    if (s->migration_blocker) {
+        migrate_del_blocker(&s->migration_blocker);
+    }
+
     musb_intr_set(s, musb_irq_disconnect, 1);
     musb_session_update(s, 1, s->session);
 }
@@ -966,6 +1074,71 @@ static void musb_write_fifo(MUSBEndPoint *ep, uint8_t value)
      ep->csr[0] |= MGC_M_TXCSR_FIFONOTEMPTY;
 }
 
+/*
+ * Bulk FIFO access for DMA engines wrapped around the core.  Unlike the
+ * byte accessors above these move a whole packet at a time and are not
+ * limited to the 64 byte PIO window.
+ */
+int musb_dma_tx(MUSBState *s, int epnum, const uint8_t *buf, int len)
+{
+    MUSBEndPoint *ep = s->ep + epnum;
+    int maxp = ep->maxp[0] & 0x7ff;
+    int room;
+
+    if (!ep->buf[0] || (ep->csr[0] & MGC_M_TXCSR_TXPKTRDY)) {
+        /* Previous packet is still in flight */
+        return 0;
+    }
+
+    room = sizeof(s->buf) - (ep->buf[0] - s->buf) - ep->fifostart[0];
+    len = MIN(len, MIN(maxp ? maxp : 64, room) - ep->fifolen[0]);
+    if (len <= 0) {
+        return 0;
+    }
+
+    memcpy(ep->buf[0] + ep->fifostart[0] + ep->fifolen[0], buf, len);
+    ep->fifolen[0] += len;
+    ep->csr[0] |= MGC_M_TXCSR_FIFONOTEMPTY;
+
+    /* AUTOSET sends full packets without waiting for the driver */
+    if ((ep->csr[0] & MGC_M_TXCSR_AUTOSET) && ep->fifolen[0] == maxp) {
+        ep->csr[0] |= MGC_M_TXCSR_TXPKTRDY;
+        musb_tx_rdy(s, epnum);
+    }
+    return len;
+}
+
+int musb_dma_rx(MUSBState *s, int epnum, uint8_t *buf, int len, bool *eop)
+{
+    MUSBEndPoint *ep = s->ep + epnum;
+    int maxp = ep->maxp[1] & 0x7ff;
+
+    *eop = false;
+    if (!ep->buf[1] || !(ep->csr[1] & MGC_M_RXCSR_RXPKTRDY)) {
+        /* Nothing received yet */
+        return 0;
+    }
+
+    len = MIN(len, ep->rxcount - ep->fifolen[1]);
+    if (len > 0) {
+        memcpy(buf, ep->buf[1] + ep->fifostart[1] + ep->fifolen[1], len);
+        ep->fifolen[1] += len;
+        ep->csr[1] &= ~MGC_M_RXCSR_FIFOFULL;
+    }
+
+    if (ep->fifolen[1] >= ep->rxcount) {
+        /* Short packets terminate the transfer and are left to the driver */
+        *eop = ep->rxcount < maxp;
+        if (!*eop && (ep->csr[1] & MGC_M_RXCSR_AUTOCLEAR)) {
+            ep->csr[1] &= ~MGC_M_RXCSR_RXPKTRDY;
+            if (ep->csr[1] & MGC_M_RXCSR_H_AUTOREQ) {
+                musb_rx_req(s, epnum);
+            }
+        }
+    }
+    return MAX(len, 0);
+}
+
 static void musb_ep_frame_cancel(MUSBEndPoint *ep, int dir)
 {
     if (ep->intv_timer[dir])
@@ -1468,11 +1641,13 @@ static void musb_writeh(void *opaque, hwaddr addr, uint32_t value)
         break;
     case MUSB_HDRC_TXFIFOADDR:
         s->ep[s->idx].fifoaddr[0] = value;
+        s->ep[s->idx].fifo_set[0] = true;
         s->ep[s->idx].buf[0] =
                 s->buf + ((value << 3) & 0x7ff );
         break;
     case MUSB_HDRC_RXFIFOADDR:
         s->ep[s->idx].fifoaddr[1] = value;
+        s->ep[s->idx].fifo_set[1] = true;
         s->ep[s->idx].buf[1] =
                 s->buf + ((value << 3) & 0x7ff);
         break;
@@ -125,6 +125,9 @@
 #define IMAN_IP         (1<<0)
 #define IMAN_IE         (1<<1)
 
+#define IMOD_IMODI_MASK 0xffff
+#define IMOD_INTERVAL_NS 250
+
 #define ERDP_EHB        (1<<3)
 
 #define TRB_SIZE 16
@@ -582,29 +585,70 @@ static void xhci_intr_update(XHCIState *xhci, int v)
     }
 }
 
+static void xhci_intr_deliver(XHCIState *xhci, int v)
+{
+    XHCIInterrupter *intr = &xhci->intr[v];
+    uint32_t imodi = intr->imod & IMOD_IMODI_MASK;
+
+    if (!(intr->iman & IMAN_IP) || !(intr->iman & IMAN_IE)) {
+        return;
+    }
+    if (!(xhci->usbcmd & USBCMD_INTE)) {
+        return;
+    }
+    if (imodi) {
+        intr->imod_deadline = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) +
+                              (int64_t)imodi * IMOD_INTERVAL_NS;
+    }
+    if (xhci->intr_raise) {
+        if (xhci->intr_raise(xhci, v, true)) {
+            intr->iman &= ~IMAN_IP;
+        }
+    }
+}
+
+static void xhci_imod_timer(void *opaque)
+{
+    XHCIInterrupter *intr = opaque;
+    XHCIState *xhci = intr->xhci;
+
+    xhci_intr_deliver(xhci, intr - xhci->intr);
+}
+
 static void xhci_intr_raise(XHCIState *xhci, int v)
 {
-    bool pending = (xhci->intr[v].erdp_low & ERDP_EHB);
+    XHCIInterrupter *intr = &xhci->intr[v];
+    bool pending = (intr->erdp_low & ERDP_EHB);
 
-    xhci->intr[v].erdp_low |= ERDP_EHB;
-    xhci->intr[v].iman |= IMAN_IP;
+    intr->erdp_low |= ERDP_EHB;
+    intr->iman |= IMAN_IP;
     xhci->usbsts |= USBSTS_EINT;
 
     if (pending) {
         return;
     }
-    if (!(xhci->intr[v].iman & IMAN_IE)) {
+    if (!(intr->iman & IMAN_IE)) {
         return;
     }
 
     if (!(xhci->usbcmd & USBCMD_INTE)) {
         return;
     }
-    if (xhci->intr_raise) {
-        if (xhci->intr_raise(xhci, v, true)) {
-            xhci->intr[v].iman &= ~IMAN_IP;
+
+    /*
+     * Honour the moderation interval: events that arrive before it has
+     * elapsed since the last interrupt are coalesced into one interrupt
+     * delivered when the interval expires.  EHB stays set meanwhile, so
+     * further events only queue TRBs.
+     */
+    if ((intr->imod & IMOD_IMODI_MASK) &&
+        qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) < intr->imod_deadline) {
+        if (!timer_pending(intr->imod_timer)) {
+            timer_mod(intr->imod_timer, intr->imod_deadline);
         }
+        return;
     }
+    xhci_intr_deliver(xhci, v);
 }
 
 static inline int xhci_running(XHCIState *xhci)
@@ -2722,6 +2766,8 @@ static void xhci_reset(DeviceState *dev)
     for (i = 0; i < xhci->numintrs; i++) {
         xhci->intr[i].iman = 0;
         xhci->intr[i].imod = 0;
+        xhci->intr[i].imod_deadline = 0;
+        timer_del(xhci->intr[i].imod_timer);
         xhci->intr[i].erstsz = 0;
         xhci->intr[i].erstba_low = 0;
         xhci->intr[i].erstba_high = 0;
@@ -3088,6 +3134,10 @@ static void xhci_runtime_write(void *ptr, hwaddr reg,
         break;
     case 0x04: /* IMOD */
         intr->imod = val;
+        if (!(val & IMOD_IMODI_MASK) && timer_pending(intr->imod_timer)) {
+            timer_del(intr->imod_timer);
+            xhci_intr_deliver(xhci, v);
+        }
         break;
     case 0x08: /* ERSTSZ */
         intr->erstsz = val & 0xffff;
@@ -3413,6 +3463,12 @@ static void usb_xhci_realize(DeviceState *dev, Error **errp)
 
     usb_xhci_init(xhci);
     xhci->mfwrap_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, xhci_mfwrap_timer, xhci);
+    for (i = 0; i < xhci->numintrs; i++) {
+        xhci->intr[i].xhci = xhci;
+        xhci->intr[i].imod_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL,
+                                                xhci_imod_timer,
+                                                &xhci->intr[i]);
+    }
 
     memory_region_init(&xhci->mem, OBJECT(dev), "xhci", XHCI_LEN_REGS);
     memory_region_init_io(&xhci->mem_cap, OBJECT(dev), &xhci_cap_ops, xhci,
@@ -3455,6 +3511,11 @@ static void usb_xhci_unrealize(DeviceState *dev)
         xhci->mfwrap_timer = NULL;
     }
 
+    for (i = 0; i < xhci->numintrs; i++) {
+        timer_free(xhci->intr[i].imod_timer);
+        xhci->intr[i].imod_timer = NULL;
+    }
+
     memory_region_del_subregion(&xhci->mem, &xhci->mem_cap);
     memory_region_del_subregion(&xhci->mem, &xhci->mem_oper);
     memory_region_del_subregion(&xhci->mem, &xhci->mem_runtime);
@@ -3476,7 +3537,7 @@ static int usb_xhci_post_load(void *opaque, int version_id)
     dma_addr_t dcbaap, pctx;
     uint32_t slot_ctx[4];
     uint32_t ep_ctx[5];
-    int slotid, epid, state;
+    int slotid, epid, state, i;
     uint64_t addr;
 
     dcbaap = xhci_addr64(xhci->dcbaap_low, xhci->dcbaap_high);
@@ -3516,6 +3577,15 @@ static int usb_xhci_post_load(void *opaque, int version_id)
             }
         }
     }
+
+    for (i = 0; i < xhci->numintrs; i++) {
+        /* moderation timers are not migrated, flush any deferred interrupt */
+        if ((xhci->intr[i].imod & IMOD_IMODI_MASK) &&
+            (xhci->intr[i].iman & IMAN_IP)) {
+            timer_mod(xhci->intr[i].imod_timer,
+                      qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL));
+        }
+    }
     return 0;
 }
 
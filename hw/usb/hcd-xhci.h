@@ -172,6 +172,10 @@ typedef struct XHCIInterrupter {
     unsigned int ev_buffer_put;
     unsigned int ev_buffer_get;
 
+    /* interrupt moderation (IMOD) */
+    XHCIState *xhci;
+    QEMUTimer *imod_timer;
+    int64_t imod_deadline;
 } XHCIInterrupter;
 
 typedef struct XHCIState {
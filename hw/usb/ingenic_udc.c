@@ -24,8 +24,11 @@
 
 #include "qemu/osdep.h"
 #include "hw/sysbus.h"
+#include "hw/irq.h"
 #include "migration/vmstate.h"
+#include "exec/address-spaces.h"
 #include "qemu/log.h"
+#include "qemu/main-loop.h"
 #include "qemu/module.h"
 #include "hw/usb/ingenic_udc.h"
 #include "trace.h"
@@ -37,6 +40,13 @@
 #define DMA_ADDR    0x0008
 #define DMA_COUNT   0x000c
 
+// DMA_CNTL bits
+#define DMA_CNTL_EN     BIT(0)
+#define DMA_CNTL_DIR    BIT(1)  // 1: memory to FIFO
+#define DMA_CNTL_MODE   BIT(2)  // 1: multi-packet
+#define DMA_CNTL_IE     BIT(3)
+#define DMA_CNTL_BUSERR BIT(8)
+
 void qmp_stop(Error **errp);
 
 static void ingenic_udc_reset(Object *obj, ResetType type)
@@ -51,11 +61,88 @@ static void ingenic_udc_reset(Object *obj, ResetType type)
     }
 }
 
+static void ingenic_udc_reset_hold(Object *obj)
+{
+    IngenicUdc *s = INGENIC_UDC(obj);
+    qemu_set_irq(s->irq, 0);
+}
+
+static void ingenic_udc_dma_done(IngenicUdc *s, uint32_t ch)
+{
+    s->dma[ch].cntl &= ~DMA_CNTL_EN;
+    if (s->dma[ch].cntl & DMA_CNTL_IE) {
+        s->dma_intr |= BIT(ch);
+        qemu_set_irq(s->irq, 1);
+    }
+    trace_ingenic_udc_dma_done(ch, s->dma[ch].addr, s->dma[ch].cntl);
+}
+
+static void ingenic_udc_dma_ch_run(IngenicUdc *s, uint32_t ch)
+{
+    struct IngenicUdcDma *dma = &s->dma[ch];
+    bool tx = dma->cntl & DMA_CNTL_DIR;
+    int ep = (dma->cntl >> 4) & 0x0f;
+    bool eop = false;
+
+    // Move whole packets straight between guest RAM and the endpoint FIFO
+    while ((dma->cntl & DMA_CNTL_EN) && dma->count && !eop) {
+        hwaddr len = dma->count;
+        uint8_t *ptr = address_space_map(&address_space_memory, dma->addr, &len, !tx,
+                                         MEMTXATTRS_UNSPECIFIED);
+        if (!ptr) {
+            qemu_log_mask(LOG_GUEST_ERROR, "%s: CH%u Bus error at 0x%08x\n",
+                          __func__, ch, dma->addr);
+            dma->cntl |= DMA_CNTL_BUSERR;
+            break;
+        }
+        int n = tx ? musb_dma_tx(s->musb, ep, ptr, len) :
+                     musb_dma_rx(s->musb, ep, ptr, len, &eop);
+        address_space_unmap(&address_space_memory, ptr, len, !tx, n);
+        if (n == 0 && !eop) {
+            // FIFO busy or empty, resume on the next endpoint interrupt
+            return;
+        }
+        trace_ingenic_udc_dma_xfer(ch, ep, dma->addr, n);
+        dma->addr += n;
+        dma->count -= n;
+        // Single packet mode stops after one packet
+        if (!(dma->cntl & DMA_CNTL_MODE))
+            break;
+    }
+    ingenic_udc_dma_done(s, ch);
+}
+
+static void ingenic_udc_dma_bh(void *opaque)
+{
+    IngenicUdc *s = INGENIC_UDC(opaque);
+    for (int ch = 0; ch < INGENIC_UDC_MAX_DMA_CHANNELS; ch++)
+        if (s->dma[ch].cntl & DMA_CNTL_EN)
+            ingenic_udc_dma_ch_run(s, ch);
+}
+
 static void ingenic_udc_irq(void *opaque, int source, int level)
 {
     IngenicUdc *s = INGENIC_UDC(opaque);
-    (void)s;
     trace_ingenic_udc_irq(source, level);
+    // Endpoint FIFO state changed, let waiting DMA channels continue
+    if (level && (source == musb_irq_tx || source == musb_irq_rx))
+        qemu_bh_schedule(s->dma_bh);
+}
+
+static uint32_t ingenic_udc_dma_ch_read(IngenicUdc *s, uint32_t ch, uint32_t reg)
+{
+    switch (reg) {
+    case DMA_CNTL:
+        return s->dma[ch].cntl;
+    case DMA_ADDR:
+        return s->dma[ch].addr;
+    case DMA_COUNT:
+        return s->dma[ch].count;
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: CH%u Unknown reg 0x%x\n", __func__, ch, reg);
+        qmp_stop(NULL);
+        return 0;
+    }
 }
 
 static void ingenic_udc_dma_ch_write(IngenicUdc *s, uint32_t ch, uint32_t reg, uint32_t value)
@@ -63,10 +150,8 @@ static void ingenic_udc_dma_ch_write(IngenicUdc *s, uint32_t ch, uint32_t reg, u
     switch (reg) {
     case DMA_CNTL:
         s->dma[ch].cntl = value & 0x07ff;
-        if (s->dma[ch].cntl & 1) {
-            qemu_log_mask(LOG_UNIMP, "%s: TODO CH%u START\n", __func__, ch);
-            qmp_stop(NULL);
-        }
+        if (s->dma[ch].cntl & DMA_CNTL_EN)
+            qemu_bh_schedule(s->dma_bh);
         break;
     case DMA_ADDR:
         s->dma[ch].addr = value;
@@ -101,6 +186,16 @@ static uint64_t ingenic_udc_read(void *opaque, hwaddr addr, unsigned size)
             g_assert_not_reached();
         }
         break;
+    case DMA_INTR:
+        // Cleared on read
+        value = s->dma_intr;
+        s->dma_intr = 0;
+        qemu_set_irq(s->irq, 0);
+        break;
+    case (DMA_CH_BASE + 4) ... (DMA_CH_BASE + INGENIC_UDC_MAX_DMA_CHANNELS * (DMA_CH_SIZE) - 1):
+        value = ingenic_udc_dma_ch_read(s, (addr - DMA_CH_BASE) / DMA_CH_SIZE,
+                                        (addr - DMA_CH_BASE) % DMA_CH_SIZE);
+        break;
     default:
         qemu_log_mask(LOG_UNIMP, "%s: Unknown address " HWADDR_FMT_plx "\n", __func__, addr);
         qmp_stop(NULL);
@@ -130,8 +225,8 @@ static void ingenic_udc_write(void *opaque, hwaddr addr, uint64_t value, unsigne
         }
         break;
     case (DMA_CH_BASE + 4) ... (DMA_CH_BASE + INGENIC_UDC_MAX_DMA_CHANNELS * (DMA_CH_SIZE) - 1):
-        ingenic_udc_dma_ch_write(s, (addr - DMA_CH_BASE) / INGENIC_UDC_MAX_DMA_CHANNELS,
-                                 (addr - DMA_CH_BASE) % INGENIC_UDC_MAX_DMA_CHANNELS, value);
+        ingenic_udc_dma_ch_write(s, (addr - DMA_CH_BASE) / DMA_CH_SIZE,
+                                 (addr - DMA_CH_BASE) % DMA_CH_SIZE, value);
         break;
     default:
         qemu_log_mask(LOG_UNIMP, "%s: Unknown address " HWADDR_FMT_plx " 0x%"PRIx64"\n",
@@ -155,20 +250,63 @@ static void ingenic_udc_init(Object *obj)
     memory_region_init_io(&s->mr, OBJECT(s), &udc_ops, s, "udc", 0x00010000);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mr);
     qdev_init_gpio_in(dev, ingenic_udc_irq, musb_irq_max);
+    qdev_init_gpio_out_named(dev, &s->irq, "irq-out", 1);
     s->musb = musb_init(dev, 0);
+    s->dma_bh = qemu_bh_new(ingenic_udc_dma_bh, s);
 }
 
 static void ingenic_udc_finalize(Object *obj)
 {
+    IngenicUdc *s = INGENIC_UDC(obj);
+    qemu_bh_delete(s->dma_bh);
+}
+
+static const VMStateDescription vmstate_ingenic_udc_dma = {
+    .name = "ingenic-udc/dma",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(cntl, struct IngenicUdcDma),
+        VMSTATE_UINT32(addr, struct IngenicUdcDma),
+        VMSTATE_UINT32(count, struct IngenicUdcDma),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static int ingenic_udc_post_load(void *opaque, int version_id)
+{
+    IngenicUdc *s = opaque;
+    // Channels that were waiting on an endpoint pick up where they stopped
+    for (int ch = 0; ch < INGENIC_UDC_MAX_DMA_CHANNELS; ch++)
+        if (s->dma[ch].cntl & DMA_CNTL_EN)
+            qemu_bh_schedule(s->dma_bh);
+    return 0;
 }
 
+static const VMStateDescription vmstate_ingenic_udc = {
+    .name = "ingenic-udc",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ingenic_udc_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(dma_intr, IngenicUdc),
+        VMSTATE_STRUCT_ARRAY(dma, IngenicUdc, INGENIC_UDC_MAX_DMA_CHANNELS, 1,
+                             vmstate_ingenic_udc_dma, struct IngenicUdcDma),
+        VMSTATE_STRUCT_POINTER(musb, IngenicUdc, vmstate_musb, MUSBState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
 static void ingenic_udc_class_init(ObjectClass *class, void *data)
 {
+    DeviceClass *dc = DEVICE_CLASS(class);
+    dc->vmsd = &vmstate_ingenic_udc;
+
     IngenicUdcClass *bch_class = INGENIC_UDC_CLASS(class);
     ResettableClass *rc = RESETTABLE_CLASS(class);
     resettable_class_set_parent_phases(rc,
                                        ingenic_udc_reset,
-                                       NULL,
+                                       ingenic_udc_reset_hold,
                                        NULL,
                                        &bch_class->parent_phases);
 }
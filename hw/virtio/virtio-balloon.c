@@ -323,12 +323,25 @@ static void balloon_stats_set_poll_interval(Object *obj, Visitor *v,
     balloon_stats_change_timer(s, 0);
 }
 
+static void virtio_balloon_report_discard(VirtIOBalloon *dev, RAMBlock *rb,
+                                          ram_addr_t offset, size_t size)
+{
+    trace_virtio_balloon_report_discard(qemu_ram_get_idstr(rb), offset, size);
+    if (!ram_block_discard_range(rb, offset, size)) {
+        dev->free_page_reported += size;
+    }
+}
+
 static void virtio_balloon_handle_report(VirtIODevice *vdev, VirtQueue *vq)
 {
     VirtIOBalloon *dev = VIRTIO_BALLOON(vdev);
     VirtQueueElement *elem;
+    bool notify = false;
 
     while ((elem = virtqueue_pop(vq, sizeof(VirtQueueElement)))) {
+        RAMBlock *run_rb = NULL;
+        ram_addr_t run_offset = 0;
+        size_t run_size = 0;
         unsigned int i;
 
         /*
@@ -374,14 +387,38 @@ static void virtio_balloon_handle_report(VirtIODevice *vdev, VirtQueue *vq)
                 continue;
             }
 
-            ram_block_discard_range(rb, ram_offset, size);
+            /*
+             * The guest reports free pages in buddy order, so neighbouring
+             * descriptors are frequently contiguous in the RAMBlock; merge
+             * them into a single madvise/fallocate call.
+             */
+            if (rb == run_rb && ram_offset == run_offset + run_size) {
+                run_size += size;
+                continue;
+            }
+            if (run_rb) {
+                virtio_balloon_report_discard(dev, run_rb, run_offset,
+                                              run_size);
+            }
+            run_rb = rb;
+            run_offset = ram_offset;
+            run_size = size;
+        }
+
+        /* the pages must be gone before the element is handed back */
+        if (run_rb) {
+            virtio_balloon_report_discard(dev, run_rb, run_offset, run_size);
         }
 
 skip_element:
         virtqueue_push(vq, elem, 0);
-        virtio_notify(vdev, vq);
+        notify = true;
         g_free(elem);
     }
+
+    if (notify) {
+        virtio_notify(vdev, vq);
+    }
 }
 
 static void virtio_balloon_handle_output(VirtIODevice *vdev, VirtQueue *vq)
@@ -783,6 +820,11 @@ static void virtio_balloon_stat(void *opaque, BalloonInfo *info)
     VirtIOBalloon *dev = opaque;
     info->actual = get_current_ram_size() - ((uint64_t) dev->actual <<
                                              VIRTIO_BALLOON_PFN_SHIFT);
+    if (virtio_has_feature(dev->host_features,
+                           VIRTIO_BALLOON_F_REPORTING)) {
+        info->has_free_page_reported = true;
+        info->free_page_reported = dev->free_page_reported;
+    }
 }
 
 static void virtio_balloon_to_target(void *opaque, ram_addr_t target)
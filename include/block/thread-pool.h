@@ -40,4 +40,14 @@ void thread_pool_submit(ThreadPoolFunc *func, void *arg);
 
 void thread_pool_update_params(ThreadPool *pool, struct AioContext *ctx);
 
+typedef struct ThreadPoolStats {
+    uint64_t requests;      /* requests submitted */
+    uint64_t wait_ns;       /* total time requests spent queued */
+    uint64_t queue_depth;   /* requests waiting for a worker right now */
+    uint64_t workers;       /* worker threads */
+} ThreadPoolStats;
+
+/* Sum of the statistics of all thread pools in the process */
+void thread_pool_get_stats(ThreadPoolStats *stats);
+
 #endif
@@ -818,6 +818,7 @@ struct MemoryRegion {
     uint8_t vga_logging_count;
     MemoryRegion *alias;
     hwaddr alias_offset;
+    uint64_t alias_repeat;
     int32_t priority;
     QTAILQ_HEAD(, MemoryRegion) subregions;
     QTAILQ_ENTRY(MemoryRegion) subregions_link;
@@ -829,6 +830,9 @@ struct MemoryRegion {
 
     /* For devices designed to perform re-entrant IO into their own IO MRs */
     bool disable_reentrancy_guard;
+
+    /* Accessors run without the BQL, see memory_region_enable_lockless_io() */
+    bool lockless_io;
 };
 
 struct IOMMUMemoryRegion {
@@ -1487,6 +1491,31 @@ void memory_region_init_alias(MemoryRegion *mr,
                               hwaddr offset,
                               uint64_t size);
 
+/**
+ * memory_region_init_alias_repeat: Initialize a memory region that mirrors
+ *                                  a part of another memory region repeatedly.
+ *
+ * The region covers @size bytes, and every @period bytes of it map to
+ * @orig between @offset and @offset + @period - 1 again. A single region
+ * fills a window with any number of mirrors, so resizing or moving it
+ * costs the same regardless of how many copies it contains.
+ *
+ * @mr: the #MemoryRegion to be initialized.
+ * @owner: the object that tracks the region's reference count
+ * @name: used for debugging; not visible to the user or ABI
+ * @orig: the region to be referenced.
+ * @offset: start of the section in @orig to be referenced.
+ * @period: size of each mirrored copy, must not be zero.
+ * @size: size of the region.
+ */
+void memory_region_init_alias_repeat(MemoryRegion *mr,
+                                     Object *owner,
+                                     const char *name,
+                                     MemoryRegion *orig,
+                                     hwaddr offset,
+                                     uint64_t period,
+                                     uint64_t size);
+
 /**
  * memory_region_init_rom_nomigrate: Initialize a ROM memory region.
  *
@@ -2243,6 +2272,23 @@ void memory_region_clear_coalescing(MemoryRegion *mr);
  */
 void memory_region_set_flush_coalesced(MemoryRegion *mr);
 
+/**
+ * memory_region_enable_lockless_io: Dispatch accesses without taking the BQL.
+ *
+ * By default the BQL is taken around every MMIO access to a region.  A
+ * device that opts in has its read and write callbacks invoked from vCPU
+ * threads without the BQL, and possibly from several vCPUs at once.  The
+ * callbacks must then protect the device state with their own lock or
+ * atomics, and must not call anything that requires the BQL, such as
+ * qemu_set_irq() into a BQL-protected interrupt controller or memory
+ * region updates.
+ *
+ * The region must not use MMIO coalescing.
+ *
+ * @mr: the memory region to be updated.
+ */
+void memory_region_enable_lockless_io(MemoryRegion *mr);
+
 /**
  * memory_region_clear_flush_coalesced: Disable memory coalescing flush before
  *                                      accesses.
@@ -2579,6 +2625,33 @@ void memory_global_dirty_log_stop(unsigned int flags);
 
 void mtree_info(bool flatview, bool dispatch_tree, bool owner, bool disabled);
 
+/**
+ * mmio_profile_enable: start or stop counting MMIO dispatches
+ *
+ * While enabled, every access dispatched to a #MemoryRegion's callbacks is
+ * counted per region and offset, together with the host time it took.
+ *
+ * @enable: whether to count accesses
+ */
+void mmio_profile_enable(bool enable);
+
+/**
+ * mmio_profile_is_enabled: report whether MMIO dispatches are counted
+ */
+bool mmio_profile_is_enabled(void);
+
+/**
+ * mmio_profile_reset: clear all MMIO profile counters
+ */
+void mmio_profile_reset(void);
+
+/**
+ * mmio_profile_format: format the MMIO profile, busiest regions first
+ *
+ * Returns: a newly allocated string, to be freed by the caller
+ */
+GString *mmio_profile_format(void);
+
 bool memory_region_access_valid(MemoryRegion *mr, hwaddr addr,
                                 unsigned size, bool is_write,
                                 MemTxAttrs attrs);
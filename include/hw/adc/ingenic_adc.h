@@ -29,6 +29,8 @@
 #include "hw/sysbus.h"
 #include "qom/object.h"
 
+#define INGENIC_ADC_TS_FIFO_DEPTH   8
+
 #define TYPE_INGENIC_ADC "ingenic-adc"
 OBJECT_DECLARE_TYPE(IngenicAdc, IngenicAdcClass, INGENIC_ADC)
 
@@ -52,13 +54,20 @@ typedef struct IngenicAdc
     QEMUTimer sampler_timer;
     QEMUTimer ts_timer;
 
-    enum ingenic_adc_sampler sampler;
+    uint32_t sampler;   // enum ingenic_adc_sampler
     uint8_t adtch_state;
     uint16_t x, y, z[4];
     uint32_t adtch_fifo;
     uint8_t prev_state;
     bool pressed;
 
+    // Raw pointer samples not yet read through ADTCH
+    struct IngenicAdcTsSample {
+        int32_t x, y;
+    } ts_fifo[INGENIC_ADC_TS_FIFO_DEPTH], ts_last;
+    uint8_t ts_rd;
+    uint8_t ts_count;
+
     // Registers
     uint8_t adena;
     uint32_t adcfg;
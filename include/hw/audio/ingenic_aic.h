@@ -27,6 +27,10 @@
 
 #include "hw/sysbus.h"
 #include "qom/object.h"
+#include "audio/audio.h"
+
+// Sample ring between the DMAC and the audio backend, per direction
+#define INGENIC_AIC_RING_SIZE   (16 * 1024)
 
 #define TYPE_INGENIC_AIC "ingenic-aic"
 OBJECT_DECLARE_TYPE(IngenicAic, IngenicAicClass, INGENIC_AIC)
@@ -38,6 +42,23 @@ typedef struct IngenicAic
 
     /* <public> */
     MemoryRegion mr;
+    qemu_irq irq;
+    qemu_irq dma_tx;
+    qemu_irq dma_rx;
+
+    // Audio backend
+    QEMUSoundCard card;
+    SWVoiceOut *voice_out;
+    SWVoiceIn *voice_in;
+    struct audsettings as_out;
+    struct audsettings as_in;
+
+    // Sample rings, hold samples in the backend format
+    struct IngenicAicRing {
+        uint8_t buf[INGENIC_AIC_RING_SIZE];
+        uint32_t rd;
+        uint32_t level;
+    } tx, rx;
 
     // Registers
     struct {
@@ -57,4 +78,8 @@ typedef struct IngenicAicClass
     ResettablePhases parent_phases;
 } IngenicAicClass;
 
+uint32_t ingenic_aic_available(IngenicAic *s, bool tx);
+uint32_t ingenic_aic_tx_write(IngenicAic *s, const uint8_t *buf, uint32_t len, uint32_t width);
+uint32_t ingenic_aic_rx_read(IngenicAic *s, uint8_t *buf, uint32_t len, uint32_t width);
+
 #endif /* INGENIC_AIC_H */
@@ -34,6 +34,7 @@ typedef struct IngenicBch {
     MemoryRegion mr;
 
     // States
+    uint8_t buf[1024];
     uint32_t nbytes;
     uint8_t mask_and;
     uint8_t mask_or;
@@ -53,4 +54,7 @@ typedef struct IngenicBchClass
     ResettablePhases parent_phases;
 } IngenicBchClass;
 
+// Feed data bytes as if written to BHDR one by one
+void ingenic_bch_feed(IngenicBch *s, const uint8_t *buf, uint32_t len);
+
 #endif /* INGENIC_BCH_H */
@@ -46,6 +46,9 @@ typedef struct IngenicEmcNand {
     uint32_t page_size;
     uint32_t oob_size;
     uint32_t cs;
+    uint32_t prefetch_pages;
+    // Media stores complemented bytes, erased blocks read back as zeros
+    bool invert;
     bool writable;
 
     // States
@@ -56,7 +59,24 @@ typedef struct IngenicEmcNand {
 
     // Read/write buffers
     uint8_t *buf;
+    uint32_t buf_size;
+    uint8_t *erase_buf;
     uint32_t page_ofs;
+
+    // Asynchronous page I/O
+    BlockAIOCB *aiocb;
+    QEMUIOVector qiov;
+
+    // Sequential read prefetch cache
+    BlockAIOCB *prefetch_aiocb;
+    uint32_t cache_pages;
+    uint32_t cache_gen;
+    uint8_t *cache_data;
+    uint32_t *cache_row;
+    uint64_t *cache_lru;
+    uint64_t cache_clock;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
 } IngenicEmcNand;
 
 typedef struct IngenicEmcNandClass
@@ -64,9 +84,14 @@ typedef struct IngenicEmcNandClass
     DeviceClass parent_class;
 } IngenicEmcNandClass;
 
+// Bulk read from the data port, as done by DMA
+uint32_t ingenic_emc_nand_data_read(IngenicEmcNand *nand, uint8_t *buf, uint32_t len);
+
 // EMC NAND ECC module
 
 typedef struct IngenicEmcNandEcc {
+    // Data block, padded to a whole number of RS symbols
+    uint8_t buf[512 + 2];
     uint32_t data_count;
     struct {
         uint8_t  nfeccr;
@@ -81,7 +106,7 @@ typedef struct IngenicEmcNandEcc {
 void ingenic_emc_nand_ecc_reset(IngenicEmc *emc, ResetType type);
 uint64_t ingenic_emc_nand_ecc_read(IngenicEmc *emc, hwaddr addr, unsigned size);
 void ingenic_emc_nand_ecc_write(IngenicEmc *emc, hwaddr addr, uint64_t value, unsigned size);
-void ingenic_emc_nand_ecc_data(IngenicEmc *emc, uint64_t value, unsigned size);
+void ingenic_emc_nand_ecc_feed(IngenicEmc *emc, const uint8_t *buf, uint32_t len);
 
 // EMC SDRAM instances
 
@@ -92,8 +117,8 @@ typedef struct IngenicEmcSdram {
     // Class inheritance
     DeviceState parent_obj;
     MemoryRegion mr;
-    int num_aliases;
-    MemoryRegion *alias_mr;
+    // Repeating mirror of the bank filling the rest of the DMAR window
+    MemoryRegion mirror_mr;
     // Properties
     uint32_t cs;
     uint32_t size;
@@ -118,6 +143,7 @@ typedef struct IngenicEmcSdramCfg {
 void ingenic_emc_sdram_reset(IngenicEmc *emc, ResetType type);
 uint64_t ingenic_emc_sdram_read(IngenicEmc *emc, hwaddr addr, unsigned size);
 void ingenic_emc_sdram_write(IngenicEmc *emc, hwaddr addr, uint64_t value, unsigned size);
+void ingenic_emc_sdram_post_load(IngenicEmc *emc);
 
 // EMC main controller
 
@@ -29,14 +29,29 @@
 #include "chardev/char-fe.h"
 #include "qom/object.h"
 #include "hw/char/serial.h"
+#include "qemu/timer.h"
 
 #define TYPE_INGENIC_UART "ingenic-uart"
+
+// Transmit FIFO depth of the JZ UARTs
+#define INGENIC_UART_FIFO_SIZE  16
 OBJECT_DECLARE_TYPE(IngenicUartState, IngenicUartClass, INGENIC_UART)
 
 struct IngenicUartState {
     SerialMM parent_obj;
     MemoryRegion mmio;
+    MemoryRegion thr_mr;
+    MemoryRegion lsr_mr;
     qemu_irq irq;
+    QEMUTimer tx_timer;
+
+    // Properties
+    bool tx_batch;
+
+    // Batched transmit FIFO
+    uint8_t tx_fifo[INGENIC_UART_FIFO_SIZE];
+    uint32_t tx_len;
+    guint tx_watch_tag;
 
     // Registers
     uint8_t isr;
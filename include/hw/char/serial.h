@@ -94,6 +94,7 @@ extern const VMStateDescription vmstate_serial;
 extern const MemoryRegionOps serial_io_ops;
 
 void serial_set_frequency(SerialState *s, uint32_t frequency);
+void serial_set_thr_ipending(SerialState *s, bool pending);
 
 #define TYPE_SERIAL "serial"
 OBJECT_DECLARE_SIMPLE_TYPE(SerialState, SERIAL)
@@ -307,6 +307,9 @@ typedef struct CPUTLBCommon {
     size_t full_flush_count;
     size_t part_flush_count;
     size_t elide_flush_count;
+    /* Main TLB misses, split by whether the victim TLB resolved them. */
+    size_t vtlb_hit_count;
+    size_t vtlb_miss_count;
 } CPUTLBCommon;
 
 /*
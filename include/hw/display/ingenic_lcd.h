@@ -30,6 +30,16 @@
 #include "qemu/timer.h"
 #include "hw/sysbus.h"
 
+#define INGENIC_LCD_DESC_CACHE  4
+
+typedef struct IngenicLcdDescCache {
+    MemoryRegionSection section;
+    uint32_t da;
+    uint32_t nwords;
+    bool valid;
+    uint32_t desc[8];
+} IngenicLcdDescCache;
+
 #define TYPE_INGENIC_LCD "ingenic-lcd"
 OBJECT_DECLARE_TYPE(IngenicLcd, IngenicLcdClass, INGENIC_LCD)
 
@@ -46,6 +56,8 @@ typedef struct IngenicLcd
     // Properties
     char *model_str;
     enum {IngenicLcdModelNormal, IngenicLcdModelDeltaRGB} model;
+    char *refresh_policy_str;
+    enum {IngenicLcdRefreshFixed, IngenicLcdRefreshAdaptive} refresh_policy;
 
     // Variables
     uint32_t xres;
@@ -55,6 +67,20 @@ typedef struct IngenicLcd
     bool invalidate;
     bool field;
 
+    // Row conversion, selected per mode and surface format
+    void (*row_fn[2])(uint32_t *dst, const uint8_t *src, int width);
+    uint32_t row_mode;
+    int row_bpp;
+    // Console surface shares the guest framebuffer
+    bool shared;
+    uint32_t shared_sa;
+    // Framebuffer section is rebuilt only when its location changes
+    uint32_t fb_sa;
+    uint32_t fb_len;
+    // Parsed descriptors, watched for guest writes through dirty logging
+    IngenicLcdDescCache desc_cache[INGENIC_LCD_DESC_CACHE];
+    uint32_t desc_victim;
+
     // Registers
     uint32_t lcdcfg;
     uint32_t lcdvsync;
@@ -70,12 +96,12 @@ typedef struct IngenicLcd
     uint32_t lcdbgc;
     uint8_t  lcdalpha;
     uint32_t lcdipur;
-    struct {
+    struct IngenicLcdFg {
         uint32_t lcdkey;
         uint32_t lcdxyp;
         uint32_t lcdsize;
     } fg[2];
-    struct {
+    struct IngenicLcdDesc {
         uint32_t lcdda;
         uint32_t lcdsa;
         uint32_t lcdfid;
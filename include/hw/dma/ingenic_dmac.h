@@ -26,7 +26,11 @@
 #define INGENIC_DMAC_H
 
 #include "qom/object.h"
+#include "qemu/timer.h"
+#include "qemu/thread.h"
+#include "qemu/queue.h"
 #include "hw/sysbus.h"
+#include "sysemu/iothread.h"
 
 #define INGENIC_DMAC_NUM_DMAC   2
 #define INGENIC_DMAC_NUM_CH     6
@@ -36,31 +40,56 @@ OBJECT_DECLARE_TYPE(IngenicDmac, IngenicDmacClass, INGENIC_DMAC)
 
 enum ingenic_dmac_ch_state {
     IngenicDmacChIdle, IngenicDmacChDesc, IngenicDmacChTxfr,
+    // Copy running on the iothread
+    IngenicDmacChBusy,
+    // Data moved, completion held back until the modelled bus time passes
+    IngenicDmacChDrain,
 };
 
+typedef struct IngenicDmacOffload IngenicDmacOffload;
 typedef struct IngenicMsc IngenicMsc;
+typedef struct IngenicBch IngenicBch;
+typedef struct IngenicAic IngenicAic;
 
 typedef struct IngenicDmac
 {
     SysBusDevice parent_obj;
     MemoryRegion mr;
     QEMUBH *trigger_bh;
+    QEMUTimer timer;
+    uint64_t round_ns;  // Bus time used by the current arbitration round
+    bool in_pass;       // Inside the trigger BH, links are followed inline
     qemu_irq irq[INGENIC_DMAC_NUM_DMAC];
 
-    struct {
-        struct {
-            enum ingenic_dmac_ch_state state;
+    // Copies running on the iothread, completed on the main loop
+    QemuMutex offload_lock;
+    QemuCond offload_cond;
+    QTAILQ_HEAD(, IngenicDmacOffload) offload_jobs;
+    QEMUBH *offload_bh;
+    VMChangeStateEntry *vmstate_change;
+
+    struct IngenicDmacState {
+        struct IngenicDmacChState {
+            uint32_t state;     // enum ingenic_dmac_ch_state
+            uint32_t gen;       // Bumped on reset to drop stale completions
         } ch[INGENIC_DMAC_NUM_CH];
     } dma[INGENIC_DMAC_NUM_DMAC];
 
     IngenicMsc *msc;
+    IngenicBch *bch;
+    IngenicAic *aic;
 
     // Properties
     uint32_t model;
+    IOThread *iothread;
+    char *timing_str;
+    enum {IngenicDmacTimingInstant, IngenicDmacTimingTimed} timing;
+    uint32_t bandwidth;     // MB/s
+    uint32_t burst_ns;      // Per-burst overhead
 
     // Registers
-    struct {
-        struct {
+    struct IngenicDmacRegs {
+        struct IngenicDmacChRegs {
             uint32_t dsa;   // Source address
             uint32_t dta;   // Target address
             uint32_t dtc;   // Transfer count
@@ -62,4 +62,7 @@ typedef struct IngenicGpioClass
     ResettablePhases parent_phases;
 } IngenicGpioClass;
 
+// Set the input levels of all pins in mask with a single IRQ evaluation
+void ingenic_gpio_set_pins(IngenicGpio *gpio, uint32_t mask, uint32_t value);
+
 #endif /* INGENIC_GPIO_H */
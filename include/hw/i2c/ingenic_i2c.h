@@ -47,7 +47,7 @@ typedef struct IngenicI2c
 
     I2CBus *bus;
 
-    IngenicI2cState state;
+    uint32_t state;     // IngenicI2cState
     int delay;
 
     // Registers
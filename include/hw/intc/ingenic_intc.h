@@ -28,6 +28,7 @@
 #include "hw/sysbus.h"
 #include "hw/irq.h"
 #include "qom/object.h"
+#include "hw/misc/ingenic_turbo.h"
 
 #define TYPE_INGENIC_INTC "ingenic-intc"
 OBJECT_DECLARE_TYPE(IngenicIntc, IngenicIntcClass, INGENIC_INTC)
@@ -36,12 +37,18 @@ typedef struct IngenicIntc
 {
     SysBusDevice parent_obj;
     MemoryRegion mr;
+    MemoryRegion icpr_mr;
     qemu_irq irq;
+    bool irq_level;
+    // Nested source update batches, CPU line evaluated when the last ends
+    uint32_t batch;
+    // Busy-wait detection on ICPR reads
+    IngenicTurbo turbo;
 
     // Registers
     uint32_t icsr;  // Source
     uint32_t icmr;  // Mask
-    uint32_t icpr;  // Pending
+    uint32_t icpr;  // Pending, also read without the BQL
 } IngenicIntc;
 
 typedef struct IngenicIntcClass
@@ -50,4 +57,8 @@ typedef struct IngenicIntcClass
     ResettablePhases parent_phases;
 } IngenicIntcClass;
 
+IngenicIntc *ingenic_intc_get_intc(void);
+void ingenic_intc_batch_begin(IngenicIntc *s);
+void ingenic_intc_batch_end(IngenicIntc *s);
+
 #endif /* INGENIC_INTC_H */
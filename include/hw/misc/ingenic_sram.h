@@ -0,0 +1,45 @@
+/*
+ * Ingenic XBurst cache-as-RAM emulation
+ *
+ * Copyright (c) 2024 Norman Zhi
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INGENIC_SRAM_H
+#define INGENIC_SRAM_H
+
+#include "hw/sysbus.h"
+#include "qom/object.h"
+
+#define TYPE_INGENIC_SRAM "ingenic-sram"
+OBJECT_DECLARE_TYPE(IngenicSram, IngenicSramClass, INGENIC_SRAM)
+
+// MMIO region 0: cached view, mapped over physical address 0
+// MMIO region 1: uncached view, reached through the kseg1 window
+typedef struct IngenicSram {
+    SysBusDevice parent_obj;
+    MemoryRegion cached_mr;
+    MemoryRegion uncached_mr;
+
+    // Properties
+    uint32_t size;
+} IngenicSram;
+
+typedef struct IngenicSramClass
+{
+    SysBusDeviceClass parent_class;
+} IngenicSramClass;
+
+#endif /* INGENIC_SRAM_H */
@@ -0,0 +1,60 @@
+/*
+ * Ingenic headless turbo boot, guest busy-wait detection
+ *
+ * Copyright (c) 2024 Norman Zhi
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INGENIC_TURBO_H
+#define INGENIC_TURBO_H
+
+#include "qemu/timer.h"
+#include "sysemu/cpu-timers.h"
+
+// Back-to-back polls, each within GAP_NS of the previous, taken as a busy-wait
+#define INGENIC_TURBO_POLLS     64
+#define INGENIC_TURBO_GAP_NS    10000
+// Largest single virtual clock step, bounds the overshoot of delay loops
+#define INGENIC_TURBO_STEP_NS   1000000
+
+typedef struct IngenicTurbo {
+    bool enabled;
+    uint32_t polls;
+    int64_t last_ns;
+} IngenicTurbo;
+
+// Account a read of a register the guest may spin on
+static inline void ingenic_turbo_poll(IngenicTurbo *t)
+{
+    if (!t->enabled)
+        return;
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    if (now - t->last_ns > INGENIC_TURBO_GAP_NS)
+        t->polls = 0;
+    t->last_ns = now;
+    if (++t->polls < INGENIC_TURBO_POLLS)
+        return;
+    // Skip ahead, stopping at the next timer deadline
+    t->polls = 0;
+    t->last_ns += cpu_clock_warp(INGENIC_TURBO_STEP_NS);
+}
+
+// Any other access to the device ends the busy-wait
+static inline void ingenic_turbo_break(IngenicTurbo *t)
+{
+    t->polls = 0;
+}
+
+#endif /* INGENIC_TURBO_H */
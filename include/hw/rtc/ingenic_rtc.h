@@ -27,6 +27,8 @@
 
 #include "hw/sysbus.h"
 #include "qom/object.h"
+#include "qemu/timer.h"
+#include "hw/misc/ingenic_turbo.h"
 
 #define TYPE_INGENIC_RTC "ingenic-rtc"
 OBJECT_DECLARE_TYPE(IngenicRtc, IngenicRtcClass, INGENIC_RTC)
@@ -38,9 +40,21 @@ typedef struct IngenicRtc
 
     /* <public> */
     MemoryRegion mr;
+    qemu_irq irq;
+    // Alarm and 1 Hz interrupt, on rtc_clock
+    QEMUTimer *hz_timer;
+    QEMUTimer *alarm_timer;
+    IngenicTurbo turbo;
+
+    // RTCSR counts seconds of rtc_clock plus this offset
+    int64_t offset_ns;
+    int64_t offset_vmstate;
+    // Second last seen by the 1 Hz flag
+    uint32_t hz_sec;
+    // RTCSAR already raised AF, clearing AF must not raise it again
+    bool alarm_fired;
 
     // Registers
-    uint32_t rtcsr;
     uint32_t rtcsar;
     uint32_t rtcgr;
     uint32_t hspr;
@@ -119,6 +119,26 @@ struct SDCardClass {
      * Return: byte value read
      */
     uint8_t (*read_byte)(SDState *sd);
+    /**
+     * Write a buffer to a SD card.
+     * @sd: card
+     * @buf: data to write
+     * @length: number of bytes
+     *
+     * Optional. Whole blocks of multi-block transfers are handed to the
+     * block layer in one request, the rest goes through write_byte.
+     */
+    void (*write_data)(SDState *sd, const void *buf, size_t length);
+    /**
+     * Read a buffer from a SD card.
+     * @sd: card
+     * @buf: destination buffer
+     * @length: number of bytes
+     *
+     * Optional. Whole blocks of multi-block transfers are read from the
+     * block layer in one request, the rest goes through read_byte.
+     */
+    void (*read_data)(SDState *sd, void *buf, size_t length);
     bool (*receive_ready)(SDState *sd);
     bool (*data_ready)(SDState *sd);
     void (*set_voltage)(SDState *sd, uint16_t millivolts);
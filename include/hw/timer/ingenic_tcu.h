@@ -29,6 +29,8 @@
 #include "hw/irq.h"
 #include "qemu/timer.h"
 #include "qom/object.h"
+#include "hw/intc/ingenic_intc.h"
+#include "hw/misc/ingenic_turbo.h"
 
 #define INGENIC_TCU_MAX_TIMERS  8
 
@@ -47,6 +49,7 @@ typedef struct IngenicTcuTimerCommon
     uint32_t top;
     uint32_t comp;
     uint32_t cnt;
+    uint32_t cnt_max;
     uint32_t irq_top_mask;
     uint32_t irq_comp_mask;
     bool enabled;
@@ -68,6 +71,9 @@ typedef struct IngenicTcu
     qemu_irq irq[3];
     uint32_t irq_state;
     uint32_t model;
+    IngenicIntc *intc;
+    // Busy-wait detection on counter reads
+    IngenicTurbo turbo;
 
     struct {
         uint32_t tstr;
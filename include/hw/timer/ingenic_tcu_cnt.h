@@ -0,0 +1,83 @@
+/*
+ * Ingenic TCU counter arithmetic
+ *
+ * Copyright (c) 2024 Norman Zhi (normanzyb@gmail.com)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef INGENIC_TCU_CNT_H
+#define INGENIC_TCU_CNT_H
+
+// Match flags returned by ingenic_tcu_cnt_advance()
+#define INGENIC_TCU_CNT_HIT_TOP     BIT(0)
+#define INGENIC_TCU_CNT_HIT_COMP    BIT(1)
+
+// Number of ticks needed to move the counter from cnt to target,
+// or UINT64_MAX if the counter never reaches target
+static inline uint64_t ingenic_tcu_cnt_distance(uint32_t cnt, uint32_t top,
+                                                uint32_t max, uint32_t target)
+{
+    uint64_t period = (uint64_t)top + 1;
+    if (cnt <= top) {
+        // Counter is inside the [0, top] cycle
+        if (target > top)
+            return UINT64_MAX;
+        return target >= cnt ? target - cnt : target + period - cnt;
+    }
+    // Counter is above top, counts up to max then wraps to 0
+    if (target >= cnt && target <= max)
+        return target - cnt;
+    if (target > top)
+        return UINT64_MAX;
+    return (uint64_t)max - cnt + 1 + target;
+}
+
+/*
+ * Advance a counter by delta ticks in constant time.
+ * The counter resets to 0 after reaching top, or wraps to 0 after max if it
+ * started above top. Both the starting value and every value reached are
+ * compared against top and comp, the result is a mask of INGENIC_TCU_CNT_HIT_*.
+ */
+static inline uint32_t ingenic_tcu_cnt_advance(uint32_t *cnt, uint32_t top,
+                                               uint32_t comp, uint32_t max,
+                                               uint64_t delta)
+{
+    uint32_t c = *cnt;
+    uint32_t hits = 0;
+    if (ingenic_tcu_cnt_distance(c, top, max, top) <= delta)
+        hits |= INGENIC_TCU_CNT_HIT_TOP;
+    if (ingenic_tcu_cnt_distance(c, top, max, comp) <= delta)
+        hits |= INGENIC_TCU_CNT_HIT_COMP;
+
+    uint64_t period = (uint64_t)top + 1;
+    if (c > top) {
+        uint64_t to_wrap = (uint64_t)max - c + 1;
+        if (delta < to_wrap) {
+            *cnt = c + delta;
+            return hits;
+        }
+        delta -= to_wrap;
+        c = 0;
+    }
+    *cnt = ((uint64_t)c + delta % period) % period;
+    return hits;
+}
+
+#endif /* INGENIC_TCU_CNT_H */
@@ -45,5 +45,9 @@ void musb_reset(MUSBState *s);
 uint32_t musb_core_intr_get(MUSBState *s);
 void musb_core_intr_clear(MUSBState *s, uint32_t mask);
 void musb_set_size(MUSBState *s, int epnum, int size, int is_tx);
+int musb_dma_tx(MUSBState *s, int epnum, const uint8_t *buf, int len);
+int musb_dma_rx(MUSBState *s, int epnum, uint8_t *buf, int len, bool *eop);
+
+extern const VMStateDescription vmstate_musb;
 
 #endif
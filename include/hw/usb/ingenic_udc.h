@@ -39,10 +39,12 @@ typedef struct IngenicUdc
     SysBusDevice parent_obj;
     MemoryRegion mr;
     MUSBState *musb;
+    QEMUBH *dma_bh;
+    qemu_irq irq;
 
     // DMA channels
     uint32_t dma_intr;
-    struct {
+    struct IngenicUdcDma {
         uint32_t cntl;
         uint32_t addr;
         uint32_t count;
@@ -71,6 +71,8 @@ struct VirtIOBalloon {
 
     bool qemu_4_0_config_size;
     uint32_t poison_val;
+    /* bytes discarded through free page reporting */
+    uint64_t free_page_reported;
 };
 
 #endif
@@ -0,0 +1,60 @@
+/*
+ * QEMU I/O channels io_uring support
+ *
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef QIO_CHANNEL_URING_H
+#define QIO_CHANNEL_URING_H
+
+#include "io/channel.h"
+
+/* qio_channel_wake_read() interrupted the wait, retry the read at once */
+#define QIO_CHANNEL_URING_WOKEN -3
+
+/**
+ * qio_channel_uring_co_rw:
+ * @ioc: the channel object
+ * @fd: the socket backing @ioc
+ * @is_read: whether to read into or write from @iov
+ * @iov: the array of memory regions
+ * @niov: the length of the @iov array
+ * @errp: pointer to a NULL-initialized error object
+ *
+ * Submit a recvmsg or sendmsg on @fd to the io_uring of the calling
+ * thread and yield until it completes.  This is meant for when the
+ * plain non-blocking I/O reported QIO_CHANNEL_ERR_BLOCK: the kernel
+ * then finishes the operation as soon as the fd is ready, without
+ * the poll and retry round trip of qio_channel_yield().
+ *
+ * Like qio_channel_yield(), the wait can be interrupted with
+ * qio_channel_wake_read().  The request is then cancelled, and
+ * QIO_CHANNEL_URING_WOKEN tells the caller to retry the read right
+ * away, as it would after qio_channel_yield() returned.
+ *
+ * Returns: the number of bytes transferred, 0 on end-of-file when
+ * reading, -1 on error, QIO_CHANNEL_URING_WOKEN if the wait was
+ * interrupted, or QIO_CHANNEL_ERR_BLOCK if the request could not be
+ * submitted or the kernel asked to try again, and the caller should
+ * fall back to qio_channel_yield()
+ */
+ssize_t coroutine_fn qio_channel_uring_co_rw(QIOChannel *ioc, int fd,
+                                             bool is_read,
+                                             const struct iovec *iov,
+                                             size_t niov,
+                                             Error **errp);
+
+#endif /* QIO_CHANNEL_URING_H */
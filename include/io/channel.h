@@ -87,6 +87,9 @@ struct QIOChannel {
     AioContext *write_ctx;
     Coroutine *write_coroutine;
     bool follow_coroutine_ctx;
+    bool use_uring;
+    Coroutine *uring_read_coroutine;
+    Coroutine *uring_write_coroutine;
 #ifdef _WIN32
     HANDLE event; /* For use with GSource on Win32 */
 #endif
@@ -160,6 +163,7 @@ struct QIOChannelClass {
                                   void *opaque);
     int (*io_flush)(QIOChannel *ioc,
                     Error **errp);
+    int (*io_uring_fd)(QIOChannel *ioc);
 };
 
 /* General I/O handling functions */
@@ -527,6 +531,23 @@ int qio_channel_set_blocking(QIOChannel *ioc,
  */
 void qio_channel_set_follow_coroutine_ctx(QIOChannel *ioc, bool enabled);
 
+/**
+ * qio_channel_set_uring:
+ * @ioc: the channel object
+ * @enabled: whether or not to use io_uring
+ *
+ * If @enabled is true, qio_channel_readv_full_all() and
+ * qio_channel_writev_full_all() called from a coroutine submit the
+ * I/O to io_uring when the channel would block, instead of waiting in
+ * qio_channel_yield() for the fd to become ready and retrying.  This
+ * only applies without file descriptor passing or write flags, to
+ * channels that also follow the coroutine's AioContext.
+ *
+ * This setting is merely a hint, channels that are not backed by a
+ * socket, or builds without io_uring, ignore it.
+ */
+void qio_channel_set_uring(QIOChannel *ioc, bool enabled);
+
 /**
  * qio_channel_close:
  * @ioc: the channel object
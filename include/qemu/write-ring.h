@@ -0,0 +1,121 @@
+/*
+ * Ring buffer drained to a file descriptor by a writer thread
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#ifndef QEMU_WRITE_RING_H
+#define QEMU_WRITE_RING_H
+
+#include "qemu/thread.h"
+
+/*
+ * A single producer appends to the ring and a background thread writes
+ * it out, so the producer never waits for write(2).  The producer
+ * reserves space with write_ring_begin(), fills it with write_ring_put()
+ * or write_ring_put_iov(), and makes it visible to the writer with
+ * write_ring_commit().  Only the space check and the commit take the
+ * lock.
+ *
+ * A failed write either discards the data it covered and carries on, or
+ * stops the writer for good; the producer can check for the latter with
+ * write_ring_failed().
+ */
+typedef struct WriteRing {
+    /* All fields are private */
+    int fd;
+    const char *name;
+    uint8_t *buf;
+    size_t size;
+    bool stop_on_error;
+    QemuThread thread;
+
+    /* protected by lock */
+    QemuMutex lock;
+    QemuCond cond;
+    size_t prod;
+    size_t cons;
+    bool stopping;
+    bool failed;
+} WriteRing;
+
+/**
+ * write_ring_init:
+ * @ring: ring to initialise
+ * @fd: file descriptor the writer thread writes to, still owned by the caller
+ * @size: ring size in bytes, must be a power of two
+ * @name: name of the writer thread
+ * @stop_on_error: stop writing after the first failed write, rather than
+ *                 dropping the data it covered and going on
+ *
+ * Allocate the ring and start its writer thread.
+ */
+void write_ring_init(WriteRing *ring, int fd, size_t size, const char *name,
+                     bool stop_on_error);
+
+/**
+ * write_ring_destroy:
+ * @ring: ring to tear down
+ *
+ * Write out whatever is still queued, stop the writer thread and free
+ * the ring.  The file descriptor is left open.
+ */
+void write_ring_destroy(WriteRing *ring);
+
+/**
+ * write_ring_begin:
+ * @ring: ring to append to
+ * @prod: set to the position to pass to write_ring_put()
+ *
+ * Returns the number of bytes that can be appended at @prod, 0 once a
+ * write error stopped the writer.  The space cannot shrink until the
+ * producer commits.
+ */
+size_t write_ring_begin(WriteRing *ring, size_t *prod);
+
+/**
+ * write_ring_failed:
+ * @ring: ring to check
+ *
+ * Returns true once a write error stopped a ring initialised with
+ * @stop_on_error.  Nothing is written after that.
+ */
+bool write_ring_failed(WriteRing *ring);
+
+/**
+ * write_ring_put:
+ * @ring: ring to append to
+ * @prod: position inside the space returned by write_ring_begin()
+ * @buf: data to copy
+ * @len: number of bytes to copy
+ *
+ * Copy @buf into the ring at @prod, wrapping around its end.
+ */
+void write_ring_put(WriteRing *ring, size_t prod, const void *buf, size_t len);
+
+/**
+ * write_ring_put_iov:
+ * @ring: ring to append to
+ * @prod: position inside the space returned by write_ring_begin()
+ * @iov: data to copy
+ * @cnt: number of elements in @iov
+ * @offset: offset of the first byte to copy in @iov
+ * @len: number of bytes to copy
+ *
+ * Like write_ring_put(), gathering the data from @iov.
+ */
+void write_ring_put_iov(WriteRing *ring, size_t prod, const struct iovec *iov,
+                        int cnt, size_t offset, size_t len);
+
+/**
+ * write_ring_commit:
+ * @ring: ring to append to
+ * @prod: end of the data copied since write_ring_begin()
+ *
+ * Publish the data up to @prod to the writer thread, waking it if it
+ * was idle.
+ */
+void write_ring_commit(WriteRing *ring, size_t prod);
+
+#endif /* QEMU_WRITE_RING_H */
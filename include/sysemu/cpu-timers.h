@@ -94,6 +94,15 @@ int64_t cpu_get_ticks(void);
  */
 int64_t cpu_get_clock(void);
 
+/*
+ * Advance the VIRTUAL clock by up to @max_ns without waiting, stopping at
+ * the next VIRTUAL timer deadline so that timers still expire in order.
+ * Meant for devices that detect the guest busy-waiting on them. Does
+ * nothing with icount, which warps the clock by itself.
+ * Returns the amount the clock was advanced by. Caller must hold BQL.
+ */
+int64_t cpu_clock_warp(int64_t max_ns);
+
 void qemu_timer_notify_cb(void *opaque, QEMUClockType type);
 
 /* get the VIRTUAL clock and VM elapsed ticks via the cpus accel interface */
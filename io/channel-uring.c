@@ -0,0 +1,240 @@
+/*
+ * QEMU I/O channels io_uring support
+ *
+ * Reads and writes from coroutines that would otherwise wait for a socket
+ * to become ready are submitted to a per-thread io_uring instead.  They
+ * go through recvmsg/sendmsg, which io_uring parks on an internal poll
+ * until the socket is ready even if it is in non-blocking mode; readv and
+ * writev would just fail with EAGAIN again on such an fd.  The
+ * submissions queued by all coroutines during one event loop iteration
+ * reach the kernel with a single io_uring_enter() from a bottom half, and
+ * completions are picked up through the ring fd.
+ *
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "qemu/osdep.h"
+#include <liburing.h>
+#include "qapi/error.h"
+#include "io/channel-uring.h"
+#include "qemu/coroutine.h"
+#include "qemu/coroutine-tls.h"
+#include "qemu/iov.h"
+#include "qemu/notify.h"
+#include "qemu/thread.h"
+#include "trace.h"
+
+/* Requests in flight per thread, further ones fall back to polling */
+#define QIO_CHANNEL_URING_ENTRIES 64
+
+typedef struct QIOChannelUring {
+    struct io_uring ring;
+    AioContext *ctx;
+    QEMUBH *submit_bh;
+    Notifier exit_notifier;
+    unsigned int in_flight;
+} QIOChannelUring;
+
+typedef struct QIOChannelUringReq {
+    QIOChannel *ioc;
+    Coroutine *co;
+    struct msghdr msg;
+    bool is_read;
+    bool cancelling;
+    int ret;
+} QIOChannelUringReq;
+
+QEMU_DEFINE_STATIC_CO_TLS(QIOChannelUring *, qio_channel_uring)
+/* Don't retry in a thread where the ring could not be set up */
+QEMU_DEFINE_STATIC_CO_TLS(bool, qio_channel_uring_failed)
+
+static void qio_channel_uring_submit_bh(void *opaque)
+{
+    QIOChannelUring *u = opaque;
+    int ret;
+
+    do {
+        ret = io_uring_submit(&u->ring);
+    } while (ret == -EINTR);
+
+    trace_qio_channel_uring_submit(u, ret);
+}
+
+static void qio_channel_uring_complete(void *opaque)
+{
+    QIOChannelUring *u = opaque;
+    struct io_uring_cqe *cqe;
+
+    while (io_uring_peek_cqe(&u->ring, &cqe) == 0) {
+        QIOChannelUringReq *req = io_uring_cqe_get_data(cqe);
+        int res = cqe->res;
+        Coroutine *co;
+
+        io_uring_cqe_seen(&u->ring, cqe);
+
+        /* Cancellations have no request attached */
+        if (!req) {
+            continue;
+        }
+        u->in_flight--;
+        req->ret = res;
+        trace_qio_channel_uring_complete(req->ioc, req->is_read, res);
+
+        if (req->cancelling) {
+            co = req->co;
+        } else {
+            co = qatomic_xchg(req->is_read ? &req->ioc->uring_read_coroutine :
+                              &req->ioc->uring_write_coroutine, NULL);
+        }
+        /* NULL if woken early, the coroutine will see req->ret */
+        if (co) {
+            aio_co_wake(co);
+        }
+    }
+}
+
+static void qio_channel_uring_cleanup(Notifier *n, void *data)
+{
+    QIOChannelUring *u = container_of(n, QIOChannelUring, exit_notifier);
+
+    aio_set_fd_handler(u->ctx, u->ring.ring_fd, NULL, NULL, NULL, NULL, NULL);
+    qemu_bh_delete(u->submit_bh);
+    io_uring_queue_exit(&u->ring);
+    set_qio_channel_uring(NULL);
+    g_free(u);
+}
+
+static QIOChannelUring *qio_channel_uring_get(AioContext *ctx)
+{
+    QIOChannelUring *u = get_qio_channel_uring();
+
+    if (u) {
+        /* The ring completes in the AioContext it was set up for */
+        return u->ctx == ctx ? u : NULL;
+    }
+    if (get_qio_channel_uring_failed()) {
+        return NULL;
+    }
+
+    u = g_new0(QIOChannelUring, 1);
+    if (io_uring_queue_init(QIO_CHANNEL_URING_ENTRIES, &u->ring, 0) < 0) {
+        g_free(u);
+        set_qio_channel_uring_failed(true);
+        return NULL;
+    }
+    u->ctx = ctx;
+    u->submit_bh = aio_bh_new(ctx, qio_channel_uring_submit_bh, u);
+    aio_set_fd_handler(ctx, u->ring.ring_fd, qio_channel_uring_complete,
+                       NULL, NULL, NULL, u);
+    u->exit_notifier.notify = qio_channel_uring_cleanup;
+    qemu_thread_atexit_add(&u->exit_notifier);
+    set_qio_channel_uring(u);
+    return u;
+}
+
+static struct io_uring_sqe *qio_channel_uring_get_sqe(QIOChannelUring *u)
+{
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&u->ring);
+
+    if (!sqe) {
+        /* More than a ring's worth queued in this iteration */
+        qio_channel_uring_submit_bh(u);
+        sqe = io_uring_get_sqe(&u->ring);
+    }
+    if (sqe) {
+        qemu_bh_schedule(u->submit_bh);
+    }
+    return sqe;
+}
+
+ssize_t coroutine_fn qio_channel_uring_co_rw(QIOChannel *ioc, int fd,
+                                             bool is_read,
+                                             const struct iovec *iov,
+                                             size_t niov,
+                                             Error **errp)
+{
+    QIOChannelUringReq req = {
+        .ioc = ioc,
+        .co = qemu_coroutine_self(),
+        .is_read = is_read,
+        .ret = -EINPROGRESS,
+    };
+    Coroutine **slot = is_read ? &ioc->uring_read_coroutine :
+                                 &ioc->uring_write_coroutine;
+    QIOChannelUring *u;
+    struct io_uring_sqe *sqe;
+
+    u = qio_channel_uring_get(qemu_coroutine_get_aio_context(req.co));
+    if (!u || u->in_flight >= QIO_CHANNEL_URING_ENTRIES || niov > IOV_MAX) {
+        return QIO_CHANNEL_ERR_BLOCK;
+    }
+    sqe = qio_channel_uring_get_sqe(u);
+    if (!sqe) {
+        return QIO_CHANNEL_ERR_BLOCK;
+    }
+
+    /* The kernel reads @msg when it issues the request, keep it around */
+    req.msg.msg_iov = (struct iovec *)iov;
+    req.msg.msg_iovlen = niov;
+    if (is_read) {
+        io_uring_prep_recvmsg(sqe, fd, &req.msg, 0);
+    } else {
+        io_uring_prep_sendmsg(sqe, fd, &req.msg, 0);
+    }
+    io_uring_sqe_set_data(sqe, &req);
+    u->in_flight++;
+    trace_qio_channel_uring_queue(ioc, is_read, iov_size(iov, niov));
+
+    assert(!*slot);
+    qatomic_set(slot, req.co);
+    qemu_coroutine_yield();
+
+    if (req.ret == -EINPROGRESS) {
+        /*
+         * Woken through qio_channel_wake_read() while the kernel still
+         * owns @iov, it must let go of it before we return.  The caller
+         * then retries instead of parking in qio_channel_yield(), which
+         * is what a wakeup means there too.
+         */
+        req.cancelling = true;
+        sqe = qio_channel_uring_get_sqe(u);
+        if (sqe) {
+            io_uring_prep_cancel(sqe, &req, 0);
+            io_uring_sqe_set_data(sqe, NULL);
+        }
+        while (req.ret == -EINPROGRESS) {
+            qemu_coroutine_yield();
+        }
+    }
+
+    if (req.cancelling) {
+        /* Data that raced with the cancellation is still data */
+        if (req.ret >= 0) {
+            return req.ret;
+        }
+        return QIO_CHANNEL_URING_WOKEN;
+    }
+    if (req.ret == -EAGAIN || req.ret == -EINTR) {
+        return QIO_CHANNEL_ERR_BLOCK;
+    }
+    if (req.ret < 0) {
+        error_setg_errno(errp, -req.ret, is_read ?
+                         "Unable to read from channel" :
+                         "Unable to write to channel");
+        return -1;
+    }
+    return req.ret;
+}
@@ -21,6 +21,7 @@
 #include "qemu/osdep.h"
 #include "block/aio-wait.h"
 #include "io/channel.h"
+#include "io/channel-uring.h"
 #include "qapi/error.h"
 #include "qemu/main-loop.h"
 #include "qemu/module.h"
@@ -126,6 +127,28 @@ int coroutine_mixed_fn qio_channel_readv_all(QIOChannel *ioc,
     return qio_channel_readv_full_all(ioc, iov, niov, NULL, NULL, errp);
 }
 
+/*
+ * Hand I/O that would block over to io_uring, returns QIO_CHANNEL_ERR_BLOCK
+ * if the caller has to go through qio_channel_yield() instead, or
+ * QIO_CHANNEL_URING_WOKEN if qio_channel_wake_read() interrupted a read.
+ */
+static ssize_t coroutine_fn qio_channel_co_uring_rw(QIOChannel *ioc,
+                                                    bool is_read,
+                                                    const struct iovec *iov,
+                                                    size_t niov,
+                                                    Error **errp)
+{
+#ifdef CONFIG_LINUX_IO_URING
+    QIOChannelClass *klass = QIO_CHANNEL_GET_CLASS(ioc);
+
+    if (ioc->use_uring && ioc->follow_coroutine_ctx) {
+        return qio_channel_uring_co_rw(ioc, klass->io_uring_fd(ioc), is_read,
+                                       iov, niov, errp);
+    }
+#endif
+    return QIO_CHANNEL_ERR_BLOCK;
+}
+
 int coroutine_mixed_fn qio_channel_readv_full_all_eof(QIOChannel *ioc,
                                                       const struct iovec *iov,
                                                       size_t niov,
@@ -156,6 +179,13 @@ int coroutine_mixed_fn qio_channel_readv_full_all_eof(QIOChannel *ioc,
         ssize_t len;
         len = qio_channel_readv_full(ioc, local_iov, nlocal_iov, local_fds,
                                      local_nfds, 0, errp);
+        if (len == QIO_CHANNEL_ERR_BLOCK && !local_fds && qemu_in_coroutine()) {
+            len = qio_channel_co_uring_rw(ioc, true, local_iov, nlocal_iov,
+                                          errp);
+            if (len == QIO_CHANNEL_URING_WOKEN) {
+                continue;
+            }
+        }
         if (len == QIO_CHANNEL_ERR_BLOCK) {
             if (qemu_in_coroutine()) {
                 qio_channel_yield(ioc, G_IO_IN);
@@ -264,6 +294,11 @@ int coroutine_mixed_fn qio_channel_writev_full_all(QIOChannel *ioc,
         len = qio_channel_writev_full(ioc, local_iov, nlocal_iov, fds,
                                             nfds, flags, errp);
 
+        if (len == QIO_CHANNEL_ERR_BLOCK && !nfds && !flags &&
+            qemu_in_coroutine()) {
+            len = qio_channel_co_uring_rw(ioc, false, local_iov, nlocal_iov,
+                                          errp);
+        }
         if (len == QIO_CHANNEL_ERR_BLOCK) {
             if (qemu_in_coroutine()) {
                 qio_channel_yield(ioc, G_IO_OUT);
@@ -370,6 +405,13 @@ void qio_channel_set_follow_coroutine_ctx(QIOChannel *ioc, bool enabled)
     ioc->follow_coroutine_ctx = enabled;
 }
 
+void qio_channel_set_uring(QIOChannel *ioc, bool enabled)
+{
+    QIOChannelClass *klass = QIO_CHANNEL_GET_CLASS(ioc);
+
+    ioc->use_uring = enabled && klass->io_uring_fd;
+}
+
 
 int qio_channel_close(QIOChannel *ioc,
                       Error **errp)
@@ -722,6 +764,10 @@ void qio_channel_wake_read(QIOChannel *ioc)
     if (co) {
         aio_co_wake(co);
     }
+    co = qatomic_xchg(&ioc->uring_read_coroutine, NULL);
+    if (co) {
+        aio_co_wake(co);
+    }
 }
 
 static gboolean qio_channel_wait_complete(QIOChannel *ioc,
@@ -763,9 +809,11 @@ static void qio_channel_finalize(Object *obj)
 {
     QIOChannel *ioc = QIO_CHANNEL(obj);
 
-    /* Must not have coroutines in qio_channel_yield() */
+    /* Must not have coroutines in qio_channel_yield() or io_uring */
     assert(!ioc->read_coroutine);
     assert(!ioc->write_coroutine);
+    assert(!ioc->uring_read_coroutine);
+    assert(!ioc->uring_write_coroutine);
 
     g_free(ioc->name);
 
@@ -55,6 +55,12 @@ typedef struct {
      * copy.
      */
     Stat64 dirty_sync_missed_zero_copy;
+    /*
+     * Duration in microseconds of the last dirty bitmap sync, and the
+     * longest one seen during this migration.
+     */
+    Stat64 dirty_sync_time_last;
+    Stat64 dirty_sync_time_max;
     /*
      * Number of bytes sent at migration completion stage while the
      * guest is stopped.
@@ -1051,9 +1051,11 @@ static void migration_trigger_throttle(RAMState *rs)
 static void migration_bitmap_sync(RAMState *rs, bool last_stage)
 {
     RAMBlock *block;
+    int64_t start_us, sync_us;
     int64_t end_time;
 
     stat64_add(&mig_stats.dirty_sync_count, 1);
+    start_us = qemu_clock_get_us(QEMU_CLOCK_REALTIME);
 
     if (!rs->time_last_bitmap_sync) {
         rs->time_last_bitmap_sync = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
@@ -1074,6 +1076,10 @@ static void migration_bitmap_sync(RAMState *rs, bool last_stage)
     memory_global_after_dirty_log_sync();
     trace_migration_bitmap_sync_end(rs->num_dirty_pages_period);
 
+    sync_us = qemu_clock_get_us(QEMU_CLOCK_REALTIME) - start_us;
+    stat64_set(&mig_stats.dirty_sync_time_last, sync_us);
+    stat64_max(&mig_stats.dirty_sync_time_max, sync_us);
+
     end_time = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
 
     /* more than 1 second = 1000 millisecons */
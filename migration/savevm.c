@@ -1494,6 +1494,7 @@ static
 int qemu_savevm_state_complete_precopy_iterable(QEMUFile *f, bool in_postcopy)
 {
     int64_t start_ts_each, end_ts_each;
+    uint64_t start_bytes;
     SaveStateEntry *se;
     int ret;
 
@@ -1512,6 +1513,7 @@ int qemu_savevm_state_complete_precopy_iterable(QEMUFile *f, bool in_postcopy)
         }
 
         start_ts_each = qemu_clock_get_us(QEMU_CLOCK_REALTIME);
+        start_bytes = qemu_file_transferred(f);
         trace_savevm_section_start(se->idstr, se->section_id);
 
         save_section_header(f, se, QEMU_VM_SECTION_END);
@@ -1525,7 +1527,8 @@ int qemu_savevm_state_complete_precopy_iterable(QEMUFile *f, bool in_postcopy)
         }
         end_ts_each = qemu_clock_get_us(QEMU_CLOCK_REALTIME);
         trace_vmstate_downtime_save("iterable", se->idstr, se->instance_id,
-                                    end_ts_each - start_ts_each);
+                                    end_ts_each - start_ts_each,
+                                    qemu_file_transferred(f) - start_bytes);
     }
 
     trace_vmstate_downtime_checkpoint("src-iterable-saved");
@@ -1539,6 +1542,7 @@ int qemu_savevm_state_complete_precopy_non_iterable(QEMUFile *f,
 {
     MigrationState *ms = migrate_get_current();
     int64_t start_ts_each, end_ts_each;
+    uint64_t start_bytes;
     JSONWriter *vmdesc = ms->vmdesc;
     int vmdesc_len;
     SaveStateEntry *se;
@@ -1551,6 +1555,7 @@ int qemu_savevm_state_complete_precopy_non_iterable(QEMUFile *f,
         }
 
         start_ts_each = qemu_clock_get_us(QEMU_CLOCK_REALTIME);
+        start_bytes = qemu_file_transferred(f);
 
         ret = vmstate_save(f, se, vmdesc);
         if (ret) {
@@ -1560,7 +1565,8 @@ int qemu_savevm_state_complete_precopy_non_iterable(QEMUFile *f,
 
         end_ts_each = qemu_clock_get_us(QEMU_CLOCK_REALTIME);
         trace_vmstate_downtime_save("non-iterable", se->idstr, se->instance_id,
-                                    end_ts_each - start_ts_each);
+                                    end_ts_each - start_ts_each,
+                                    qemu_file_transferred(f) - start_bytes);
     }
 
     if (inactivate_disks) {
@@ -143,6 +143,31 @@ void hmp_sync_profile(Monitor *mon, const QDict *qdict)
     }
 }
 
+void hmp_mmio_profile(Monitor *mon, const QDict *qdict)
+{
+    const char *op = qdict_get_try_str(qdict, "op");
+
+    if (op == NULL) {
+        bool on = mmio_profile_is_enabled();
+
+        monitor_printf(mon, "mmio-profile is %s\n", on ? "on" : "off");
+        return;
+    }
+    if (!strcmp(op, "on")) {
+        mmio_profile_enable(true);
+    } else if (!strcmp(op, "off")) {
+        mmio_profile_enable(false);
+    } else if (!strcmp(op, "reset")) {
+        mmio_profile_reset();
+    } else {
+        Error *err = NULL;
+
+        error_setg(&err, "invalid parameter '%s',"
+                   " expecting 'on', 'off', or 'reset'", op);
+        hmp_handle_error(mon, err);
+    }
+}
+
 void hmp_exit_preconfig(Monitor *mon, const QDict *qdict)
 {
     Error *err = NULL;
@@ -440,6 +465,13 @@ void hmp_info_mtree(Monitor *mon, const QDict *qdict)
     bool dispatch_tree = qdict_get_try_bool(qdict, "dispatch_tree", false);
     bool owner = qdict_get_try_bool(qdict, "owner", false);
     bool disabled = qdict_get_try_bool(qdict, "disabled", false);
+    bool profile = qdict_get_try_bool(qdict, "profile", false);
+
+    if (profile) {
+        g_autoptr(GString) buf = mmio_profile_format();
 
+        monitor_puts(mon, buf->str);
+        return;
+    }
     mtree_info(flatview, dispatch_tree, owner, disabled);
 }
@@ -1406,6 +1406,7 @@ static coroutine_fn int nbd_negotiate(NBDClient *client, Error **errp)
 
     qio_channel_set_blocking(client->ioc, false, NULL);
     qio_channel_set_follow_coroutine_ctx(client->ioc, true);
+    qio_channel_set_uring(client->ioc, true);
 
     trace_nbd_negotiate_begin();
     memcpy(buf, "NBDMAGIC", 8);
@@ -27,17 +27,30 @@
 #include "qapi/error.h"
 #include "qemu/error-report.h"
 #include "qemu/iov.h"
+#include "qemu/host-utils.h"
 #include "qemu/module.h"
 #include "qemu/timer.h"
+#include "qemu/units.h"
+#include "qemu/write-ring.h"
 #include "qapi/visitor.h"
 #include "net/filter.h"
 #include "qom/object.h"
 #include "sysemu/rtc.h"
 
+/* Minimum size of the record ring drained by the writer thread */
+#define DUMP_RING_SIZE (4 * MiB)
+
 typedef struct DumpState {
     int64_t start_ts;
     int fd;
     int pcap_caplen;
+
+    /*
+     * pcap records are queued in a ring and written out by a separate
+     * thread, so the network datapath never blocks on the dump file.
+     */
+    WriteRing ring;
+    bool ring_started;
 } DumpState;
 
 #define PCAP_MAGIC 0xa1b2c3d4
@@ -61,6 +74,17 @@ struct pcap_sf_pkthdr {
     uint32_t len;
 };
 
+static void dump_cleanup(DumpState *s)
+{
+    if (s->ring_started) {
+        /* write out whatever is still queued */
+        write_ring_destroy(&s->ring);
+        s->ring_started = false;
+    }
+    close(s->fd);
+    s->fd = -1;
+}
+
 static ssize_t dump_receive_iov(DumpState *s, const struct iovec *iov, int cnt,
                                 int offset)
 {
@@ -68,7 +92,7 @@ static ssize_t dump_receive_iov(DumpState *s, const struct iovec *iov, int cnt,
     int64_t ts;
     int caplen;
     size_t size = iov_size(iov, cnt) - offset;
-    g_autofree struct iovec *dumpiov = g_new(struct iovec, cnt + 1);
+    size_t prod;
 
     /* Early return in case of previous error. */
     if (s->fd < 0) {
@@ -83,25 +107,23 @@ static ssize_t dump_receive_iov(DumpState *s, const struct iovec *iov, int cnt,
     hdr.caplen = caplen;
     hdr.len = size;
 
-    dumpiov[0].iov_base = &hdr;
-    dumpiov[0].iov_len = sizeof(hdr);
-    cnt = iov_copy(&dumpiov[1], cnt, iov, cnt, offset, caplen);
-
-    if (writev(s->fd, dumpiov, cnt + 1) != sizeof(hdr) + caplen) {
-        error_report("network dump write error - stopping dump");
-        close(s->fd);
-        s->fd = -1;
+    if (write_ring_begin(&s->ring, &prod) < sizeof(hdr) + caplen) {
+        /* A failed ring has no space left */
+        if (write_ring_failed(&s->ring)) {
+            error_report("network dump write error - stopping dump");
+            dump_cleanup(s);
+        } else {
+            warn_report_once("network dump ring full - dropping packets");
+        }
+        return size;
     }
+    write_ring_put(&s->ring, prod, &hdr, sizeof(hdr));
+    write_ring_put_iov(&s->ring, prod + sizeof(hdr), iov, cnt, offset, caplen);
+    write_ring_commit(&s->ring, prod + sizeof(hdr) + caplen);
 
     return size;
 }
 
-static void dump_cleanup(DumpState *s)
-{
-    close(s->fd);
-    s->fd = -1;
-}
-
 static int net_dump_state_init(DumpState *s, const char *filename,
                                int len, Error **errp)
 {
@@ -135,6 +157,12 @@ static int net_dump_state_init(DumpState *s, const char *filename,
     qemu_get_timedate(&tm, 0);
     s->start_ts = mktime(&tm);
 
+    write_ring_init(&s->ring, fd,
+                    pow2ceil(MAX(DUMP_RING_SIZE,
+                                 4 * (sizeof(struct pcap_sf_pkthdr) + len))),
+                    "net-dump", true);
+    s->ring_started = true;
+
     return 0;
 }
 
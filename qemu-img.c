@@ -86,6 +86,8 @@ enum {
     OPTION_BITMAPS = 275,
     OPTION_FORCE = 276,
     OPTION_SKIP_BROKEN = 277,
+    OPTION_RANDOM = 278,
+    OPTION_WRITE_RATIO = 279,
 };
 
 typedef enum OutputFormat {
@@ -4413,7 +4415,9 @@ out_no_progress:
 typedef struct BenchData {
     BlockBackend *blk;
     uint64_t image_size;
-    bool write;
+    int write_ratio;
+    bool random;
+    GRand *rand;
     int bufsize;
     int step;
     int nrreq;
@@ -4422,12 +4426,23 @@ typedef struct BenchData {
     bool drain_on_flush;
     uint8_t *buf;
     QEMUIOVector *qiov;
+    /* separate from qiov in mixed mode, so reads keep the pattern intact */
+    QEMUIOVector *read_qiov;
 
     int in_flight;
     bool in_flush;
     uint64_t offset;
+
+    /* per-request latency in ns, in order of completion */
+    int64_t *lat;
+    int nr_lat;
 } BenchData;
 
+typedef struct BenchReq {
+    BenchData *b;
+    int64_t start;
+} BenchReq;
+
 static void bench_undrained_flush_cb(void *opaque, int ret)
 {
     if (ret < 0) {
@@ -4436,6 +4451,43 @@ static void bench_undrained_flush_cb(void *opaque, int ret)
     }
 }
 
+static void bench_cb(void *opaque, int ret);
+
+static void bench_req_cb(void *opaque, int ret)
+{
+    BenchReq *req = opaque;
+    BenchData *b = req->b;
+
+    b->lat[b->nr_lat++] = get_clock() - req->start;
+    g_free(req);
+    bench_cb(b, ret);
+}
+
+static uint64_t bench_next_offset(BenchData *b)
+{
+    uint64_t offset = b->offset;
+
+    if (b->random) {
+        uint64_t slots = b->image_size / b->bufsize;
+        uint64_t r = ((uint64_t)g_rand_int(b->rand) << 32) |
+                     g_rand_int(b->rand);
+
+        return (r % slots) * b->bufsize;
+    }
+
+    b->offset += b->step;
+    b->offset %= b->image_size;
+    return offset;
+}
+
+static bool bench_next_is_write(BenchData *b)
+{
+    if (b->write_ratio == 0 || b->write_ratio == 100) {
+        return b->write_ratio == 100;
+    }
+    return g_rand_int_range(b->rand, 0, 100) < b->write_ratio;
+}
+
 static void bench_cb(void *opaque, int ret)
 {
     BenchData *b = opaque;
@@ -4481,18 +4533,22 @@ static void bench_cb(void *opaque, int ret)
     }
 
     while (b->n > b->in_flight && b->in_flight < b->nrreq) {
-        int64_t offset = b->offset;
+        int64_t offset = bench_next_offset(b);
+        BenchReq *req = g_new(BenchReq, 1);
+
         /* blk_aio_* might look for completed I/Os and kick bench_cb
          * again, so make sure this operation is counted by in_flight
          * and b->offset is ready for the next submission.
          */
         b->in_flight++;
-        b->offset += b->step;
-        b->offset %= b->image_size;
-        if (b->write) {
-            acb = blk_aio_pwritev(b->blk, offset, b->qiov, 0, bench_cb, b);
+        req->b = b;
+        req->start = get_clock();
+        if (bench_next_is_write(b)) {
+            acb = blk_aio_pwritev(b->blk, offset, b->qiov, 0,
+                                  bench_req_cb, req);
         } else {
-            acb = blk_aio_preadv(b->blk, offset, b->qiov, 0, bench_cb, b);
+            acb = blk_aio_preadv(b->blk, offset, b->read_qiov, 0,
+                                 bench_req_cb, req);
         }
         if (!acb) {
             error_report("Failed to issue request");
@@ -4501,6 +4557,44 @@ static void bench_cb(void *opaque, int ret)
     }
 }
 
+static int bench_cmp_lat(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void bench_report(BenchData *b, int count, double secs,
+                         OutputFormat output_format)
+{
+    double iops = secs > 0 ? count / secs : 0;
+    int64_t p50 = 0, p99 = 0, p999 = 0, max = 0;
+
+    if (b->nr_lat) {
+        qsort(b->lat, b->nr_lat, sizeof(*b->lat), bench_cmp_lat);
+        p50 = b->lat[b->nr_lat / 2];
+        p99 = b->lat[(int64_t)b->nr_lat * 99 / 100];
+        p999 = b->lat[(int64_t)b->nr_lat * 999 / 1000];
+        max = b->lat[b->nr_lat - 1];
+    }
+
+    if (output_format == OFORMAT_JSON) {
+        printf("{\"requests\": %d, \"bytes\": %" PRId64 ", "
+               "\"seconds\": %.6f, \"iops\": %.1f, "
+               "\"lat-p50-ns\": %" PRId64 ", \"lat-p99-ns\": %" PRId64 ", "
+               "\"lat-p999-ns\": %" PRId64 ", \"lat-max-ns\": %" PRId64
+               "}\n",
+               count, (int64_t)count * b->bufsize, secs, iops,
+               p50, p99, p999, max);
+        return;
+    }
+
+    printf("Run completed in %3.3f seconds.\n", secs);
+    printf("%.0f IOPS, latency p50 %.1f us, p99 %.1f us, p99.9 %.1f us, "
+           "max %.1f us\n",
+           iops, p50 / 1000.0, p99 / 1000.0, p999 / 1000.0, max / 1000.0);
+}
+
 static int img_bench(int argc, char **argv)
 {
     int c, ret = 0;
@@ -4516,6 +4610,11 @@ static int img_bench(int argc, char **argv)
     size_t step = 0;
     int flush_interval = 0;
     bool drain_on_flush = true;
+    bool random = false;
+    int write_ratio = -1;
+    OutputFormat output_format = OFORMAT_HUMAN;
+    const char *output = NULL;
+    double secs;
     int64_t image_size;
     BlockBackend *blk = NULL;
     BenchData data = {};
@@ -4525,6 +4624,8 @@ static int img_bench(int argc, char **argv)
     int i;
     bool force_share = false;
     size_t buf_size = 0;
+    bool mixed;
+    QEMUIOVector read_qiov;
 
     for (;;) {
         static const struct option long_options[] = {
@@ -4533,6 +4634,9 @@ static int img_bench(int argc, char **argv)
             {"image-opts", no_argument, 0, OPTION_IMAGE_OPTS},
             {"pattern", required_argument, 0, OPTION_PATTERN},
             {"no-drain", no_argument, 0, OPTION_NO_DRAIN},
+            {"random", no_argument, 0, OPTION_RANDOM},
+            {"write-ratio", required_argument, 0, OPTION_WRITE_RATIO},
+            {"output", required_argument, 0, OPTION_OUTPUT},
             {"force-share", no_argument, 0, 'U'},
             {0, 0, 0, 0}
         };
@@ -4664,12 +4768,45 @@ static int img_bench(int argc, char **argv)
         case OPTION_NO_DRAIN:
             drain_on_flush = false;
             break;
+        case OPTION_RANDOM:
+            random = true;
+            break;
+        case OPTION_WRITE_RATIO:
+        {
+            unsigned long res;
+
+            if (qemu_strtoul(optarg, NULL, 0, &res) < 0 || res > 100) {
+                error_report("Invalid write ratio specified");
+                return 1;
+            }
+            write_ratio = res;
+            break;
+        }
+        case OPTION_OUTPUT:
+            output = optarg;
+            break;
         case OPTION_IMAGE_OPTS:
             image_opts = true;
             break;
         }
     }
 
+    if (output && !strcmp(output, "json")) {
+        output_format = OFORMAT_JSON;
+    } else if (output && !strcmp(output, "human")) {
+        output_format = OFORMAT_HUMAN;
+    } else if (output) {
+        error_report("--output must be used with human or json as argument.");
+        return 1;
+    }
+
+    if (write_ratio < 0) {
+        write_ratio = is_write ? 100 : 0;
+    } else if (write_ratio > 0) {
+        flags |= BDRV_O_RDWR;
+        is_write = true;
+    }
+
     if (optind != argc - 1) {
         error_exit("Expecting one image file name");
     }
@@ -4698,6 +4835,11 @@ static int img_bench(int argc, char **argv)
         ret = image_size;
         goto out;
     }
+    if (random && image_size < bufsize) {
+        error_report("Image is smaller than the buffer size");
+        ret = -1;
+        goto out;
+    }
 
     data = (BenchData) {
         .blk            = blk,
@@ -4707,21 +4849,40 @@ static int img_bench(int argc, char **argv)
         .nrreq          = depth,
         .n              = count,
         .offset         = offset,
-        .write          = is_write,
+        .write_ratio    = write_ratio,
+        .random         = random,
+        .rand           = g_rand_new_with_seed(0),
         .flush_interval = flush_interval,
         .drain_on_flush = drain_on_flush,
+        .lat            = g_new(int64_t, count),
     };
-    printf("Sending %d %s requests, %d bytes each, %d in parallel "
-           "(starting at offset %" PRId64 ", step size %d)\n",
-           data.n, data.write ? "write" : "read", data.bufsize, data.nrreq,
-           data.offset, data.step);
-    if (flush_interval) {
-        printf("Sending flush every %d requests\n", flush_interval);
+    if (output_format == OFORMAT_HUMAN) {
+        const char *kind = write_ratio == 100 ? "write" :
+                           write_ratio ? "mixed" : "read";
+
+        if (random) {
+            printf("Sending %d random %s requests, %d bytes each, "
+                   "%d in parallel\n",
+                   data.n, kind, data.bufsize, data.nrreq);
+        } else {
+            printf("Sending %d %s requests, %d bytes each, %d in parallel "
+                   "(starting at offset %" PRId64 ", step size %d)\n",
+                   data.n, kind, data.bufsize, data.nrreq,
+                   data.offset, data.step);
+        }
+        if (write_ratio && write_ratio != 100) {
+            printf("Writing %d%% of requests\n", write_ratio);
+        }
+        if (flush_interval) {
+            printf("Sending flush every %d requests\n", flush_interval);
+        }
     }
 
-    buf_size = data.nrreq * data.bufsize;
+    /* Mixed mode reads go to one more buffer after the write buffers */
+    mixed = write_ratio && write_ratio != 100;
+    buf_size = (data.nrreq + mixed) * data.bufsize;
     data.buf = blk_blockalign(blk, buf_size);
-    memset(data.buf, pattern, data.nrreq * data.bufsize);
+    memset(data.buf, pattern, buf_size);
 
     blk_register_buf(blk, data.buf, buf_size, &error_fatal);
 
@@ -4731,6 +4892,14 @@ static int img_bench(int argc, char **argv)
         qemu_iovec_add(&data.qiov[i],
                        data.buf + i * data.bufsize, data.bufsize);
     }
+    if (mixed) {
+        qemu_iovec_init(&read_qiov, 1);
+        qemu_iovec_add(&read_qiov, data.buf + data.nrreq * data.bufsize,
+                       data.bufsize);
+        data.read_qiov = &read_qiov;
+    } else {
+        data.read_qiov = data.qiov;
+    }
 
     gettimeofday(&t1, NULL);
     bench_cb(&data, 0);
@@ -4740,15 +4909,19 @@ static int img_bench(int argc, char **argv)
     }
     gettimeofday(&t2, NULL);
 
-    printf("Run completed in %3.3f seconds.\n",
-           (t2.tv_sec - t1.tv_sec)
-           + ((double)(t2.tv_usec - t1.tv_usec) / 1000000));
+    secs = (t2.tv_sec - t1.tv_sec)
+           + ((double)(t2.tv_usec - t1.tv_usec) / 1000000);
+    bench_report(&data, count, secs, output_format);
 
 out:
     if (data.buf) {
         blk_unregister_buf(blk, data.buf, buf_size);
     }
     qemu_vfree(data.buf);
+    g_free(data.lat);
+    if (data.rand) {
+        g_rand_free(data.rand);
+    }
     blk_unref(blk);
 
     if (ret) {
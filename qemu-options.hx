@@ -3557,6 +3557,7 @@ DEF("chardev", HAS_ARG, QEMU_OPTION_chardev,
     "-chardev vc,id=id[[,width=width][,height=height]][[,cols=cols][,rows=rows]]\n"
     "         [,mux=on|off][,logfile=PATH][,logappend=on|off]\n"
     "-chardev ringbuf,id=id[,size=size][,logfile=PATH][,logappend=on|off]\n"
+    "-chardev buffered-file,id=id,path=path[,size=size][,append=on|off][,logfile=PATH][,logappend=on|off]\n"
     "-chardev file,id=id,path=path[,input-path=input-file][,mux=on|off][,logfile=PATH][,logappend=on|off]\n"
     "-chardev pipe,id=id,path=path[,mux=on|off][,logfile=PATH][,logappend=on|off]\n"
 #ifdef _WIN32
@@ -3760,6 +3761,14 @@ The available backends are:
     Create a ring buffer with fixed size ``size``. size must be a power
     of two and defaults to ``64K``.
 
+``-chardev buffered-file,id=id,path=path[,size=size][,append=on|off]``
+    Log all traffic received from the guest to a file without ever
+    blocking the guest. Output is queued in a ring buffer of ``size``
+    bytes (a power of two, default ``1M``) and written to ``path`` by a
+    background thread; output that arrives while the ring is full is
+    dropped. The file is truncated unless ``append`` is on. This suits
+    high-volume consoles whose output must not slow down the guest.
+
 ``-chardev file,id=id,path=path[,input-path=input-path]``
     Log all traffic received from the guest to a file.
 
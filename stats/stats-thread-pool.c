@@ -0,0 +1,92 @@
+/*
+ * query-stats provider for the AioContext thread pools
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * (at your option) any later version.
+ */
+
+#include "qemu/osdep.h"
+#include "block/thread-pool.h"
+#include "qemu/module.h"
+#include "sysemu/stats.h"
+
+typedef struct ThreadPoolStatsDesc {
+    const char *name;
+    StatsType type;
+    /* wait time is kept in nanoseconds */
+    bool ns;
+    size_t offset;
+} ThreadPoolStatsDesc;
+
+static const ThreadPoolStatsDesc thread_pool_stats[] = {
+    { "requests", STATS_TYPE_CUMULATIVE, false,
+      offsetof(ThreadPoolStats, requests) },
+    { "wait-time", STATS_TYPE_CUMULATIVE, true,
+      offsetof(ThreadPoolStats, wait_ns) },
+    { "queue-depth", STATS_TYPE_INSTANT, false,
+      offsetof(ThreadPoolStats, queue_depth) },
+    { "workers", STATS_TYPE_INSTANT, false,
+      offsetof(ThreadPoolStats, workers) },
+};
+
+static void thread_pool_query_stats(StatsResultList **result,
+                                    StatsTarget target, strList *names,
+                                    strList *targets, Error **errp)
+{
+    StatsList *stats_list = NULL;
+    ThreadPoolStats tps;
+
+    if (target != STATS_TARGET_VM) {
+        return;
+    }
+
+    thread_pool_get_stats(&tps);
+    for (int i = 0; i < ARRAY_SIZE(thread_pool_stats); i++) {
+        Stats *stats;
+
+        if (!apply_str_list_filter(thread_pool_stats[i].name, names)) {
+            continue;
+        }
+        stats = g_new0(Stats, 1);
+        stats->name = g_strdup(thread_pool_stats[i].name);
+        stats->value = g_new0(StatsValue, 1);
+        stats->value->type = QTYPE_QNUM;
+        stats->value->u.scalar =
+            *(uint64_t *)((char *)&tps + thread_pool_stats[i].offset);
+        QAPI_LIST_PREPEND(stats_list, stats);
+    }
+    if (stats_list) {
+        add_stats_entry(result, STATS_PROVIDER_THREAD_POOL, NULL, stats_list);
+    }
+}
+
+static void thread_pool_query_stats_schemas(StatsSchemaList **result,
+                                            Error **errp)
+{
+    StatsSchemaValueList *list = NULL;
+
+    for (int i = 0; i < ARRAY_SIZE(thread_pool_stats); i++) {
+        StatsSchemaValue *value = g_new0(StatsSchemaValue, 1);
+
+        value->name = g_strdup(thread_pool_stats[i].name);
+        value->type = thread_pool_stats[i].type;
+        if (thread_pool_stats[i].ns) {
+            value->has_unit = true;
+            value->unit = STATS_UNIT_SECONDS;
+            value->has_base = true;
+            value->base = 10;
+            value->exponent = -9;
+        }
+        QAPI_LIST_PREPEND(list, value);
+    }
+    add_stats_schema(result, STATS_PROVIDER_THREAD_POOL, STATS_TARGET_VM,
+                     list);
+}
+
+static void thread_pool_stats_register(void)
+{
+    add_stats_callbacks(STATS_PROVIDER_THREAD_POOL, thread_pool_query_stats,
+                        thread_pool_query_stats_schemas);
+}
+
+type_init(thread_pool_stats_register);
@@ -100,6 +100,31 @@ int64_t cpu_get_clock(void)
     return ti;
 }
 
+int64_t cpu_clock_warp(int64_t max_ns)
+{
+    int64_t deadline = qemu_clock_deadline_ns_all(QEMU_CLOCK_VIRTUAL,
+                                                  QEMU_TIMER_ATTR_ALL);
+    int64_t delta = max_ns;
+
+    if (icount_enabled() || !timers_state.cpu_ticks_enabled) {
+        return 0;
+    }
+    if (deadline >= 0) {
+        delta = MIN(delta, deadline);
+    }
+    if (delta <= 0) {
+        return 0;
+    }
+
+    seqlock_write_lock(&timers_state.vm_clock_seqlock,
+                       &timers_state.vm_clock_lock);
+    timers_state.cpu_clock_offset += delta;
+    seqlock_write_unlock(&timers_state.vm_clock_seqlock,
+                         &timers_state.vm_clock_lock);
+    qemu_clock_notify(QEMU_CLOCK_VIRTUAL);
+    return delta;
+}
+
 /*
  * enable cpu_get_ticks()
  * Caller must hold BQL which serves as mutex for vm_clock_seqlock.
@@ -22,6 +22,8 @@
 #include "qemu/error-report.h"
 #include "qemu/main-loop.h"
 #include "qemu/qemu-print.h"
+#include "qemu/thread.h"
+#include "qemu/timer.h"
 #include "qom/object.h"
 #include "trace.h"
 
@@ -631,6 +633,27 @@ static void render_memory_region(FlatView *view,
 
     clip = addrrange_intersection(tmp, clip);
 
+    if (mr->alias && mr->alias_repeat) {
+        /* Render only the copies that intersect the clip window. */
+        Int128 period = int128_make64(mr->alias_repeat);
+        Int128 copy = int128_sub(clip.start, base);
+        uint64_t first = int128_get64(copy) / mr->alias_repeat;
+
+        copy = int128_add(base, int128_make64(first * mr->alias_repeat));
+        while (int128_lt(copy, addrrange_end(clip))) {
+            AddrRange win = addrrange_intersection(addrrange_make(copy, period),
+                                                   clip);
+            Int128 alias_base = copy;
+
+            int128_subfrom(&alias_base, int128_make64(mr->alias->addr));
+            int128_subfrom(&alias_base, int128_make64(mr->alias_offset));
+            render_memory_region(view, mr->alias, alias_base, win,
+                                 readonly, nonvolatile, unmergeable);
+            int128_addto(&copy, period);
+        }
+        return;
+    }
+
     if (mr->alias) {
         int128_subfrom(&base, int128_make64(mr->alias->addr));
         int128_subfrom(&base, int128_make64(mr->alias_offset));
@@ -709,7 +732,8 @@ static MemoryRegion *memory_region_get_flatview_root(MemoryRegion *mr)
 {
     while (mr->enabled) {
         if (mr->alias) {
-            if (!mr->alias_offset && int128_ge(mr->size, mr->alias->size)) {
+            if (!mr->alias_offset && !mr->alias_repeat &&
+                int128_ge(mr->size, mr->alias->size)) {
                 /* The alias is included in its entirety.  Use it as
                  * the "real" root, so that we can share more FlatViews.
                  */
@@ -1414,6 +1438,254 @@ bool memory_region_access_valid(MemoryRegion *mr,
     return true;
 }
 
+/*
+ * MMIO profiling.  Each thread dispatching MMIO (normally a vCPU) keeps
+ * its own table of counters keyed by region and offset, so accounting
+ * never contends with other vCPUs; the per-table lock is only shared
+ * with whoever reads or resets the profile.
+ */
+typedef struct MMIOProfileKey {
+    const MemoryRegion *mr;
+    hwaddr addr;
+} MMIOProfileKey;
+
+typedef struct MMIOProfileEntry {
+    MMIOProfileKey key;
+    char *name;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t ns;
+} MMIOProfileEntry;
+
+typedef struct MMIOProfileTable {
+    QemuSpin lock;
+    GHashTable *entries;
+    QSLIST_ENTRY(MMIOProfileTable) next;
+} MMIOProfileTable;
+
+static bool mmio_profile_on;
+static QemuSpin mmio_profile_tables_lock;
+static QSLIST_HEAD(, MMIOProfileTable) mmio_profile_tables;
+static __thread MMIOProfileTable *mmio_profile_table;
+
+static void __attribute__((constructor)) mmio_profile_init(void)
+{
+    qemu_spin_init(&mmio_profile_tables_lock);
+}
+
+static guint mmio_profile_key_hash(gconstpointer p)
+{
+    const MMIOProfileKey *k = p;
+
+    return g_direct_hash(k->mr) ^ g_int64_hash(&k->addr);
+}
+
+static gboolean mmio_profile_key_equal(gconstpointer a, gconstpointer b)
+{
+    const MMIOProfileKey *ka = a, *kb = b;
+
+    return ka->mr == kb->mr && ka->addr == kb->addr;
+}
+
+static void mmio_profile_entry_free(gpointer p)
+{
+    MMIOProfileEntry *e = p;
+
+    g_free(e->name);
+    g_free(e);
+}
+
+static GHashTable *mmio_profile_entries_new(void)
+{
+    return g_hash_table_new_full(mmio_profile_key_hash, mmio_profile_key_equal,
+                                 NULL, mmio_profile_entry_free);
+}
+
+static inline int64_t mmio_profile_start(void)
+{
+    return unlikely(qatomic_read(&mmio_profile_on)) ? get_clock() : 0;
+}
+
+static void mmio_profile_account(MemoryRegion *mr, hwaddr addr,
+                                 bool is_write, int64_t start)
+{
+    MMIOProfileTable *t = mmio_profile_table;
+    MMIOProfileKey key = { .mr = mr, .addr = addr };
+    MMIOProfileEntry *e;
+    int64_t ns = get_clock() - start;
+
+    if (!t) {
+        t = g_new0(MMIOProfileTable, 1);
+        qemu_spin_init(&t->lock);
+        t->entries = mmio_profile_entries_new();
+        qemu_spin_lock(&mmio_profile_tables_lock);
+        QSLIST_INSERT_HEAD(&mmio_profile_tables, t, next);
+        qemu_spin_unlock(&mmio_profile_tables_lock);
+        mmio_profile_table = t;
+    }
+
+    qemu_spin_lock(&t->lock);
+    e = g_hash_table_lookup(t->entries, &key);
+    if (!e) {
+        /* Dropped by mmio_profile_forget() when the region goes away */
+        e = g_new0(MMIOProfileEntry, 1);
+        e->key = key;
+        e->name = g_strdup(memory_region_name(mr));
+        g_hash_table_insert(t->entries, &e->key, e);
+    }
+    if (is_write) {
+        e->writes++;
+    } else {
+        e->reads++;
+    }
+    e->ns += ns;
+    qemu_spin_unlock(&t->lock);
+}
+
+bool mmio_profile_is_enabled(void)
+{
+    return qatomic_read(&mmio_profile_on);
+}
+
+void mmio_profile_enable(bool enable)
+{
+    qatomic_set(&mmio_profile_on, enable);
+}
+
+void mmio_profile_reset(void)
+{
+    MMIOProfileTable *t;
+
+    qemu_spin_lock(&mmio_profile_tables_lock);
+    QSLIST_FOREACH(t, &mmio_profile_tables, next) {
+        qemu_spin_lock(&t->lock);
+        g_hash_table_remove_all(t->entries);
+        qemu_spin_unlock(&t->lock);
+    }
+    qemu_spin_unlock(&mmio_profile_tables_lock);
+}
+
+static gboolean mmio_profile_entry_is_mr(gpointer key, gpointer value,
+                                         gpointer mr)
+{
+    const MMIOProfileKey *k = key;
+
+    return k->mr == mr;
+}
+
+/*
+ * Entries are keyed by region pointer, drop those of a region being
+ * freed so that a region allocated at the same address starts afresh.
+ */
+static void mmio_profile_forget(MemoryRegion *mr)
+{
+    MMIOProfileTable *t;
+
+    qemu_spin_lock(&mmio_profile_tables_lock);
+    QSLIST_FOREACH(t, &mmio_profile_tables, next) {
+        qemu_spin_lock(&t->lock);
+        g_hash_table_foreach_remove(t->entries, mmio_profile_entry_is_mr, mr);
+        qemu_spin_unlock(&t->lock);
+    }
+    qemu_spin_unlock(&mmio_profile_tables_lock);
+}
+
+static gint mmio_profile_cmp_ns(gconstpointer a, gconstpointer b)
+{
+    const MMIOProfileEntry *ea = *(MMIOProfileEntry * const *)a;
+    const MMIOProfileEntry *eb = *(MMIOProfileEntry * const *)b;
+
+    return ea->ns < eb->ns ? 1 : ea->ns > eb->ns ? -1 : 0;
+}
+
+/* Offsets listed under each region, busiest first */
+#define MMIO_PROFILE_MAX_OFFSETS 8
+
+GString *mmio_profile_format(void)
+{
+    g_autoptr(GHashTable) offsets = mmio_profile_entries_new();
+    g_autoptr(GHashTable) regions = mmio_profile_entries_new();
+    g_autoptr(GPtrArray) sorted_regions = g_ptr_array_new();
+    g_autoptr(GPtrArray) sorted_offsets = g_ptr_array_new();
+    GString *buf = g_string_new("");
+    MMIOProfileTable *t;
+    GHashTableIter iter;
+    MMIOProfileEntry *e;
+
+    /* Sum up the per-thread tables, by offset and by region */
+    qemu_spin_lock(&mmio_profile_tables_lock);
+    QSLIST_FOREACH(t, &mmio_profile_tables, next) {
+        qemu_spin_lock(&t->lock);
+        g_hash_table_iter_init(&iter, t->entries);
+        while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&e)) {
+            MMIOProfileKey rkey = { .mr = e->key.mr };
+            MMIOProfileEntry *o = g_hash_table_lookup(offsets, &e->key);
+            MMIOProfileEntry *r = g_hash_table_lookup(regions, &rkey);
+
+            if (!o) {
+                o = g_new0(MMIOProfileEntry, 1);
+                o->key = e->key;
+                o->name = g_strdup(e->name);
+                g_hash_table_insert(offsets, &o->key, o);
+            }
+            if (!r) {
+                r = g_new0(MMIOProfileEntry, 1);
+                r->key = rkey;
+                r->name = g_strdup(e->name);
+                g_hash_table_insert(regions, &r->key, r);
+            }
+            o->reads += e->reads;
+            o->writes += e->writes;
+            o->ns += e->ns;
+            r->reads += e->reads;
+            r->writes += e->writes;
+            r->ns += e->ns;
+        }
+        qemu_spin_unlock(&t->lock);
+    }
+    qemu_spin_unlock(&mmio_profile_tables_lock);
+
+    g_string_append_printf(buf, "MMIO profile is %s, %u regions accessed\n",
+                           mmio_profile_is_enabled() ? "on" : "off",
+                           g_hash_table_size(regions));
+
+    g_hash_table_iter_init(&iter, regions);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&e)) {
+        g_ptr_array_add(sorted_regions, e);
+    }
+    g_ptr_array_sort(sorted_regions, mmio_profile_cmp_ns);
+    g_hash_table_iter_init(&iter, offsets);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&e)) {
+        g_ptr_array_add(sorted_offsets, e);
+    }
+    g_ptr_array_sort(sorted_offsets, mmio_profile_cmp_ns);
+
+    for (guint i = 0; i < sorted_regions->len; i++) {
+        MMIOProfileEntry *r = g_ptr_array_index(sorted_regions, i);
+        unsigned shown = 0;
+
+        g_string_append_printf(buf, "  %s: %" PRIu64 " reads, %" PRIu64
+                               " writes, %" PRIu64 " us, %" PRIu64 " ns/access\n",
+                               r->name, r->reads, r->writes, r->ns / 1000,
+                               r->ns / MAX(r->reads + r->writes, 1));
+        for (guint j = 0; j < sorted_offsets->len &&
+                          shown < MMIO_PROFILE_MAX_OFFSETS; j++) {
+            MMIOProfileEntry *o = g_ptr_array_index(sorted_offsets, j);
+
+            if (o->key.mr != r->key.mr) {
+                continue;
+            }
+            g_string_append_printf(buf, "    +0x%" HWADDR_PRIx ": %" PRIu64
+                                   " reads, %" PRIu64 " writes, %" PRIu64
+                                   " us\n", o->key.addr, o->reads, o->writes,
+                                   o->ns / 1000);
+            shown++;
+        }
+    }
+
+    return buf;
+}
+
 static MemTxResult memory_region_dispatch_read1(MemoryRegion *mr,
                                                 hwaddr addr,
                                                 uint64_t *pval,
@@ -1445,8 +1717,12 @@ MemTxResult memory_region_dispatch_read(MemoryRegion *mr,
 {
     unsigned size = memop_size(op);
     MemTxResult r;
+    int64_t start;
 
     if (mr->alias) {
+        if (mr->alias_repeat) {
+            addr %= mr->alias_repeat;
+        }
         return memory_region_dispatch_read(mr->alias,
                                            mr->alias_offset + addr,
                                            pval, op, attrs);
@@ -1456,7 +1732,11 @@ MemTxResult memory_region_dispatch_read(MemoryRegion *mr,
         return MEMTX_DECODE_ERROR;
     }
 
+    start = mmio_profile_start();
     r = memory_region_dispatch_read1(mr, addr, pval, size, attrs);
+    if (unlikely(start)) {
+        mmio_profile_account(mr, addr, false, start);
+    }
     adjust_endianness(mr, pval, op);
     return r;
 }
@@ -1494,8 +1774,13 @@ MemTxResult memory_region_dispatch_write(MemoryRegion *mr,
                                          MemTxAttrs attrs)
 {
     unsigned size = memop_size(op);
+    MemTxResult r;
+    int64_t start;
 
     if (mr->alias) {
+        if (mr->alias_repeat) {
+            addr %= mr->alias_repeat;
+        }
         return memory_region_dispatch_write(mr->alias,
                                             mr->alias_offset + addr,
                                             data, op, attrs);
@@ -1517,20 +1802,24 @@ MemTxResult memory_region_dispatch_write(MemoryRegion *mr,
         return MEMTX_OK;
     }
 
+    start = mmio_profile_start();
     if (mr->ops->write) {
-        return access_with_adjusted_size(addr, &data, size,
-                                         mr->ops->impl.min_access_size,
-                                         mr->ops->impl.max_access_size,
-                                         memory_region_write_accessor, mr,
-                                         attrs);
+        r = access_with_adjusted_size(addr, &data, size,
+                                      mr->ops->impl.min_access_size,
+                                      mr->ops->impl.max_access_size,
+                                      memory_region_write_accessor, mr,
+                                      attrs);
     } else {
-        return
-            access_with_adjusted_size(addr, &data, size,
+        r = access_with_adjusted_size(addr, &data, size,
                                       mr->ops->impl.min_access_size,
                                       mr->ops->impl.max_access_size,
                                       memory_region_write_with_attrs_accessor,
                                       mr, attrs);
     }
+    if (unlikely(start)) {
+        mmio_profile_account(mr, addr, true, start);
+    }
+    return r;
 }
 
 void memory_region_init_io(MemoryRegion *mr,
@@ -1707,6 +1996,19 @@ void memory_region_init_alias(MemoryRegion *mr,
     mr->alias_offset = offset;
 }
 
+void memory_region_init_alias_repeat(MemoryRegion *mr,
+                                     Object *owner,
+                                     const char *name,
+                                     MemoryRegion *orig,
+                                     hwaddr offset,
+                                     uint64_t period,
+                                     uint64_t size)
+{
+    assert(period);
+    memory_region_init_alias(mr, owner, name, orig, offset, size);
+    mr->alias_repeat = period;
+}
+
 bool memory_region_init_rom_nomigrate(MemoryRegion *mr,
                                       Object *owner,
                                       const char *name,
@@ -1789,6 +2091,7 @@ static void memory_region_finalize(Object *obj)
 
     mr->destructor(mr);
     memory_region_clear_coalescing(mr);
+    mmio_profile_forget(mr);
     g_free((char *)mr->name);
     g_free(mr->ioeventfds);
 }
@@ -2548,6 +2851,12 @@ void memory_region_set_flush_coalesced(MemoryRegion *mr)
     mr->flush_coalesced_mmio = true;
 }
 
+void memory_region_enable_lockless_io(MemoryRegion *mr)
+{
+    assert(!mr->flush_coalesced_mmio);
+    mr->lockless_io = true;
+}
+
 void memory_region_clear_flush_coalesced(MemoryRegion *mr)
 {
     qemu_flush_coalesced_mmio_buffer();
@@ -2641,6 +2641,9 @@ bool prepare_mmio_access(MemoryRegion *mr)
 {
     bool release_lock = false;
 
+    if (mr->lockless_io) {
+        return false;
+    }
     if (!bql_locked()) {
         bql_lock();
         release_lock = true;
@@ -220,7 +220,7 @@ void runstate_set(RunState new_state)
         abort();
     }
 
-    current_run_state = new_state;
+    qatomic_set(&current_run_state, new_state);
 }
 
 RunState runstate_get(void)
@@ -242,9 +242,11 @@ bool runstate_needs_reset(void)
 StatusInfo *qmp_query_status(Error **errp)
 {
     StatusInfo *info = g_malloc0(sizeof(*info));
+    /* May run out-of-band, without the BQL that runstate_set() holds */
+    RunState state = qatomic_read(&current_run_state);
 
-    info->running = runstate_is_running();
-    info->status = current_run_state;
+    info->running = state == RUN_STATE_RUNNING;
+    info->status = state;
 
     return info;
 }
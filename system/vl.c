@@ -2695,23 +2695,39 @@ static bool qemu_machine_creation_done(Error **errp)
     return true;
 }
 
+/* Report the time spent in a startup phase; returns the new start time */
+static int64_t startup_phase_done(const char *phase, int64_t start)
+{
+    int64_t now = g_get_monotonic_time();
+
+    trace_startup_phase_done(phase, now - start);
+    return now;
+}
+
 void qmp_x_exit_preconfig(Error **errp)
 {
+    int64_t start;
+
     if (phase_check(PHASE_MACHINE_INITIALIZED)) {
         error_setg(errp, "The command is permitted only before machine initialization");
         return;
     }
 
+    start = g_get_monotonic_time();
     qemu_init_board();
+    start = startup_phase_done("board", start);
     qemu_create_cli_devices();
+    start = startup_phase_done("devices", start);
     if (!qemu_machine_creation_done(errp)) {
         return;
     }
+    start = startup_phase_done("creation-done", start);
 
     if (loadvm) {
         RunState state = autostart ? RUN_STATE_RUNNING : runstate_get();
         load_snapshot(loadvm, NULL, false, NULL, &error_fatal);
         load_snapshot_resume(state);
+        startup_phase_done("loadvm", start);
     }
     if (replay_mode != REPLAY_MODE_NONE) {
         replay_vmstate_init();
@@ -134,6 +134,7 @@ typedef struct mips_def_t mips_def_t;
 #define MIPS_DSP_ACC 4
 #define MIPS_KSCRATCH_NUM 6
 #define MIPS_MAAR_MAX 16 /* Must be an even number. */
+#define MIPS_UNMAPPED_WINDOWS 2
 
 
 /*
@@ -1188,6 +1189,13 @@ typedef struct CPUArchState {
         AddressSpace as;
         MemoryRegion mr;
     } iocsr;
+
+    /* Board-provided identity-mapped windows (e.g. on-chip SRAM) */
+    struct {
+        target_ulong base;
+        target_ulong size;
+    } unmapped_window[MIPS_UNMAPPED_WINDOWS];
+    int nb_unmapped_windows;
 #endif
 
     const mips_def_t *cpu_model;
@@ -1356,6 +1364,8 @@ uint64_t cpu_mips_phys_to_kseg1(void *opaque, uint64_t addr);
 void cpu_mips_soft_irq(CPUMIPSState *env, int irq, int level);
 void cpu_mips_irq_init_cpu(MIPSCPU *cpu);
 void cpu_mips_clock_init(MIPSCPU *cpu);
+void cpu_mips_add_unmapped_window(CPUMIPSState *env, target_ulong base,
+                                  target_ulong size);
 
 #endif /* !CONFIG_USER_ONLY */
 
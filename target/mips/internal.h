@@ -138,9 +138,19 @@ struct r4k_tlb_t {
     uint64_t PFN[2];
 };
 
+#define MIPS_TLB_HASH_BITS 8
+#define MIPS_TLB_HASH_SIZE (1 << MIPS_TLB_HASH_BITS)
+
 struct CPUMIPSTLBContext {
     uint32_t nb_tlb;
     uint32_t tlb_in_use;
+    /*
+     * Index + 1 of the last r4k entry matched for a (VPN2, ASID/MMID) hash,
+     * 0 if empty.  Hits are re-validated, so TLB writes need no flush.
+     */
+    uint8_t lookup_hash[MIPS_TLB_HASH_SIZE];
+    uint64_t lookups;
+    uint64_t misses;
     int (*map_address)(CPUMIPSState *env, hwaddr *physical, int *prot,
                        target_ulong address, MMUAccessType access_type);
     void (*helper_tlbwi)(CPUMIPSState *env);
@@ -112,6 +112,26 @@ static int get_segctl_physical_address(CPUMIPSState *env, hwaddr *physical,
                                     pa & ~(hwaddr)segmask);
 }
 
+void cpu_mips_add_unmapped_window(CPUMIPSState *env, target_ulong base,
+                                  target_ulong size)
+{
+    assert(env->nb_unmapped_windows < MIPS_UNMAPPED_WINDOWS);
+    env->unmapped_window[env->nb_unmapped_windows].base = base;
+    env->unmapped_window[env->nb_unmapped_windows].size = size;
+    env->nb_unmapped_windows++;
+}
+
+static bool is_unmapped_window(CPUMIPSState *env, target_ulong address)
+{
+    for (int i = 0; i < env->nb_unmapped_windows; i++) {
+        if (address - env->unmapped_window[i].base <
+            env->unmapped_window[i].size) {
+            return true;
+        }
+    }
+    return false;
+}
+
 int get_physical_address(CPUMIPSState *env, hwaddr *physical,
                          int *prot, target_ulong real_address,
                          MMUAccessType access_type, int mmu_idx)
@@ -201,10 +221,9 @@ int get_physical_address(CPUMIPSState *env, hwaddr *physical,
             ret = TLBRET_BADADDR;
         }
 #endif
-    } else if ((env->insn_flags == (CPU_MIPS32R1 | ASE_MXU)) && (
-        ((address >= 0xA0000000) && (address < 0xA0004000)) ||
-        ((address >= 0xF4000000) && (address < 0xF4010000)))) {
-        /* Ingenic internal SRAM */
+    } else if (unlikely(env->nb_unmapped_windows) &&
+               is_unmapped_window(env, address)) {
+        /* Board-provided window, e.g. Ingenic internal SRAM */
         ret = get_segctl_physical_address(env, physical, prot, real_address,
                                           access_type, mmu_idx,
                                           env->CP0_SegCtl1 >> 16, 0xFFFFFFFF);
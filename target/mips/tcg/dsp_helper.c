@@ -1152,8 +1152,6 @@ MIPSDSP32_BINOP(addqh_ph, rshift1_add_q16, sh);
 MIPSDSP32_BINOP(addqh_r_ph, rrshift1_add_q16, sh);
 MIPSDSP32_BINOP(addqh_r_w, rrshift1_add_q32, sw);
 MIPSDSP32_BINOP(addqh_w, rshift1_add_q32, sw);
-MIPSDSP32_BINOP(adduh_qb, rshift1_add_u8, ub);
-MIPSDSP32_BINOP(adduh_r_qb, rrshift1_add_u8, ub);
 MIPSDSP32_BINOP(subqh_ph, rshift1_sub_q16, sh);
 MIPSDSP32_BINOP(subqh_r_ph, rrshift1_sub_q16, sh);
 MIPSDSP32_BINOP(subqh_r_w, rrshift1_sub_q32, sw);
@@ -3094,16 +3092,6 @@ PICK_INSN(pick_pw, 2, MIPSDSP_LLO, 32, 0);
 #endif
 #undef PICK_INSN
 
-target_ulong helper_packrl_ph(target_ulong rs, target_ulong rt)
-{
-    uint32_t rsl, rth;
-
-    rsl =  rs & MIPSDSP_LO;
-    rth = (rt & MIPSDSP_HI) >> 16;
-
-    return (target_long)(int32_t)((rsl << 16) | rth);
-}
-
 #if defined(TARGET_MIPS64)
 target_ulong helper_packrl_pw(target_ulong rs, target_ulong rt)
 {
@@ -17,6 +17,7 @@
 
 #include "qemu/osdep.h"
 #include "translate.h"
+#include "tcg/tcg-op-gvec.h"
 
 /*
  *
@@ -1990,47 +1991,26 @@ static void gen_mxu_q16sxx(DisasContext *ctx, bool right, bool arithmetic)
 
     TCGv t0 = tcg_temp_new();
     TCGv t1 = tcg_temp_new();
-    TCGv t2 = tcg_temp_new();
-    TCGv t3 = tcg_temp_new();
 
     gen_load_mxu_gpr(t0, XRb);
-    gen_load_mxu_gpr(t2, XRc);
-
-    if (arithmetic) {
-        tcg_gen_sextract_tl(t1, t0, 16, 16);
-        tcg_gen_sextract_tl(t0, t0,  0, 16);
-        tcg_gen_sextract_tl(t3, t2, 16, 16);
-        tcg_gen_sextract_tl(t2, t2,  0, 16);
-    } else {
-        tcg_gen_extract_tl(t1, t0, 16, 16);
-        tcg_gen_extract_tl(t0, t0,  0, 16);
-        tcg_gen_extract_tl(t3, t2, 16, 16);
-        tcg_gen_extract_tl(t2, t2,  0, 16);
-    }
+    gen_load_mxu_gpr(t1, XRc);
 
+    /* Shift both 16-bit lanes of each register at once. */
     if (right) {
         if (arithmetic) {
-            tcg_gen_sari_tl(t0, t0, sft4);
-            tcg_gen_sari_tl(t1, t1, sft4);
-            tcg_gen_sari_tl(t2, t2, sft4);
-            tcg_gen_sari_tl(t3, t3, sft4);
+            tcg_gen_vec_sar16i_tl(t0, t0, sft4);
+            tcg_gen_vec_sar16i_tl(t1, t1, sft4);
         } else {
-            tcg_gen_shri_tl(t0, t0, sft4);
-            tcg_gen_shri_tl(t1, t1, sft4);
-            tcg_gen_shri_tl(t2, t2, sft4);
-            tcg_gen_shri_tl(t3, t3, sft4);
+            tcg_gen_vec_shr16i_tl(t0, t0, sft4);
+            tcg_gen_vec_shr16i_tl(t1, t1, sft4);
         }
     } else {
-        tcg_gen_shli_tl(t0, t0, sft4);
-        tcg_gen_shli_tl(t1, t1, sft4);
-        tcg_gen_shli_tl(t2, t2, sft4);
-        tcg_gen_shli_tl(t3, t3, sft4);
+        tcg_gen_vec_shl16i_tl(t0, t0, sft4);
+        tcg_gen_vec_shl16i_tl(t1, t1, sft4);
     }
-    tcg_gen_deposit_tl(t0, t0, t1, 16, 16);
-    tcg_gen_deposit_tl(t2, t2, t3, 16, 16);
 
     gen_store_mxu_gpr(t0, XRa);
-    gen_store_mxu_gpr(t2, XRd);
+    gen_store_mxu_gpr(t1, XRd);
 }
 
 /*
@@ -2929,43 +2909,38 @@ static void gen_mxu_Q8ADD(DisasContext *ctx)
         /* both operands zero registers -> just set destination to zero */
         tcg_gen_movi_i32(mxu_gpr[XRa - 1], 0);
     } else {
-        /* the most general case */
+        /* the most general case: all four lanes in one packed operation */
         TCGv t0 = tcg_temp_new();
         TCGv t1 = tcg_temp_new();
         TCGv t2 = tcg_temp_new();
-        TCGv t3 = tcg_temp_new();
-        TCGv t4 = tcg_temp_new();
 
-        gen_load_mxu_gpr(t3, XRb);
-        gen_load_mxu_gpr(t4, XRc);
+        gen_load_mxu_gpr(t0, XRb);
+        gen_load_mxu_gpr(t1, XRc);
 
-        for (int i = 0; i < 4; i++) {
-            tcg_gen_andi_tl(t0, t3, 0xff);
-            tcg_gen_andi_tl(t1, t4, 0xff);
-
-            if (i < 2) {
-                if (aptn2 & 0x01) {
-                    tcg_gen_sub_tl(t0, t0, t1);
-                } else {
-                    tcg_gen_add_tl(t0, t0, t1);
-                }
-            } else {
-                if (aptn2 & 0x02) {
-                    tcg_gen_sub_tl(t0, t0, t1);
-                } else {
-                    tcg_gen_add_tl(t0, t0, t1);
-                }
-            }
-            if (i < 3) {
-                tcg_gen_shri_tl(t3, t3, 8);
-                tcg_gen_shri_tl(t4, t4, 8);
-            }
-            if (i > 0) {
-                tcg_gen_deposit_tl(t2, t2, t0, 8 * i, 8);
-            } else {
-                tcg_gen_andi_tl(t0, t0, 0xff);
-                tcg_gen_mov_tl(t2, t0);
+        switch (aptn2) {
+        case MXU_APTN2_AA:
+            tcg_gen_vec_add8_tl(t2, t0, t1);
+            break;
+        case MXU_APTN2_SS:
+            tcg_gen_vec_sub8_tl(t2, t0, t1);
+            break;
+        default:
+            /*
+             * aptn2 bit 0 selects subtraction for the low byte pair,
+             * bit 1 for the high byte pair.
+             */
+            {
+                uint32_t sub_mask = (aptn2 == MXU_APTN2_AS) ? 0x0000ffff
+                                                            : 0xffff0000;
+                TCGv t3 = tcg_temp_new();
+
+                tcg_gen_vec_add8_tl(t2, t0, t1);
+                tcg_gen_vec_sub8_tl(t3, t0, t1);
+                tcg_gen_andi_tl(t2, t2, ~sub_mask);
+                tcg_gen_andi_tl(t3, t3, sub_mask);
+                tcg_gen_or_tl(t2, t2, t3);
             }
+            break;
         }
         gen_store_mxu_gpr(t2, XRa);
     }
@@ -3152,70 +3127,40 @@ static void gen_mxu_q16add(DisasContext *ctx)
     TCGv t1 = tcg_temp_new();
     TCGv t2 = tcg_temp_new();
     TCGv t3 = tcg_temp_new();
-    TCGv t4 = tcg_temp_new();
-    TCGv t5 = tcg_temp_new();
-
-    gen_load_mxu_gpr(t1, XRb);
-    tcg_gen_extract_tl(t0, t1,  0, 16);
-    tcg_gen_extract_tl(t1, t1, 16, 16);
 
-    gen_load_mxu_gpr(t3, XRc);
-    tcg_gen_extract_tl(t2, t3,  0, 16);
-    tcg_gen_extract_tl(t3, t3, 16, 16);
+    gen_load_mxu_gpr(t0, XRb);
+    gen_load_mxu_gpr(t1, XRc);
 
+    /* Arrange XRb so that lop is in the high lane and rop in the low one. */
     switch (optn2) {
     case MXU_OPTN2_WW: /* XRB.H+XRC.H == lop, XRB.L+XRC.L == rop */
-        tcg_gen_mov_tl(t4, t1);
-        tcg_gen_mov_tl(t5, t0);
         break;
     case MXU_OPTN2_LW: /* XRB.L+XRC.H == lop, XRB.L+XRC.L == rop */
-        tcg_gen_mov_tl(t4, t0);
-        tcg_gen_mov_tl(t5, t0);
+        tcg_gen_deposit_tl(t0, t0, t0, 16, 16);
         break;
     case MXU_OPTN2_HW: /* XRB.H+XRC.H == lop, XRB.H+XRC.L == rop */
-        tcg_gen_mov_tl(t4, t1);
-        tcg_gen_mov_tl(t5, t1);
+        tcg_gen_shri_tl(t2, t0, 16);
+        tcg_gen_deposit_tl(t0, t0, t2, 0, 16);
         break;
     case MXU_OPTN2_XW: /* XRB.L+XRC.H == lop, XRB.H+XRC.L == rop */
-        tcg_gen_mov_tl(t4, t0);
-        tcg_gen_mov_tl(t5, t1);
+        tcg_gen_rotli_tl(t0, t0, 16);
         break;
     }
 
-    switch (aptn2) {
-    case MXU_APTN2_AA: /* lop +, rop + */
-        tcg_gen_add_tl(t0, t4, t3);
-        tcg_gen_add_tl(t1, t5, t2);
-        tcg_gen_add_tl(t4, t4, t3);
-        tcg_gen_add_tl(t5, t5, t2);
-        break;
-    case MXU_APTN2_AS: /* lop +, rop + */
-        tcg_gen_sub_tl(t0, t4, t3);
-        tcg_gen_sub_tl(t1, t5, t2);
-        tcg_gen_add_tl(t4, t4, t3);
-        tcg_gen_add_tl(t5, t5, t2);
-        break;
-    case MXU_APTN2_SA: /* lop +, rop + */
-        tcg_gen_add_tl(t0, t4, t3);
-        tcg_gen_add_tl(t1, t5, t2);
-        tcg_gen_sub_tl(t4, t4, t3);
-        tcg_gen_sub_tl(t5, t5, t2);
-        break;
-    case MXU_APTN2_SS: /* lop +, rop + */
-        tcg_gen_sub_tl(t0, t4, t3);
-        tcg_gen_sub_tl(t1, t5, t2);
-        tcg_gen_sub_tl(t4, t4, t3);
-        tcg_gen_sub_tl(t5, t5, t2);
-        break;
+    /* aptn2 bit 1 selects subtraction for XRa, bit 0 for XRd. */
+    if (aptn2 & 0x02) {
+        tcg_gen_vec_sub16_tl(t2, t0, t1);
+    } else {
+        tcg_gen_vec_add16_tl(t2, t0, t1);
+    }
+    if (aptn2 & 0x01) {
+        tcg_gen_vec_sub16_tl(t3, t0, t1);
+    } else {
+        tcg_gen_vec_add16_tl(t3, t0, t1);
     }
 
-    tcg_gen_shli_tl(t0, t0, 16);
-    tcg_gen_extract_tl(t1, t1, 0, 16);
-    tcg_gen_shli_tl(t4, t4, 16);
-    tcg_gen_extract_tl(t5, t5, 0, 16);
-
-    tcg_gen_or_tl(mxu_gpr[XRa - 1], t4, t5);
-    tcg_gen_or_tl(mxu_gpr[XRd - 1], t0, t1);
+    gen_store_mxu_gpr(t2, XRa);
+    gen_store_mxu_gpr(t3, XRd);
 }
 
 /*
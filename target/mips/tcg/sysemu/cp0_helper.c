@@ -1105,10 +1105,10 @@ void helper_mtc0_entryhi(CPUMIPSState *env, target_ulong arg1)
     if (ase_mt_available(env)) {
         sync_c0_entryhi(env, env->current_tc);
     }
-    /* If the ASID changes, flush qemu's TLB.  */
+    /* If the ASID changes, flush qemu's TLB, but for the unmapped segments */
     if ((old & env->CP0_EntryHi_ASID_mask) !=
         (val & env->CP0_EntryHi_ASID_mask)) {
-        tlb_flush(env_cpu(env));
+        cpu_mips_tlb_flush_mapped(env);
     }
 }
 
@@ -165,6 +165,56 @@ static void r4k_helper_tlbwr(CPUMIPSState *env)
     r4k_fill_tlb(env, r);
 }
 
+static inline unsigned r4k_tlb_hash(CPUMIPSState *env, target_ulong address,
+                                    uint32_t MMID)
+{
+    uint64_t key = (uint64_t)(address >> (TARGET_PAGE_BITS + 1)) ^
+                   ((uint64_t)MMID << 40);
+#if defined(TARGET_MIPS64)
+    key ^= address >> 62;
+#endif
+    return (key * 0x9e3779b97f4a7c15ULL) >> (64 - MIPS_TLB_HASH_BITS);
+}
+
+static inline bool r4k_tlb_match(CPUMIPSState *env, r4k_tlb_t *tlb,
+                                 target_ulong address, uint32_t MMID, bool mi)
+{
+    /* 1k pages are not supported. */
+    target_ulong mask = tlb->PageMask | ~(TARGET_PAGE_MASK << 1);
+    target_ulong tag = address & ~mask;
+    target_ulong VPN = tlb->VPN & ~mask;
+    uint32_t tlb_mmid = mi ? tlb->MMID : (uint32_t) tlb->ASID;
+#if defined(TARGET_MIPS64)
+    tag &= env->SEGMask;
+#endif
+    /* Check ASID/MMID, virtual page number & size */
+    return (tlb->G == 1 || tlb_mmid == MMID) && VPN == tag && !tlb->EHINV;
+}
+
+/*
+ * Find the architectural (non-shadow) entry matching address, or -1.
+ * The hash only remembers architectural entries: shadows may overlap
+ * with them and must never take precedence.
+ */
+static int r4k_tlb_find(CPUMIPSState *env, target_ulong address,
+                        uint32_t MMID, bool mi)
+{
+    unsigned h = r4k_tlb_hash(env, address, MMID);
+    int i = env->tlb->lookup_hash[h] - 1;
+
+    if (i >= 0 && r4k_tlb_match(env, &env->tlb->mmu.r4k.tlb[i],
+                                address, MMID, mi)) {
+        return i;
+    }
+    for (i = 0; i < env->tlb->nb_tlb; i++) {
+        if (r4k_tlb_match(env, &env->tlb->mmu.r4k.tlb[i], address, MMID, mi)) {
+            env->tlb->lookup_hash[h] = i + 1;
+            return i;
+        }
+    }
+    return -1;
+}
+
 static void r4k_helper_tlbp(CPUMIPSState *env)
 {
     bool mi = !!((env->CP0_Config5 >> CP0C5_MI) & 1);
@@ -178,24 +228,11 @@ static void r4k_helper_tlbp(CPUMIPSState *env)
     int i;
 
     MMID = mi ? MMID : (uint32_t) ASID;
-    for (i = 0; i < env->tlb->nb_tlb; i++) {
-        tlb = &env->tlb->mmu.r4k.tlb[i];
-        /* 1k pages are not supported. */
-        mask = tlb->PageMask | ~(TARGET_PAGE_MASK << 1);
-        tag = env->CP0_EntryHi & ~mask;
-        VPN = tlb->VPN & ~mask;
-#if defined(TARGET_MIPS64)
-        tag &= env->SEGMask;
-#endif
-        tlb_mmid = mi ? tlb->MMID : (uint32_t) tlb->ASID;
-        /* Check ASID/MMID, virtual page number & size */
-        if ((tlb->G == 1 || tlb_mmid == MMID) && VPN == tag && !tlb->EHINV) {
-            /* TLB match */
-            env->CP0_Index = i;
-            break;
-        }
-    }
-    if (i == env->tlb->nb_tlb) {
+    i = r4k_tlb_find(env, env->CP0_EntryHi, MMID, mi);
+    if (i >= 0) {
+        /* TLB match */
+        env->CP0_Index = i;
+    } else {
         /* No match.  Discard any shadow entries, if any of them match.  */
         for (i = env->tlb->nb_tlb; i < env->tlb->tlb_in_use; i++) {
             tlb = &env->tlb->mmu.r4k.tlb[i];
@@ -393,51 +430,55 @@ static int r4k_map_address(CPUMIPSState *env, hwaddr *physical, int *prot,
     uint16_t ASID = env->CP0_EntryHi & env->CP0_EntryHi_ASID_mask;
     uint32_t MMID = env->CP0_MemoryMapID;
     bool mi = !!((env->CP0_Config5 >> CP0C5_MI) & 1);
-    uint32_t tlb_mmid;
+    r4k_tlb_t *tlb = NULL;
     int i;
 
     MMID = mi ? MMID : (uint32_t) ASID;
+    env->tlb->lookups++;
 
-    for (i = 0; i < env->tlb->tlb_in_use; i++) {
-        r4k_tlb_t *tlb = &env->tlb->mmu.r4k.tlb[i];
-        /* 1k pages are not supported. */
-        target_ulong mask = tlb->PageMask | ~(TARGET_PAGE_MASK << 1);
-        target_ulong tag = address & ~mask;
-        target_ulong VPN = tlb->VPN & ~mask;
-#if defined(TARGET_MIPS64)
-        tag &= env->SEGMask;
-#endif
-
-        /* Check ASID/MMID, virtual page number & size */
-        tlb_mmid = mi ? tlb->MMID : (uint32_t) tlb->ASID;
-        if ((tlb->G == 1 || tlb_mmid == MMID) && VPN == tag && !tlb->EHINV) {
-            /* TLB match */
-            int n = !!(address & mask & ~(mask >> 1));
-            /* Check access rights */
-            if (!(n ? tlb->V1 : tlb->V0)) {
-                return TLBRET_INVALID;
-            }
-            if (access_type == MMU_INST_FETCH && (n ? tlb->XI1 : tlb->XI0)) {
-                return TLBRET_XI;
-            }
-            if (access_type == MMU_DATA_LOAD && (n ? tlb->RI1 : tlb->RI0)) {
-                return TLBRET_RI;
-            }
-            if (access_type != MMU_DATA_STORE || (n ? tlb->D1 : tlb->D0)) {
-                *physical = tlb->PFN[n] | (address & (mask >> 1));
-                *prot = PAGE_READ;
-                if (n ? tlb->D1 : tlb->D0) {
-                    *prot |= PAGE_WRITE;
-                }
-                if (!(n ? tlb->XI1 : tlb->XI0)) {
-                    *prot |= PAGE_EXEC;
-                }
-                return TLBRET_MATCH;
+    i = r4k_tlb_find(env, address, MMID, mi);
+    if (i >= 0) {
+        tlb = &env->tlb->mmu.r4k.tlb[i];
+    } else {
+        /* Shadow entries keep stale translations alive until flushed */
+        for (i = env->tlb->nb_tlb; i < env->tlb->tlb_in_use; i++) {
+            if (r4k_tlb_match(env, &env->tlb->mmu.r4k.tlb[i],
+                              address, MMID, mi)) {
+                tlb = &env->tlb->mmu.r4k.tlb[i];
+                break;
             }
-            return TLBRET_DIRTY;
         }
     }
-    return TLBRET_NOMATCH;
+    if (!tlb) {
+        env->tlb->misses++;
+        return TLBRET_NOMATCH;
+    }
+
+    /* TLB match */
+    target_ulong mask = tlb->PageMask | ~(TARGET_PAGE_MASK << 1);
+    int n = !!(address & mask & ~(mask >> 1));
+    /* Check access rights */
+    if (!(n ? tlb->V1 : tlb->V0)) {
+        return TLBRET_INVALID;
+    }
+    if (access_type == MMU_INST_FETCH && (n ? tlb->XI1 : tlb->XI0)) {
+        return TLBRET_XI;
+    }
+    if (access_type == MMU_DATA_LOAD && (n ? tlb->RI1 : tlb->RI0)) {
+        return TLBRET_RI;
+    }
+    if (access_type != MMU_DATA_STORE || (n ? tlb->D1 : tlb->D0)) {
+        *physical = tlb->PFN[n] | (address & (mask >> 1));
+        *prot = PAGE_READ;
+        if (n ? tlb->D1 : tlb->D0) {
+            *prot |= PAGE_WRITE;
+        }
+        if (!(n ? tlb->XI1 : tlb->XI0)) {
+            *prot |= PAGE_EXEC;
+        }
+        return TLBRET_MATCH;
+    }
+    return TLBRET_DIRTY;
 }
 
 static void no_mmu_init(CPUMIPSState *env, const mips_def_t *def)
@@ -456,6 +497,11 @@ static void r4k_mmu_init(CPUMIPSState *env, const mips_def_t *def)
 {
     env->tlb->nb_tlb = 1 + ((def->CP0_Config1 >> CP0C1_MMU) & 63);
     env->tlb->map_address = &r4k_map_address;
+    /* Software TLB lookup statistics, for estimating the guest miss rate */
+    object_property_add_uint64_ptr(OBJECT(env_archcpu(env)), "tlb-lookups",
+                                   &env->tlb->lookups, OBJ_PROP_FLAG_READ);
+    object_property_add_uint64_ptr(OBJECT(env_archcpu(env)), "tlb-misses",
+                                   &env->tlb->misses, OBJ_PROP_FLAG_READ);
     env->tlb->helper_tlbwi = r4k_helper_tlbwi;
     env->tlb->helper_tlbwr = r4k_helper_tlbwr;
     env->tlb->helper_tlbp = r4k_helper_tlbp;
@@ -486,10 +532,31 @@ void mmu_init(CPUMIPSState *env, const mips_def_t *def)
     }
 }
 
+void cpu_mips_tlb_flush_mapped(CPUMIPSState *env)
+{
+    CPUState *cs = env_cpu(env);
+    uint16_t idxmap = MAKE_64BIT_MASK(0, NB_MMU_MODES);
+
+    /* Segmentation control can make kseg0/kseg1 mapped */
+    if (env->CP0_Config3 & (1 << CP0C3_SC)) {
+        tlb_flush(cs);
+        return;
+    }
+
+    /*
+     * kseg0 and kseg1 translate the same whatever the ASID and the TLB
+     * contents are, keep their entries so kernels running from kseg0
+     * do not refill them on every context switch.
+     */
+    tlb_flush_range_by_mmuidx(cs, 0, KSEG0_BASE, idxmap, TARGET_LONG_BITS);
+    tlb_flush_range_by_mmuidx(cs, KSEG2_BASE, -KSEG2_BASE, idxmap,
+                              TARGET_LONG_BITS);
+}
+
 void cpu_mips_tlb_flush(CPUMIPSState *env)
 {
     /* Flush qemu's TLB and discard all shadowed entries.  */
-    tlb_flush(env_cpu(env));
+    cpu_mips_tlb_flush_mapped(env);
     env->tlb->tlb_in_use = env->tlb->nb_tlb;
 }
 
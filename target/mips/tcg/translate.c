@@ -2182,6 +2182,59 @@ static void gen_ld(DisasContext *ctx, uint32_t opc,
     }
 }
 
+/*
+ * Compilers emit unaligned word loads as an LWL/LWR pair on the same
+ * base and destination register, covering the same four bytes.  When
+ * the next instruction completes such a pair, translate both as one
+ * unaligned load instead of four memory accesses.
+ *
+ * A fault restarts at the first instruction of the pair, which is safe
+ * because the destination is only written once both halves are loaded.
+ */
+static bool gen_lwlr_pair(CPUMIPSState *env, DisasContext *ctx, uint32_t opc,
+                          int rt, int base, int offset)
+{
+    vaddr next_pc = ctx->base.pc_next + 4;
+    uint32_t next_opc = opc == OPC_LWL ? OPC_LWR : OPC_LWL;
+    int lwl_offset, lwr_offset;
+    uint32_t next;
+    TCGv t0;
+
+    /*
+     * The pair must retire as two instructions for single-stepping,
+     * breakpoints (which limit the TB to one insn), icount and plugins.
+     */
+    if (rt == 0 || rt == base ||
+        ctx->hflags & MIPS_HFLAG_BMASK ||
+        ctx->base.num_insns >= ctx->base.max_insns ||
+        ctx->base.plugin_enabled ||
+        tb_cflags(ctx->base.tb) & CF_USE_ICOUNT ||
+        !is_same_page(&ctx->base, next_pc)) {
+        return false;
+    }
+
+    next = translator_ldl(env, &ctx->base, next_pc);
+    if (MASK_OP_MAJOR(next) != next_opc ||
+        ((next >> 21) & 0x1f) != base || ((next >> 16) & 0x1f) != rt) {
+        return false;
+    }
+
+    lwl_offset = opc == OPC_LWL ? offset : (int16_t)next;
+    lwr_offset = opc == OPC_LWR ? offset : (int16_t)next;
+    if (lwl_offset - lwr_offset != (cpu_is_bigendian(ctx) ? -3 : 3)) {
+        return false;
+    }
+
+    t0 = tcg_temp_new();
+    gen_base_offset_addr(ctx, t0, base, MIN(lwl_offset, lwr_offset));
+    tcg_gen_qemu_ld_tl(t0, t0, ctx->mem_idx, MO_TESL | MO_UNALN);
+    gen_store_gpr(t0, rt);
+
+    /* Consume the second instruction of the pair */
+    ctx->base.pc_next += 4;
+    return true;
+}
+
 /* Store */
 static void gen_st(DisasContext *ctx, uint32_t opc, int rt,
                    int base, int offset)
@@ -11537,6 +11590,38 @@ enum {
     FMT_DWL_L = 2
 };
 
+/*
+ * ADDUH.QB / ADDUH_R.QB: per-byte (a + b) >> 1 without carries between
+ * lanes, as (a & b) + ((a ^ b) >> 1), or (a | b) - ((a ^ b) >> 1) when
+ * rounding.  Neither touches DSPControl, so no helper is needed.
+ */
+static void gen_dsp_adduh_qb(TCGv ret, TCGv a, TCGv b, bool round)
+{
+    TCGv t = tcg_temp_new();
+
+    tcg_gen_xor_tl(t, a, b);
+    tcg_gen_shri_tl(t, t, 1);
+    tcg_gen_andi_tl(t, t, 0x7f7f7f7f);
+    if (round) {
+        tcg_gen_or_tl(ret, a, b);
+        tcg_gen_sub_tl(ret, ret, t);
+    } else {
+        tcg_gen_and_tl(ret, a, b);
+        tcg_gen_add_tl(ret, ret, t);
+    }
+    tcg_gen_ext32s_tl(ret, ret);
+}
+
+/* PACKRL.PH: low half of rs above the high half of rt */
+static void gen_dsp_packrl_ph(TCGv ret, TCGv a, TCGv b)
+{
+    TCGv t = tcg_temp_new();
+
+    tcg_gen_shri_tl(t, b, 16);
+    tcg_gen_deposit_tl(t, t, a, 16, 16);
+    tcg_gen_ext32s_tl(ret, t);
+}
+
 #include "micromips_translate.c.inc"
 
 #include "nanomips_translate.c.inc"
@@ -11607,10 +11692,10 @@ static void gen_mipsdsp_arith(DisasContext *ctx, uint32_t op1, uint32_t op2,
         check_dsp_r2(ctx);
         switch (op2) {
         case OPC_ADDUH_QB:
-            gen_helper_adduh_qb(cpu_gpr[ret], v1_t, v2_t);
+            gen_dsp_adduh_qb(cpu_gpr[ret], v1_t, v2_t, false);
             break;
         case OPC_ADDUH_R_QB:
-            gen_helper_adduh_r_qb(cpu_gpr[ret], v1_t, v2_t);
+            gen_dsp_adduh_qb(cpu_gpr[ret], v1_t, v2_t, true);
             break;
         case OPC_ADDQH_PH:
             gen_helper_addqh_ph(cpu_gpr[ret], v1_t, v2_t);
@@ -12800,7 +12885,7 @@ static void gen_mipsdsp_add_cmp_pick(DisasContext *ctx,
             break;
         case OPC_PACKRL_PH:
             check_dsp(ctx);
-            gen_helper_packrl_ph(cpu_gpr[ret], v1_t, v2_t);
+            gen_dsp_packrl_ph(cpu_gpr[ret], v1_t, v2_t);
             break;
         }
         break;
@@ -14893,6 +14978,11 @@ static bool decode_opc_legacy(CPUMIPSState *env, DisasContext *ctx)
         /* Fallthrough */
     case OPC_LWL:
     case OPC_LWR:
+        if ((op == OPC_LWL || op == OPC_LWR) &&
+            gen_lwlr_pair(env, ctx, op, rt, rs, imm)) {
+            break;
+        }
+        /* Fallthrough */
     case OPC_LB:
     case OPC_LH:
     case OPC_LW:
@@ -15257,6 +15347,37 @@ static bool decode_opc_legacy(CPUMIPSState *env, DisasContext *ctx)
     return true;
 }
 
+/* Include the auto-generated decoder. */
+#include "decode-xburst.c.inc"
+
+static bool trans_muldiv_acc(DisasContext *ctx, arg_acc *a, uint32_t opc)
+{
+    check_insn(ctx, ISA_MIPS_R1);
+    gen_muldiv(ctx, opc, a->ac, a->rs, a->rt);
+    return true;
+}
+
+TRANS(MADD,     trans_muldiv_acc, OPC_MADD);
+TRANS(MADDU,    trans_muldiv_acc, OPC_MADDU);
+TRANS(MSUB,     trans_muldiv_acc, OPC_MSUB);
+TRANS(MSUBU,    trans_muldiv_acc, OPC_MSUBU);
+
+static bool trans_MUL(DisasContext *ctx, arg_r *a)
+{
+    gen_arith(ctx, OPC_MUL, a->rd, a->rs, a->rt);
+    return true;
+}
+
+static bool trans_cl(DisasContext *ctx, arg_r *a, uint32_t opc)
+{
+    check_insn(ctx, ISA_MIPS_R1);
+    gen_cl(ctx, opc, a->rd, a->rs);
+    return true;
+}
+
+TRANS(CLZ,      trans_cl, OPC_CLZ);
+TRANS(CLO,      trans_cl, OPC_CLO);
+
 static void decode_opc(CPUMIPSState *env, DisasContext *ctx)
 {
     /* make sure instructions are on a word boundary */
@@ -15278,6 +15399,15 @@ static void decode_opc(CPUMIPSState *env, DisasContext *ctx)
 
     /* Transition to the auto-generated decoder.  */
 
+    /*
+     * XBurst hot path: common SPECIAL2 instructions, matched before the
+     * MXU decoder which otherwise inspects every SPECIAL2 opcode first.
+     */
+    if ((ctx->insn_flags & ASE_MXU) && decode_xburst(ctx, ctx->opcode)) {
+        ctx->fast_decodes++;
+        return;
+    }
+
     /* Vendor specific extensions */
     if (cpu_supports_isa(env, INSN_R5900) && decode_ext_txx9(ctx, ctx->opcode)) {
         return;
@@ -15325,6 +15455,7 @@ static void mips_tr_init_disas_context(DisasContextBase *dcbase, CPUState *cs)
     ctx->CP0_Config3 = env->CP0_Config3;
     ctx->CP0_Config5 = env->CP0_Config5;
     ctx->btarget = 0;
+    ctx->fast_decodes = 0;
     ctx->kscrexist = (env->CP0_Config4 >> CP0C4_KScrExist) & 0xff;
     ctx->rxi = (env->CP0_Config3 >> CP0C3_RXI) & 1;
     ctx->ie = (env->CP0_Config4 >> CP0C4_IE) & 3;
@@ -15455,6 +15586,9 @@ static void mips_tr_tb_stop(DisasContextBase *dcbase, CPUState *cs)
 {
     DisasContext *ctx = container_of(dcbase, DisasContext, base);
 
+    trace_mips_translate_tb(ctx->base.pc_first, ctx->base.num_insns,
+                            ctx->fast_decodes);
+
     switch (ctx->base.is_jmp) {
     case DISAS_STOP:
         gen_save_pc(ctx->base.pc_next);
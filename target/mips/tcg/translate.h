@@ -51,6 +51,8 @@ typedef struct DisasContext {
     bool abs2008;
     bool mi;
     int gi;
+    /* Instructions of this TB handled by a feature-filtered fast decoder */
+    int fast_decodes;
 } DisasContext;
 
 #define DISAS_STOP       DISAS_TARGET_0
@@ -554,15 +554,32 @@ static int alloc_code_gen_buffer(size_t size, int splitwx, Error **errp)
 static int alloc_code_gen_buffer_anon(size_t size, int prot,
                                       int flags, Error **errp)
 {
+    size_t align = QEMU_VMALLOC_ALIGN;
+    size_t head, tail;
     void *buf;
 
-    buf = mmap(NULL, size, prot, flags, -1, 0);
+    /*
+     * Over-allocate so that the buffer can start on a huge page boundary;
+     * otherwise the MADV_HUGEPAGE request in tcg_region_init can only be
+     * honoured for the aligned middle of the buffer.
+     */
+    buf = mmap(NULL, size + align, prot, flags, -1, 0);
     if (buf == MAP_FAILED) {
         error_setg_errno(errp, errno,
                          "allocate %zu bytes for jit buffer", size);
         return -1;
     }
 
+    head = QEMU_ALIGN_PTR_UP(buf, align) - buf;
+    tail = align - head;
+    if (head) {
+        munmap(buf, head);
+    }
+    if (tail) {
+        munmap(buf + head + size, tail);
+    }
+    buf += head;
+
     region.start_aligned = buf;
     region.total_size = size;
     return prot;
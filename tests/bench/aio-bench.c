@@ -0,0 +1,220 @@
+/*
+ * AioContext, bottom half and thread pool benchmark
+ *
+ * Measures throughput and per-operation latency of the main loop
+ * primitives the block layer relies on.  Every benchmark reports one
+ * JSON object as a TAP comment:
+ *
+ *   # aio-bench {"bench":"bh-oneshot","param":1,"ops":...,"host_ns":...,
+ *                "ops_per_s":...,"p50_ns":...,"p99_ns":...,"max_ns":...}
+ *
+ * Coroutine create/switch costs are covered by the /perf/ cases of
+ * tests/unit/test-coroutine (run with -m perf).
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * (at your option) any later version.  See the COPYING file in the
+ * top-level directory.
+ */
+#include "qemu/osdep.h"
+#include "qapi/error.h"
+#include "qemu/main-loop.h"
+#include "qemu/thread.h"
+#include "qemu/timer.h"
+#include "qemu/coroutine.h"
+#include "block/aio.h"
+#include "block/thread-pool.h"
+
+#define BH_OPS          200000
+#define WAKEUP_OPS      20000
+#define POOL_OPS        20000
+
+static AioContext *ctx;
+
+static int cmp_int64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void report(const char *name, unsigned param, uint64_t ops,
+                   int64_t host_ns, int64_t *lat, size_t nlat)
+{
+    qsort(lat, nlat, sizeof(*lat), cmp_int64);
+    g_test_message("aio-bench {\"bench\":\"%s\",\"param\":%u,"
+                   "\"ops\":%" PRIu64 ",\"host_ns\":%" PRId64 ","
+                   "\"ops_per_s\":%.0f,\"p50_ns\":%" PRId64 ","
+                   "\"p99_ns\":%" PRId64 ",\"max_ns\":%" PRId64 "}",
+                   name, param, ops, host_ns,
+                   ops * 1e9 / MAX(host_ns, 1), lat[nlat / 2],
+                   lat[nlat * 99 / 100], lat[nlat - 1]);
+}
+
+/* Bottom halves scheduled and run from the same thread */
+
+static void bh_count_cb(void *opaque)
+{
+    unsigned *count = opaque;
+
+    (*count)++;
+}
+
+static void bench_bh_oneshot(void)
+{
+    g_autofree int64_t *lat = g_new(int64_t, BH_OPS);
+    unsigned count = 0;
+    int64_t start = get_clock();
+
+    for (unsigned i = 0; i < BH_OPS; i++) {
+        int64_t t0 = get_clock();
+
+        aio_bh_schedule_oneshot(ctx, bh_count_cb, &count);
+        while (count == i) {
+            aio_poll(ctx, true);
+        }
+        lat[i] = get_clock() - t0;
+    }
+    report("bh-oneshot", 1, BH_OPS, get_clock() - start, lat, BH_OPS);
+}
+
+static void bench_bh_reuse(void)
+{
+    g_autofree int64_t *lat = g_new(int64_t, BH_OPS);
+    unsigned count = 0;
+    QEMUBH *bh = aio_bh_new(ctx, bh_count_cb, &count);
+    int64_t start = get_clock();
+
+    for (unsigned i = 0; i < BH_OPS; i++) {
+        int64_t t0 = get_clock();
+
+        qemu_bh_schedule(bh);
+        while (count == i) {
+            aio_poll(ctx, true);
+        }
+        lat[i] = get_clock() - t0;
+    }
+    report("bh-reuse", 1, BH_OPS, get_clock() - start, lat, BH_OPS);
+    qemu_bh_delete(bh);
+}
+
+/* Cross-thread wakeup of an AioContext blocked in aio_poll() */
+
+typedef struct WakeupState {
+    QemuSemaphore go;
+    int64_t sent;
+    int64_t lat;
+    bool done;
+} WakeupState;
+
+static void wakeup_cb(void *opaque)
+{
+    WakeupState *ws = opaque;
+
+    ws->lat = get_clock() - qatomic_read(&ws->sent);
+    ws->done = true;
+}
+
+static void *wakeup_thread(void *opaque)
+{
+    WakeupState *ws = opaque;
+
+    for (unsigned i = 0; i < WAKEUP_OPS; i++) {
+        qemu_sem_wait(&ws->go);
+        /* give the main thread time to block in aio_poll() */
+        g_usleep(10);
+        qatomic_set(&ws->sent, get_clock());
+        aio_bh_schedule_oneshot(ctx, wakeup_cb, ws);
+    }
+    return NULL;
+}
+
+static void bench_wakeup(void)
+{
+    g_autofree int64_t *lat = g_new(int64_t, WAKEUP_OPS);
+    WakeupState ws = {};
+    QemuThread thread;
+    int64_t start;
+
+    qemu_sem_init(&ws.go, 0);
+    qemu_thread_create(&thread, "aio-bench-wakeup", wakeup_thread, &ws,
+                       QEMU_THREAD_JOINABLE);
+
+    start = get_clock();
+    for (unsigned i = 0; i < WAKEUP_OPS; i++) {
+        ws.done = false;
+        qemu_sem_post(&ws.go);
+        while (!ws.done) {
+            aio_poll(ctx, true);
+        }
+        lat[i] = ws.lat;
+    }
+    report("wakeup", 1, WAKEUP_OPS, get_clock() - start, lat, WAKEUP_OPS);
+
+    qemu_thread_join(&thread);
+    qemu_sem_destroy(&ws.go);
+}
+
+/* thread_pool_submit_co() round trips with a number of requests in flight */
+
+typedef struct PoolState {
+    int64_t *lat;
+    unsigned next;
+    unsigned active;
+} PoolState;
+
+static int pool_noop(void *opaque)
+{
+    return 0;
+}
+
+static void coroutine_fn pool_co(void *opaque)
+{
+    PoolState *ps = opaque;
+
+    while (ps->next < POOL_OPS) {
+        unsigned i = ps->next++;
+        int64_t t0 = get_clock();
+
+        thread_pool_submit_co(pool_noop, NULL);
+        ps->lat[i] = get_clock() - t0;
+    }
+    ps->active--;
+}
+
+static void bench_thread_pool(const void *opaque)
+{
+    unsigned inflight = GPOINTER_TO_UINT(opaque);
+    g_autofree int64_t *lat = g_new(int64_t, POOL_OPS);
+    PoolState ps = { .lat = lat, .active = inflight };
+    int64_t start = get_clock();
+
+    for (unsigned i = 0; i < inflight; i++) {
+        qemu_coroutine_enter(qemu_coroutine_create(pool_co, &ps));
+    }
+    while (ps.active) {
+        aio_poll(ctx, true);
+    }
+    report("thread-pool-co", inflight, POOL_OPS, get_clock() - start,
+           lat, POOL_OPS);
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned inflight[] = { 1, 4, 16, 64 };
+
+    qemu_init_main_loop(&error_abort);
+    ctx = qemu_get_current_aio_context();
+
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/aio/bh-oneshot", bench_bh_oneshot);
+    g_test_add_func("/aio/bh-reuse", bench_bh_reuse);
+    g_test_add_func("/aio/wakeup", bench_wakeup);
+    for (int i = 0; i < ARRAY_SIZE(inflight); i++) {
+        g_autofree char *path = g_strdup_printf("/aio/thread-pool-co/%u",
+                                                inflight[i]);
+        g_test_add_data_func(path, GUINT_TO_POINTER(inflight[i]),
+                             bench_thread_pool);
+    }
+
+    return g_test_run();
+}
@@ -25,6 +25,8 @@ static struct qemu_plugin_scoreboard *counts;
 static qemu_plugin_u64 bb_count;
 static qemu_plugin_u64 insn_count;
 
+static uint64_t trans_count;
+
 static bool do_inline;
 /* Dump running CPU total on idle? */
 static bool idle_report;
@@ -52,6 +54,8 @@ static void plugin_exit(qemu_plugin_id_t id, void *p)
                            "bb's: %" PRIu64", insns: %" PRIu64 "\n",
                            qemu_plugin_u64_sum(bb_count),
                            qemu_plugin_u64_sum(insn_count));
+    g_string_append_printf(report, "Translations: %" PRIu64 "\n",
+                           __atomic_load_n(&trans_count, __ATOMIC_RELAXED));
     qemu_plugin_outs(report->str);
     qemu_plugin_scoreboard_free(counts);
 }
@@ -81,6 +85,9 @@ static void vcpu_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
 {
     size_t n_insns = qemu_plugin_tb_n_insns(tb);
 
+    /* Translation can run concurrently on several vCPUs */
+    __atomic_fetch_add(&trans_count, 1, __ATOMIC_RELAXED);
+
     if (do_inline) {
         qemu_plugin_register_vcpu_tb_exec_inline_per_vcpu(
             tb, QEMU_PLUGIN_INLINE_ADD_U64, bb_count, 1);
@@ -0,0 +1,311 @@
+/*
+ * QTest benchmarks for the Ingenic JZ4740 SoC devices
+ *
+ * Synthetic register scripts driving the DMAC, NAND, LCD and TCU models of
+ * the noah_np1380 machine. The virtual clock only moves under qtest
+ * control, so every run performs exactly the same guest operations; the
+ * host time spent on them is reported as one JSON object per benchmark:
+ *
+ *   # ingenic-bench {"bench":"dma-burst","ops":...,"bytes":...,
+ *                    "host_ns":...,"ns_per_op":...,"mb_per_s":...}
+ *
+ * Pass -m slow to run the long variants.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/timer.h"
+#include "libqtest.h"
+
+#define MACHINE         "noah_np1380"
+
+/* SDRAM bank 0 after reset: DMAR1 = 0x20f8 */
+#define SDRAM_BASE      0x20000000
+
+#define EMC_BASE        0x13010000
+#define EMC_NFCSR       (EMC_BASE + 0x50)
+
+#define DMAC_BASE       0x13020000
+#define DMAC_CH(ch, r)  (DMAC_BASE + (ch) * 0x20 + (r))
+#define DMAC_DSA        0x00
+#define DMAC_DTA        0x04
+#define DMAC_DTC        0x08
+#define DMAC_DRT        0x0c
+#define DMAC_DCS        0x10
+#define DMAC_DCM        0x14
+#define DMAC_DMAC       (DMAC_BASE + 0x300)
+#define DCS_NDES        BIT(31)
+#define DCS_TT          BIT(3)
+#define DCS_CTE         BIT(0)
+#define DCM_SAI         BIT(23)
+#define DCM_DAI         BIT(22)
+#define DCM_TSZ_32B     (4 << 8)
+#define DRT_AUTO        8
+
+#define LCD_BASE        0x13050000
+#define LCD_CFG         (LCD_BASE + 0x00)
+#define LCD_DAH         (LCD_BASE + 0x10)
+#define LCD_DAV         (LCD_BASE + 0x14)
+#define LCD_CTRL        (LCD_BASE + 0x30)
+#define LCD_DA0         (LCD_BASE + 0x40)
+#define LCD_CTRL_ENA    BIT(3)
+#define LCD_CTRL_BPP16  4
+#define LCD_XRES        320
+#define LCD_YRES        240
+
+#define TCU_BASE        0x10002000
+#define TCU_TESR        (TCU_BASE + 0x14)
+#define TCU_TECR        (TCU_BASE + 0x18)
+#define TCU_TFR         (TCU_BASE + 0x20)
+#define TCU_TFCR        (TCU_BASE + 0x28)
+#define TCU_TDFR0       (TCU_BASE + 0x40)
+#define TCU_TDHR0       (TCU_BASE + 0x44)
+#define TCU_TCNT0       (TCU_BASE + 0x48)
+#define TCU_TCSR0       (TCU_BASE + 0x4c)
+#define TCSR_PCK_EN     BIT(0)
+
+#define NAND_BASE       0x18000000
+#define NAND_DATA       (NAND_BASE)
+#define NAND_CMD        (NAND_BASE + 0x8000)
+#define NAND_ADDR       (NAND_BASE + 0x10000)
+#define NAND_PAGE_SIZE  4096
+#define NAND_OOB_SIZE   128
+#define NAND_PAGES      256
+#define NAND_IMG_SIZE   ((NAND_PAGE_SIZE + NAND_OOB_SIZE) * NAND_PAGES)
+
+typedef struct BenchResult {
+    const char *name;
+    uint64_t ops;
+    uint64_t bytes;
+    int64_t host_ns;
+} BenchResult;
+
+static unsigned bench_scale(void)
+{
+    return g_test_slow() ? 16 : 1;
+}
+
+static void bench_report(const BenchResult *r)
+{
+    double ns_per_op = r->ops ? (double)r->host_ns / r->ops : 0;
+    double mb_per_s = r->host_ns ? (double)r->bytes * 1000 / r->host_ns : 0;
+
+    g_test_message("ingenic-bench {\"bench\":\"%s\",\"ops\":%" PRIu64
+                   ",\"bytes\":%" PRIu64 ",\"host_ns\":%" PRId64
+                   ",\"ns_per_op\":%.1f,\"mb_per_s\":%.2f}",
+                   r->name, r->ops, r->bytes, r->host_ns, ns_per_op, mb_per_s);
+}
+
+/*
+ * The board always realizes its NAND chip, so every benchmark gets an
+ * image: @nand_data if given (NAND_IMG_SIZE bytes), blank otherwise.
+ * The image path is returned in @img for bench_stop().
+ */
+static QTestState *bench_start(const uint8_t *nand_data, char **img)
+{
+    g_autofree uint8_t *blank = NULL;
+    GError *err = NULL;
+    int fd = g_file_open_tmp("ingenic-bench-nand-XXXXXX", img, &err);
+
+    g_assert_no_error(err);
+    if (!nand_data) {
+        nand_data = blank = g_malloc0(NAND_IMG_SIZE);
+    }
+    g_assert(write(fd, nand_data, NAND_IMG_SIZE) == NAND_IMG_SIZE);
+    close(fd);
+
+    return qtest_initf("-machine " MACHINE " "
+                       "-drive if=none,id=nand,format=raw,file=%s "
+                       "-global ingenic-emc-nand.drive=nand", *img);
+}
+
+static void bench_stop(QTestState *qts, char *img)
+{
+    qtest_quit(qts);
+    unlink(img);
+    g_free(img);
+}
+
+static void test_dma_burst(void)
+{
+    const uint32_t len = 256 * 1024;
+    const uint32_t src = SDRAM_BASE + 0x00100000;
+    const uint32_t dst = SDRAM_BASE + 0x00200000;
+    unsigned bursts = 64 * bench_scale();
+    g_autofree uint8_t *pattern = g_malloc(len);
+    g_autofree uint8_t *check = g_malloc(len);
+    char *img;
+    QTestState *qts = bench_start(NULL, &img);
+    BenchResult r = { .name = "dma-burst" };
+
+    for (uint32_t i = 0; i < len; i++) {
+        pattern[i] = i * 7 + 3;
+    }
+    qtest_memwrite(qts, src, pattern, len);
+    qtest_writel(qts, DMAC_DMAC, BIT(0));
+
+    int64_t start = g_get_monotonic_time() * 1000;
+    for (unsigned i = 0; i < bursts; i++) {
+        qtest_writel(qts, DMAC_CH(0, DMAC_DCS), 0);
+        qtest_writel(qts, DMAC_CH(0, DMAC_DSA), src);
+        qtest_writel(qts, DMAC_CH(0, DMAC_DTA), dst);
+        qtest_writel(qts, DMAC_CH(0, DMAC_DTC), len / 32);
+        qtest_writel(qts, DMAC_CH(0, DMAC_DRT), DRT_AUTO);
+        qtest_writel(qts, DMAC_CH(0, DMAC_DCM), DCM_SAI | DCM_DAI | DCM_TSZ_32B);
+        qtest_writel(qts, DMAC_CH(0, DMAC_DCS), DCS_NDES | DCS_CTE);
+        while (!(qtest_readl(qts, DMAC_CH(0, DMAC_DCS)) & DCS_TT)) {
+            qtest_clock_step(qts, 0);
+        }
+        r.ops++;
+        r.bytes += len;
+    }
+    r.host_ns = g_get_monotonic_time() * 1000 - start;
+
+    qtest_memread(qts, dst, check, len);
+    g_assert(memcmp(pattern, check, len) == 0);
+    bench_report(&r);
+    bench_stop(qts, img);
+}
+
+static void nand_address(QTestState *qts, uint32_t row)
+{
+    qtest_writeb(qts, NAND_ADDR, 0);
+    qtest_writeb(qts, NAND_ADDR, 0);
+    qtest_writeb(qts, NAND_ADDR, row);
+    qtest_writeb(qts, NAND_ADDR, row >> 8);
+    qtest_writeb(qts, NAND_ADDR, row >> 16);
+}
+
+static void test_nand_stream(void)
+{
+    const uint32_t page_len = NAND_PAGE_SIZE + NAND_OOB_SIZE;
+    unsigned passes = bench_scale();
+    g_autofree uint8_t *data = g_malloc(NAND_IMG_SIZE);
+    BenchResult r = { .name = "nand-stream" };
+    char *img;
+
+    for (uint32_t i = 0; i < NAND_IMG_SIZE; i++) {
+        data[i] = i ^ (i >> 12);
+    }
+    QTestState *qts = bench_start(data, &img);
+
+    /* Bank 1 in NAND mode, chip enabled */
+    qtest_writel(qts, EMC_NFCSR, BIT(1) | BIT(0));
+
+    int64_t start = g_get_monotonic_time() * 1000;
+    for (unsigned pass = 0; pass < passes; pass++) {
+        for (uint32_t row = 0; row < NAND_PAGES; row++) {
+            qtest_writeb(qts, NAND_CMD, 0x00);
+            nand_address(qts, row);
+            qtest_writeb(qts, NAND_CMD, 0x30);
+            for (uint32_t ofs = 0; ofs < page_len; ofs += 4) {
+                uint32_t word = qtest_readl(qts, NAND_DATA);
+                if (pass == 0 && ofs == 0) {
+                    g_assert_cmphex(word, ==, ldl_le_p(&data[row * page_len]));
+                }
+            }
+            r.ops++;
+            r.bytes += page_len;
+        }
+    }
+    r.host_ns = g_get_monotonic_time() * 1000 - start;
+
+    bench_report(&r);
+    bench_stop(qts, img);
+}
+
+static void test_lcd_refresh(void)
+{
+    const uint32_t desc = SDRAM_BASE + 0x00010000;
+    const uint32_t fb = SDRAM_BASE + 0x00100000;
+    const uint32_t fb_len = LCD_XRES * LCD_YRES * 2;
+    unsigned frames = 60 * bench_scale();
+    char *img;
+    QTestState *qts = bench_start(NULL, &img);
+    BenchResult r = { .name = "lcd-refresh-60fps" };
+
+    /* Single descriptor looping onto itself */
+    qtest_writel(qts, desc + 0x0, desc);
+    qtest_writel(qts, desc + 0x4, fb);
+    qtest_writel(qts, desc + 0x8, 0);
+    qtest_writel(qts, desc + 0xc, fb_len / 4);
+
+    qtest_writel(qts, LCD_CFG, 0);
+    qtest_writel(qts, LCD_DAH, LCD_XRES);
+    qtest_writel(qts, LCD_DAV, LCD_YRES);
+    qtest_writel(qts, LCD_DA0, desc);
+    qtest_writel(qts, LCD_CTRL, LCD_CTRL_ENA | LCD_CTRL_BPP16);
+
+    int64_t start = g_get_monotonic_time() * 1000;
+    for (unsigned i = 0; i < frames; i++) {
+        /* Dirty one scanline per frame, as a cursor or clock would */
+        qtest_writel(qts, fb + (i % LCD_YRES) * LCD_XRES * 2, i);
+        qtest_clock_step(qts, NANOSECONDS_PER_SECOND / 60);
+        r.ops++;
+        r.bytes += fb_len;
+    }
+    r.host_ns = g_get_monotonic_time() * 1000 - start;
+
+    bench_report(&r);
+    bench_stop(qts, img);
+}
+
+static void test_tcu_poll(void)
+{
+    unsigned polls = 100000 * bench_scale();
+    char *img;
+    QTestState *qts = bench_start(NULL, &img);
+    BenchResult r = { .name = "tcu-poll" };
+    uint32_t last = 0;
+
+    qtest_writel(qts, TCU_TECR, BIT(0));
+    qtest_writel(qts, TCU_TCSR0, TCSR_PCK_EN);
+    qtest_writel(qts, TCU_TDFR0, 0xffff);
+    qtest_writel(qts, TCU_TDHR0, 0x8000);
+    qtest_writel(qts, TCU_TFCR, 0xffffffff);
+    qtest_writel(qts, TCU_TESR, BIT(0));
+
+    int64_t start = g_get_monotonic_time() * 1000;
+    for (unsigned i = 0; i < polls; i++) {
+        uint32_t cnt = qtest_readl(qts, TCU_TCNT0);
+        if (qtest_readl(qts, TCU_TFR) & BIT(0)) {
+            qtest_writel(qts, TCU_TFCR, BIT(16) | BIT(0));
+        }
+        if (i % 16 == 15) {
+            qtest_clock_step(qts, 1000);
+        }
+        last = cnt;
+        r.ops++;
+    }
+    r.host_ns = g_get_monotonic_time() * 1000 - start;
+    g_assert_cmpuint(last, <=, 0xffff);
+
+    bench_report(&r);
+    bench_stop(qts, img);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    if (!qtest_has_machine(MACHINE)) {
+        g_test_skip("Machine " MACHINE " not available");
+        return g_test_run();
+    }
+
+    qtest_add_func("ingenic-bench/dma-burst", test_dma_burst);
+    qtest_add_func("ingenic-bench/nand-stream", test_nand_stream);
+    qtest_add_func("ingenic-bench/lcd-refresh", test_lcd_refresh);
+    qtest_add_func("ingenic-bench/tcu-poll", test_tcu_poll);
+
+    return g_test_run();
+}
@@ -0,0 +1,51 @@
+/*
+ * Scalar floating point
+ *
+ * A small single precision matrix multiply and a double precision
+ * series with divisions and square roots, which go through the
+ * softfloat helpers on most targets.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include <math.h>
+#include <string.h>
+#include "perf.h"
+
+#define N 16
+
+static float a[N][N], b[N][N], c[N][N];
+
+int main(int argc, char **argv)
+{
+    unsigned long iters = perf_iterations(argc, argv, 2000);
+    double acc = 0;
+    uint64_t bits;
+
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            a[i][j] = (i + 1) / (float)(j + 3);
+            b[i][j] = (j + 2) / (float)(i + 5);
+        }
+    }
+
+    for (unsigned long n = 0; n < iters; n++) {
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < N; j++) {
+                float s = 0;
+
+                for (int k = 0; k < N; k++) {
+                    s += a[i][k] * b[k][j];
+                }
+                c[i][j] = s;
+            }
+        }
+        for (int k = 1; k < 64; k++) {
+            double t = (double)(n + k);
+
+            acc += sqrt(t) / (t + c[k % N][n % N]);
+        }
+    }
+
+    memcpy(&bits, &acc, sizeof(bits));
+    return perf_result("fp", bits);
+}
@@ -0,0 +1,53 @@
+/*
+ * Integer and branch heavy loops
+ *
+ * A software CRC32, a xorshift generator feeding divisions and a
+ * data-dependent switch, which together stress the integer ALU ops,
+ * conditional branches and the TB chaining of tight loops.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "perf.h"
+
+static uint32_t crc32_byte(uint32_t crc, uint8_t b)
+{
+    crc ^= b;
+    for (int k = 0; k < 8; k++) {
+        crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+    return crc;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long iters = perf_iterations(argc, argv, 2000000);
+    uint32_t crc = ~0u;
+    uint64_t x = 88172645463325252ull;
+    uint64_t sum = 0;
+
+    for (unsigned long n = 0; n < iters; n++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+
+        crc = crc32_byte(crc, x);
+
+        switch (x & 7) {
+        case 0:
+            sum += x / ((n | 1) & 0xffff);
+            break;
+        case 1:
+        case 2:
+            sum ^= x % 1009;
+            break;
+        case 3:
+            sum += (uint32_t)x * (uint32_t)(x >> 32);
+            break;
+        default:
+            sum -= x >> (n & 31);
+            break;
+        }
+    }
+
+    return perf_result("intloop", sum ^ crc);
+}
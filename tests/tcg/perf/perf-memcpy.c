@@ -0,0 +1,39 @@
+/*
+ * memcpy/memset throughput with the guest libc's string routines
+ *
+ * Copies of a few sizes and alignments, so both the short-copy paths
+ * and the unrolled bulk loops of the guest libc are exercised.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include <string.h>
+#include "perf.h"
+
+#define BUF_SIZE (64 * 1024)
+
+static uint8_t src[BUF_SIZE + 64], dst[BUF_SIZE + 64];
+
+int main(int argc, char **argv)
+{
+    static const size_t sizes[] = { 7, 64, 1000, 4096, BUF_SIZE };
+    unsigned long iters = perf_iterations(argc, argv, 2000);
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = i * 7;
+    }
+
+    for (unsigned long n = 0; n < iters; n++) {
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            /* Both aligned and misaligned copies */
+            size_t ofs = n & 7;
+
+            memcpy(dst + ofs, src + (n & 3), sizes[i]);
+            sum += dst[ofs + sizes[i] - 1];
+        }
+        memset(dst, n, BUF_SIZE / 4);
+        sum += dst[n % (BUF_SIZE / 4)];
+    }
+
+    return perf_result("memcpy", sum);
+}
@@ -0,0 +1,64 @@
+/*
+ * Vectorisable loops
+ *
+ * Built with auto-vectorisation, so that the compiler emits the
+ * target's SIMD instructions (SSE/AVX, NEON/SVE, MSA, ...) when the
+ * build enables them, and plain scalar code otherwise.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "perf.h"
+
+#define LEN 4096
+
+static float x[LEN], y[LEN];
+static int16_t p[LEN], q[LEN];
+static uint8_t u[LEN], v[LEN];
+
+static void saxpy(float alpha)
+{
+    for (int i = 0; i < LEN; i++) {
+        y[i] = alpha * x[i] + y[i];
+    }
+}
+
+static int32_t dot16(void)
+{
+    int32_t s = 0;
+
+    for (int i = 0; i < LEN; i++) {
+        s += p[i] * q[i];
+    }
+    return s;
+}
+
+static void umax8(void)
+{
+    for (int i = 0; i < LEN; i++) {
+        u[i] = u[i] > v[i] ? u[i] : v[i];
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long iters = perf_iterations(argc, argv, 5000);
+    uint64_t sum = 0;
+
+    for (int i = 0; i < LEN; i++) {
+        x[i] = i & 15;
+        y[i] = 1;
+        p[i] = i - LEN / 2;
+        q[i] = i & 0xff;
+        u[i] = i;
+        v[i] = i * 13;
+    }
+
+    for (unsigned long n = 0; n < iters; n++) {
+        saxpy(1.0f / (n + 1));
+        sum += dot16();
+        umax8();
+        v[n % LEN]++;
+    }
+
+    return perf_result("simd", sum + (uint64_t)y[LEN - 1] + u[LEN - 1]);
+}
@@ -0,0 +1,47 @@
+/*
+ * Self-modifying code
+ *
+ * Like a guest JIT: a small function is copied into an executable
+ * buffer and called, over and over.  Each copy writes to a page that
+ * holds translated code, so QEMU has to invalidate and retranslate it.
+ *
+ * Function pointers are assumed to point at the code, which rules out
+ * targets using function descriptors or Thumb interworking.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include <string.h>
+#include <sys/mman.h>
+#include "perf.h"
+
+/* More than the compiled size of smc_target() on the supported targets */
+#define CODE_SIZE 128
+
+static int __attribute__((noinline)) smc_target(int x)
+{
+    return x * 3 + 1;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long iters = perf_iterations(argc, argv, 20000);
+    uint64_t sum = 0;
+    char *buf;
+
+    buf = mmap(NULL, 4096, PROT_READ | PROT_WRITE | PROT_EXEC,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    for (unsigned long n = 0; n < iters; n++) {
+        int (*fn)(int) = (int (*)(int))buf;
+
+        memcpy(buf, (void *)smc_target, CODE_SIZE);
+        __builtin___clear_cache(buf, buf + CODE_SIZE);
+        sum += fn(n);
+    }
+
+    return perf_result("smc", sum);
+}
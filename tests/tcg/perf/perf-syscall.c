@@ -0,0 +1,39 @@
+/*
+ * System call heavy loop
+ *
+ * Cheap syscalls and small pipe transfers, measuring the linux-user
+ * syscall path rather than the host kernel.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include <time.h>
+#include <unistd.h>
+#include "perf.h"
+
+int main(int argc, char **argv)
+{
+    unsigned long iters = perf_iterations(argc, argv, 200000);
+    uint64_t sum = 0;
+    int fds[2];
+    char buf[16] = "tcg perf";
+
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        return 1;
+    }
+
+    for (unsigned long n = 0; n < iters; n++) {
+        struct timespec ts;
+
+        sum += getppid() != 0;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        if (write(fds[1], buf, sizeof(buf)) != sizeof(buf) ||
+            read(fds[0], buf, sizeof(buf)) != sizeof(buf)) {
+            perror("pipe transfer");
+            return 1;
+        }
+        sum += buf[n % sizeof(buf)];
+    }
+
+    return perf_result("syscall", sum);
+}
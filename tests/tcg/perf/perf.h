@@ -0,0 +1,31 @@
+/*
+ * Shared helpers for the TCG performance workloads
+ *
+ * Each workload takes an optional iteration count as its only argument
+ * and prints a checksum of its results, so that the compiler can't
+ * drop the work and so that a TCG change that breaks the workload
+ * shows up as a changed checksum.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef TCG_PERF_H
+#define TCG_PERF_H
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static inline unsigned long perf_iterations(int argc, char **argv,
+                                            unsigned long def)
+{
+    return argc > 1 ? strtoul(argv[1], NULL, 0) : def;
+}
+
+static inline int perf_result(const char *name, uint64_t sum)
+{
+    printf("%s: %016" PRIx64 "\n", name, sum);
+    return 0;
+}
+
+#endif /* TCG_PERF_H */
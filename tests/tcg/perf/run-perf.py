@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+#
+# Run a TCG performance workload and report it as JSON
+#
+# The workload is run --repeat times without instrumentation to get the
+# host time, and once more with the bb test plugin (if given) to count
+# the guest instructions, TB executions and translations.  The result
+# is a single JSON line on stdout:
+#
+#   {"bench": "memcpy", "target": "aarch64-linux-user", "host_s": ...,
+#    "insns": ..., "tb_execs": ..., "translations": ...,
+#    "insns_per_host_s": ...}
+#
+# This work is licensed under the terms of the GNU GPL, version 2 or later.
+# See the COPYING file in the top-level directory.
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import argparse
+import json
+import re
+import shlex
+import subprocess
+import sys
+import time
+from tempfile import NamedTemporaryFile
+
+
+def get_args():
+    parser = argparse.ArgumentParser(description="TCG performance runner")
+    parser.add_argument("--qemu", help="QEMU binary to run the workload",
+                        required=True)
+    parser.add_argument("--qargs", help="Additional QEMU arguments",
+                        default="")
+    parser.add_argument("--plugin", help="Path to the bb test plugin")
+    parser.add_argument("--target", help="Target name for the report")
+    parser.add_argument("--name", help="Workload name for the report")
+    parser.add_argument("--repeat", help="Timed runs, the fastest is kept",
+                        type=int, default=3)
+    parser.add_argument("binary", help="Workload to run")
+    parser.add_argument("args", nargs="*", help="Workload arguments")
+
+    return parser.parse_args()
+
+
+def run(cmd):
+    start = time.perf_counter()
+    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+    return time.perf_counter() - start
+
+
+def count(args, cmd):
+    with NamedTemporaryFile(mode="r", suffix=".pout") as log:
+        run(cmd[:1] +
+            ["-plugin", args.plugin + ",inline=true",
+             "-d", "plugin", "-D", log.name] + cmd[1:])
+        out = log.read()
+
+    total = re.search(r"Total: bb's: (\d+), insns: (\d+)", out)
+    trans = re.search(r"Translations: (\d+)", out)
+    if not total or not trans:
+        sys.exit("no counters in plugin output:\n" + out)
+    return {
+        "insns": int(total.group(2)),
+        "tb_execs": int(total.group(1)),
+        "translations": int(trans.group(1)),
+    }
+
+
+def main():
+    args = get_args()
+    cmd = ([args.qemu] + shlex.split(args.qargs) +
+           [args.binary] + args.args)
+    report = {
+        "bench": args.name or args.binary,
+        "target": args.target,
+        "host_s": min(run(cmd) for _ in range(max(args.repeat, 1))),
+    }
+
+    if args.plugin:
+        report.update(count(args, cmd))
+        report["insns_per_host_s"] = round(report["insns"] /
+                                           report["host_s"])
+
+    print(json.dumps(report))
+
+
+if __name__ == "__main__":
+    main()
@@ -25,6 +25,7 @@
 #include "socket-helpers.h"
 #include "qapi/error.h"
 #include "qemu/module.h"
+#include "qemu/coroutine.h"
 #include "qemu/main-loop.h"
 
 
@@ -560,6 +561,64 @@ static void test_io_channel_ipv4_fd(void)
 }
 
 
+#if defined(CONFIG_LINUX_IO_URING) && !defined(_WIN32)
+typedef struct UringReadData {
+    QIOChannel *ioc;
+    char buf[16];
+    bool done;
+} UringReadData;
+
+static void coroutine_fn test_io_channel_uring_read_co(void *opaque)
+{
+    UringReadData *data = opaque;
+
+    qio_channel_read_all(data->ioc, data->buf, sizeof(data->buf),
+                         &error_abort);
+    data->done = true;
+}
+
+static void test_io_channel_unix_uring(void)
+{
+    static const char msg[16] = "Hello io_uring!";
+    UringReadData data = {};
+    QIOChannel *src, *dst;
+    bool via_uring;
+    int fds[2];
+
+    g_assert_cmpint(qemu_socketpair(AF_UNIX, SOCK_STREAM, 0, fds), ==, 0);
+    src = QIO_CHANNEL(qio_channel_socket_new_fd(fds[0], &error_abort));
+    dst = QIO_CHANNEL(qio_channel_socket_new_fd(fds[1], &error_abort));
+
+    qio_channel_set_blocking(dst, false, &error_abort);
+    qio_channel_set_follow_coroutine_ctx(dst, true);
+    qio_channel_set_uring(dst, true);
+
+    /* Nothing to read yet, the coroutine must wait in the ring */
+    data.ioc = dst;
+    qemu_coroutine_enter(qemu_coroutine_create(test_io_channel_uring_read_co,
+                                               &data));
+    g_assert(!data.done);
+    via_uring = dst->uring_read_coroutine != NULL;
+    if (via_uring) {
+        g_assert(!dst->read_coroutine);
+    }
+
+    qio_channel_write_all(src, msg, sizeof(msg), &error_abort);
+    while (!data.done) {
+        main_loop_wait(false);
+    }
+    g_assert(memcmp(data.buf, msg, sizeof(msg)) == 0);
+
+    object_unref(OBJECT(src));
+    object_unref(OBJECT(dst));
+
+    if (!via_uring) {
+        g_test_skip("io_uring not available on this host");
+    }
+}
+#endif
+
+
 int main(int argc, char **argv)
 {
     bool has_ipv4, has_ipv6, has_afunix;
@@ -607,6 +666,10 @@ int main(int argc, char **argv)
 #endif
         g_test_add_func("/io/channel/socket/unix-listen-cleanup",
                         test_io_channel_unix_listen_cleanup);
+#if defined(CONFIG_LINUX_IO_URING) && !defined(_WIN32)
+        g_test_add_func("/io/channel/socket/unix-uring",
+                        test_io_channel_unix_uring);
+#endif
     }
 
 end:
@@ -0,0 +1,121 @@
+/*
+ * WriteRing unit tests
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/iov.h"
+#include "qemu/write-ring.h"
+
+#define RING_SIZE 64
+
+static int open_tmp(char **path)
+{
+    int fd = g_file_open_tmp("test-write-ring-XXXXXX", path, NULL);
+
+    g_assert_cmpint(fd, >=, 0);
+    return fd;
+}
+
+static void check_contents(const char *path, const uint8_t *expect, size_t len)
+{
+    g_autofree char *contents = NULL;
+    gsize size;
+
+    g_assert(g_file_get_contents(path, &contents, &size, NULL));
+    g_assert_cmpuint(size, ==, len);
+    g_assert(memcmp(contents, expect, len) == 0);
+}
+
+/* Records wrap around the end of the ring and all reach the file in order */
+static void test_write_ring_wrap(void)
+{
+    g_autofree char *path = NULL;
+    uint8_t expect[RING_SIZE * 8];
+    int fd = open_tmp(&path);
+    WriteRing ring;
+    size_t done = 0;
+
+    for (size_t i = 0; i < sizeof(expect); i++) {
+        expect[i] = i * 7;
+    }
+
+    write_ring_init(&ring, fd, RING_SIZE, "test-write-ring", false);
+    while (done < sizeof(expect)) {
+        size_t prod, n = MIN(sizeof(expect) - done, 24);
+
+        /* Wait for the writer to make room rather than drop */
+        while (write_ring_begin(&ring, &prod) < n) {
+            g_usleep(1000);
+        }
+        write_ring_put(&ring, prod, expect + done, n);
+        write_ring_commit(&ring, prod + n);
+        done += n;
+    }
+    write_ring_destroy(&ring);
+    close(fd);
+
+    check_contents(path, expect, sizeof(expect));
+    unlink(path);
+}
+
+/* Gathered data is copied from the requested offset */
+static void test_write_ring_iov(void)
+{
+    g_autofree char *path = NULL;
+    char a[] = "0123", b[] = "456789";
+    struct iovec iov[] = {
+        { .iov_base = a, .iov_len = 4 },
+        { .iov_base = b, .iov_len = 6 },
+    };
+    int fd = open_tmp(&path);
+    WriteRing ring;
+    size_t prod;
+
+    write_ring_init(&ring, fd, RING_SIZE, "test-write-ring", false);
+    g_assert_cmpuint(write_ring_begin(&ring, &prod), ==, RING_SIZE);
+    write_ring_put_iov(&ring, prod, iov, 2, 2, 6);
+    write_ring_commit(&ring, prod + 6);
+    write_ring_destroy(&ring);
+    close(fd);
+
+    check_contents(path, (const uint8_t *)"234567", 6);
+    unlink(path);
+}
+
+/* A stopping ring reports the error and takes no more data */
+static void test_write_ring_error(void)
+{
+    g_autofree char *path = NULL;
+    int fd = open_tmp(&path);
+    int rdonly = open(path, O_RDONLY);
+    WriteRing ring;
+    size_t prod;
+
+    g_assert_cmpint(rdonly, >=, 0);
+    write_ring_init(&ring, rdonly, RING_SIZE, "test-write-ring", true);
+    g_assert_cmpuint(write_ring_begin(&ring, &prod), ==, RING_SIZE);
+    write_ring_put(&ring, prod, "abcd", 4);
+    write_ring_commit(&ring, prod + 4);
+    while (!write_ring_failed(&ring)) {
+        g_usleep(1000);
+    }
+    g_assert_cmpuint(write_ring_begin(&ring, &prod), ==, 0);
+    write_ring_destroy(&ring);
+    close(rdonly);
+    close(fd);
+
+    check_contents(path, (const uint8_t *)"", 0);
+    unlink(path);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/write-ring/wrap", test_write_ring_wrap);
+    g_test_add_func("/write-ring/iov", test_write_ring_iov);
+    g_test_add_func("/write-ring/error", test_write_ring_error);
+    return g_test_run();
+}
@@ -0,0 +1,341 @@
+/*
+ * Damage-driven frame capture
+ *
+ * Saves the frames of a console whenever the guest changes them, for
+ * headless testing.  The display refresh only copies a frame that saw
+ * damage; converting and writing it is left to a worker thread.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "qapi/error.h"
+#include "qapi/qapi-commands-ui.h"
+#include "qemu/coroutine.h"
+#include "qemu/queue.h"
+#include "qemu/thread.h"
+#include "qemu/timer.h"
+#include "trace.h"
+#include "ui/console.h"
+
+/* Frames waiting for the worker, further ones are dropped */
+#define FRAME_CAPTURE_QUEUE_MAX 8
+
+typedef struct CapturedFrame {
+    pixman_image_t *image;
+    uint64_t seq;
+} CapturedFrame;
+
+typedef struct FrameWaiter {
+    QemuCoSleep sleep;
+    QLIST_ENTRY(FrameWaiter) next;
+} FrameWaiter;
+
+typedef struct FrameCapture {
+    DisplayChangeListener dcl;
+    char *path;
+    bool stream;
+    int stream_fd;
+    bool dirty;
+    uint64_t frame;
+    uint64_t dropped;
+    QLIST_HEAD(, FrameWaiter) waiters;
+
+    /* protected by lock */
+    QemuMutex lock;
+    QemuCond cond;
+    GQueue queue;
+    bool stopping;
+
+    QemuThread thread;
+} FrameCapture;
+
+static FrameCapture *capture;
+
+static void frame_capture_wake_waiters(FrameCapture *fc)
+{
+    FrameWaiter *w, *next;
+
+    QLIST_FOREACH_SAFE(w, &fc->waiters, next, next) {
+        /* Unlinked here, the waiter may only run after fc is gone */
+        QLIST_SAFE_REMOVE(w, next);
+        qemu_co_sleep_wake(&w->sleep);
+    }
+}
+
+static pixman_image_t *frame_capture_copy(DisplaySurface *surface)
+{
+    pixman_image_t *src = surface->image;
+    int width = pixman_image_get_width(src);
+    int height = pixman_image_get_height(src);
+    pixman_image_t *dst = pixman_image_create_bits(pixman_image_get_format(src),
+                                                   width, height, NULL, 0);
+    int sstride = pixman_image_get_stride(src);
+    int dstride = pixman_image_get_stride(dst);
+    uint8_t *sdata = (uint8_t *)pixman_image_get_data(src);
+    uint8_t *ddata = (uint8_t *)pixman_image_get_data(dst);
+
+    for (int y = 0; y < height; y++) {
+        memcpy(ddata + y * dstride, sdata + y * sstride, MIN(sstride, dstride));
+    }
+    return dst;
+}
+
+static void frame_capture_refresh(DisplayChangeListener *dcl)
+{
+    FrameCapture *fc = container_of(dcl, FrameCapture, dcl);
+    DisplaySurface *surface;
+    CapturedFrame *f;
+
+    /* Damage from the device arrives through dpy_gfx_update */
+    graphic_hw_update(dcl->con);
+    surface = qemu_console_surface(dcl->con);
+    if (!fc->dirty || !surface) {
+        return;
+    }
+    fc->dirty = false;
+    fc->frame++;
+
+    qemu_mutex_lock(&fc->lock);
+    if (g_queue_get_length(&fc->queue) >= FRAME_CAPTURE_QUEUE_MAX) {
+        fc->dropped++;
+        trace_frame_capture_drop(fc->frame);
+    } else {
+        f = g_new(CapturedFrame, 1);
+        f->image = frame_capture_copy(surface);
+        f->seq = fc->frame;
+        g_queue_push_tail(&fc->queue, f);
+        qemu_cond_signal(&fc->cond);
+    }
+    qemu_mutex_unlock(&fc->lock);
+
+    frame_capture_wake_waiters(fc);
+}
+
+static void frame_capture_gfx_update(DisplayChangeListener *dcl,
+                                     int x, int y, int w, int h)
+{
+    FrameCapture *fc = container_of(dcl, FrameCapture, dcl);
+
+    if (w > 0 && h > 0) {
+        fc->dirty = true;
+    }
+}
+
+static void frame_capture_gfx_switch(DisplayChangeListener *dcl,
+                                     DisplaySurface *new_surface)
+{
+    FrameCapture *fc = container_of(dcl, FrameCapture, dcl);
+
+    fc->dirty = true;
+}
+
+static const DisplayChangeListenerOps frame_capture_ops = {
+    .dpy_name          = "frame-capture",
+    .dpy_refresh       = frame_capture_refresh,
+    .dpy_gfx_update    = frame_capture_gfx_update,
+    .dpy_gfx_switch    = frame_capture_gfx_switch,
+};
+
+static void frame_capture_write_ppm(int fd, pixman_image_t *image)
+{
+    int width = pixman_image_get_width(image);
+    int height = pixman_image_get_height(image);
+    g_autofree char *header = g_strdup_printf("P6\n%d %d\n%d\n",
+                                              width, height, 255);
+    g_autoptr(pixman_image_t) linebuf =
+        qemu_pixman_linebuf_create(PIXMAN_BE_r8g8b8, width);
+
+    qemu_write_full(fd, header, strlen(header));
+    for (int y = 0; y < height; y++) {
+        qemu_pixman_linebuf_fill(linebuf, image, width, 0, y);
+        qemu_write_full(fd, pixman_image_get_data(linebuf), width * 3);
+    }
+}
+
+static void frame_capture_save(FrameCapture *fc, CapturedFrame *f)
+{
+    g_autofree char *filename = NULL;
+    int fd;
+
+    if (fc->stream) {
+        frame_capture_write_ppm(fc->stream_fd, f->image);
+        return;
+    }
+
+    filename = g_strdup_printf("%s/frame-%08" PRIu64 ".ppm", fc->path, f->seq);
+    fd = qemu_create(filename, O_WRONLY | O_TRUNC | O_BINARY, 0666, NULL);
+    if (fd < 0) {
+        return;
+    }
+    frame_capture_write_ppm(fd, f->image);
+    close(fd);
+}
+
+static void *frame_capture_thread(void *opaque)
+{
+    FrameCapture *fc = opaque;
+
+    qemu_mutex_lock(&fc->lock);
+    for (;;) {
+        CapturedFrame *f;
+
+        while (g_queue_is_empty(&fc->queue) && !fc->stopping) {
+            qemu_cond_wait(&fc->cond, &fc->lock);
+        }
+        f = g_queue_pop_head(&fc->queue);
+        if (!f) {
+            break;
+        }
+        qemu_mutex_unlock(&fc->lock);
+
+        frame_capture_save(fc, f);
+        pixman_image_unref(f->image);
+        g_free(f);
+
+        qemu_mutex_lock(&fc->lock);
+    }
+    qemu_mutex_unlock(&fc->lock);
+
+    return NULL;
+}
+
+void qmp_x_frame_capture_start(const char *path, const char *device,
+                               bool has_head, int64_t head,
+                               bool has_stream, bool stream,
+                               bool has_interval, int64_t interval,
+                               Error **errp)
+{
+    QemuConsole *con;
+    FrameCapture *fc;
+
+    if (capture) {
+        error_setg(errp, "Frame capture is already running");
+        return;
+    }
+    if (has_interval && interval <= 0) {
+        error_setg(errp, "'interval' must be positive");
+        return;
+    }
+
+    if (device) {
+        con = qemu_console_lookup_by_device_name(device, has_head ? head : 0,
+                                                 errp);
+        if (!con) {
+            return;
+        }
+    } else {
+        if (has_head) {
+            error_setg(errp, "'head' must be specified together with 'device'");
+            return;
+        }
+        con = qemu_console_lookup_by_index(0);
+        if (!con) {
+            error_setg(errp, "There is no console to capture frames from");
+            return;
+        }
+    }
+
+    fc = g_new0(FrameCapture, 1);
+    fc->stream = has_stream && stream;
+    fc->stream_fd = -1;
+    if (fc->stream) {
+        fc->stream_fd = qemu_create(path, O_WRONLY | O_TRUNC | O_BINARY,
+                                    0666, errp);
+        if (fc->stream_fd < 0) {
+            g_free(fc);
+            return;
+        }
+    } else if (!g_file_test(path, G_FILE_TEST_IS_DIR)) {
+        error_setg(errp, "'%s' is not a directory", path);
+        g_free(fc);
+        return;
+    }
+    fc->path = g_strdup(path);
+    fc->dirty = true;
+    QLIST_INIT(&fc->waiters);
+    qemu_mutex_init(&fc->lock);
+    qemu_cond_init(&fc->cond);
+    g_queue_init(&fc->queue);
+    qemu_thread_create(&fc->thread, "frame-capture", frame_capture_thread,
+                       fc, QEMU_THREAD_JOINABLE);
+
+    fc->dcl.ops = &frame_capture_ops;
+    fc->dcl.con = con;
+    register_displaychangelistener(&fc->dcl);
+    update_displaychangelistener(&fc->dcl, has_interval ? interval :
+                                 GUI_REFRESH_INTERVAL_DEFAULT);
+    capture = fc;
+}
+
+void qmp_x_frame_capture_stop(Error **errp)
+{
+    FrameCapture *fc = capture;
+
+    if (!fc) {
+        error_setg(errp, "Frame capture is not running");
+        return;
+    }
+    capture = NULL;
+    unregister_displaychangelistener(&fc->dcl);
+    frame_capture_wake_waiters(fc);
+
+    /* Let the worker save what is still queued */
+    qemu_mutex_lock(&fc->lock);
+    fc->stopping = true;
+    qemu_cond_signal(&fc->cond);
+    qemu_mutex_unlock(&fc->lock);
+    qemu_thread_join(&fc->thread);
+
+    if (fc->stream_fd >= 0) {
+        close(fc->stream_fd);
+    }
+    qemu_cond_destroy(&fc->cond);
+    qemu_mutex_destroy(&fc->lock);
+    g_free(fc->path);
+    g_free(fc);
+}
+
+/* Safety: coroutine-only, concurrent-coroutine safe, main thread only */
+FrameCaptureInfo * coroutine_fn
+qmp_x_wait_frame_change(bool has_after, int64_t after,
+                        bool has_timeout, int64_t timeout, Error **errp)
+{
+    FrameCapture *fc = capture;
+    FrameCaptureInfo *info;
+    FrameWaiter w = {};
+    uint64_t seen;
+
+    if (!fc) {
+        error_setg(errp, "Frame capture is not running");
+        return NULL;
+    }
+
+    seen = has_after ? after : fc->frame;
+    if (fc->frame <= seen) {
+        QLIST_INSERT_HEAD(&fc->waiters, &w, next);
+        if (has_timeout) {
+            qemu_co_sleep_ns_wakeable(&w.sleep, QEMU_CLOCK_REALTIME,
+                                      timeout * SCALE_MS);
+        } else {
+            qemu_co_sleep(&w.sleep);
+        }
+        QLIST_SAFE_REMOVE(&w, next);
+
+        /* Stopped while we were sleeping, fc is gone */
+        if (capture != fc) {
+            error_setg(errp, "Frame capture was stopped");
+            return NULL;
+        }
+        if (fc->frame <= seen) {
+            error_setg(errp, "Timed out waiting for a frame change");
+            return NULL;
+        }
+    }
+
+    info = g_new0(FrameCaptureInfo, 1);
+    info->frame = fc->frame;
+    info->dropped = fc->dropped;
+    return info;
+}
@@ -901,7 +901,7 @@ static void hbitmap_sparse_merge(HBitmap *dst, const HBitmap *src)
 void hbitmap_merge(const HBitmap *a, const HBitmap *b, HBitmap *result)
 {
     int i;
-    uint64_t j;
+    uint64_t j, count;
 
     assert(a->orig_size == result->orig_size);
     assert(b->orig_size == result->orig_size);
@@ -934,14 +934,30 @@ void hbitmap_merge(const HBitmap *a, const HBitmap *b, HBitmap *result)
      * by using hbitmap_iter_next, but this is suboptimal for dense maps.
      */
     assert(a->size == b->size);
-    for (i = HBITMAP_LEVELS - 1; i >= 0; i--) {
+
+    /*
+     * Recompute the dirty count while merging the last level, instead of
+     * walking a possibly dense result a second time.  Deserialization can
+     * leave bits set past hb->size in the final word; don't count those.
+     */
+    i = HBITMAP_LEVELS - 1;
+    count = 0;
+    for (j = 0; j < a->sizes[i]; j++) {
+        result->levels[i][j] = a->levels[i][j] | b->levels[i][j];
+        count += ctpopl(result->levels[i][j]);
+    }
+    if (result->size & (BITS_PER_LONG - 1)) {
+        int bit = result->size & (BITS_PER_LONG - 1);
+        unsigned long tail = result->levels[i][result->size >> BITS_PER_LEVEL];
+
+        count -= ctpopl(tail & ~((1UL << bit) - 1));
+    }
+    for (i--; i >= 0; i--) {
         for (j = 0; j < a->sizes[i]; j++) {
             result->levels[i][j] = a->levels[i][j] | b->levels[i][j];
         }
     }
-
-    /* Recompute the dirty count */
-    result->count = hb_count_between(result, 0, result->size - 1);
+    result->count = count;
 }
 
 char *hbitmap_sha256(const HBitmap *bitmap, Error **errp)
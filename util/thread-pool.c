@@ -19,12 +19,18 @@
 #include "qemu/queue.h"
 #include "qemu/thread.h"
 #include "qemu/coroutine.h"
+#include "qemu/lockable.h"
+#include "qemu/processor.h"
+#include "qemu/timer.h"
 #include "trace.h"
 #include "block/thread-pool.h"
 #include "qemu/main-loop.h"
 
 static void do_spawn_thread(ThreadPool *pool);
 
+/* How long an idle worker polls for new requests before it sleeps */
+#define THREAD_POOL_SPIN_NS (50 * SCALE_US)
+
 typedef struct ThreadPoolElement ThreadPoolElement;
 
 enum ThreadState {
@@ -46,6 +52,9 @@ struct ThreadPoolElement {
     enum ThreadState state;
     int ret;
 
+    /* Time of submission, for the wait time statistics */
+    int64_t submit_ns;
+
     /* Access to this list is protected by lock.  */
     QTAILQ_ENTRY(ThreadPoolElement) reqs;
 
@@ -72,11 +81,65 @@ struct ThreadPool {
     int pending_threads; /* threads created but not running yet */
     int min_threads;
     int max_threads;
+    int spinning_threads;
+    uint64_t requests;
+    uint64_t wait_ns;
+
+    /* Length of request_list, also read without lock by spinning workers */
+    unsigned int queued;
+
+    /* Protected by thread_pools_lock */
+    QLIST_ENTRY(ThreadPool) next;
 };
 
+static QemuMutex thread_pools_lock;
+static QLIST_HEAD(, ThreadPool) thread_pools =
+    QLIST_HEAD_INITIALIZER(thread_pools);
+
+static void __attribute__((__constructor__)) thread_pools_init(void)
+{
+    qemu_mutex_init(&thread_pools_lock);
+}
+
+static void thread_pool_dequeue(ThreadPool *pool, ThreadPoolElement *req)
+{
+    QTAILQ_REMOVE(&pool->request_list, req, reqs);
+    qatomic_set(&pool->queued, pool->queued - 1);
+}
+
+/*
+ * Poll for new requests for a little while before going to sleep, so
+ * that a burst of submissions doesn't pay for a futex wakeup each.  Only
+ * one worker spins at a time.  Called and returns with lock taken, but
+ * drops it in between, so the caller must recheck the pool state.
+ */
+static void thread_pool_spin(ThreadPool *pool)
+{
+    int64_t deadline;
+
+    if (pool->spinning_threads) {
+        return;
+    }
+
+    /* Counted as idle too, so that submitters don't spawn more threads */
+    pool->spinning_threads++;
+    pool->idle_threads++;
+    qemu_mutex_unlock(&pool->lock);
+
+    deadline = get_clock() + THREAD_POOL_SPIN_NS;
+    while (!qatomic_read(&pool->queued) && get_clock() < deadline) {
+        cpu_relax();
+    }
+
+    qemu_mutex_lock(&pool->lock);
+    pool->spinning_threads--;
+    pool->idle_threads--;
+}
+
 static void *worker_thread(void *opaque)
 {
     ThreadPool *pool = opaque;
+    bool spun = false;
 
     qemu_mutex_lock(&pool->lock);
     pool->pending_threads--;
@@ -86,6 +149,18 @@ static void *worker_thread(void *opaque)
         ThreadPoolElement *req;
         int ret;
 
+        if (QTAILQ_EMPTY(&pool->request_list) && !spun) {
+            /*
+             * Wakeups sent while the lock was dropped to spin went unseen,
+             * e.g. thread_pool_free() lowering max_threads, so recheck the
+             * loop condition before picking up work or going to sleep.
+             */
+            thread_pool_spin(pool);
+            spun = true;
+            continue;
+        }
+        spun = false;
+
         if (QTAILQ_EMPTY(&pool->request_list)) {
             pool->idle_threads++;
             ret = qemu_cond_timedwait(&pool->request_cond, &pool->lock, 10000);
@@ -104,8 +179,13 @@ static void *worker_thread(void *opaque)
         }
 
         req = QTAILQ_FIRST(&pool->request_list);
-        QTAILQ_REMOVE(&pool->request_list, req, reqs);
+        thread_pool_dequeue(pool, req);
+        pool->wait_ns += get_clock() - req->submit_ns;
         req->state = THREAD_ACTIVE;
+        /* Requests queued while a worker was spinning did not wake anyone */
+        if (!QTAILQ_EMPTY(&pool->request_list)) {
+            qemu_cond_signal(&pool->request_cond);
+        }
         qemu_mutex_unlock(&pool->lock);
 
         ret = req->func(req->arg);
@@ -224,7 +304,7 @@ static void thread_pool_cancel(BlockAIOCB *acb)
 
     QEMU_LOCK_GUARD(&pool->lock);
     if (elem->state == THREAD_QUEUED) {
-        QTAILQ_REMOVE(&pool->request_list, elem, reqs);
+        thread_pool_dequeue(pool, elem);
         qemu_bh_schedule(pool->completion_bh);
 
         elem->state = THREAD_DONE;
@@ -244,6 +324,7 @@ BlockAIOCB *thread_pool_submit_aio(ThreadPoolFunc *func, void *arg,
     ThreadPoolElement *req;
     AioContext *ctx = qemu_get_current_aio_context();
     ThreadPool *pool = aio_get_thread_pool(ctx);
+    bool wake;
 
     /* Assert that the thread submitting work is the same running the pool */
     assert(pool->ctx == qemu_get_current_aio_context());
@@ -253,6 +334,7 @@ BlockAIOCB *thread_pool_submit_aio(ThreadPoolFunc *func, void *arg,
     req->arg = arg;
     req->state = THREAD_QUEUED;
     req->pool = pool;
+    req->submit_ns = get_clock();
 
     QLIST_INSERT_HEAD(&pool->head, req, all);
 
@@ -263,8 +345,14 @@ BlockAIOCB *thread_pool_submit_aio(ThreadPoolFunc *func, void *arg,
         spawn_thread(pool);
     }
     QTAILQ_INSERT_TAIL(&pool->request_list, req, reqs);
+    qatomic_set(&pool->queued, pool->queued + 1);
+    pool->requests++;
+    /* A spinning worker rechecks the list under lock before sleeping */
+    wake = !pool->spinning_threads;
     qemu_mutex_unlock(&pool->lock);
-    qemu_cond_signal(&pool->request_cond);
+    if (wake) {
+        qemu_cond_signal(&pool->request_cond);
+    }
     return &req->common;
 }
 
@@ -340,6 +428,10 @@ static void thread_pool_init_one(ThreadPool *pool, AioContext *ctx)
     QTAILQ_INIT(&pool->request_list);
 
     thread_pool_update_params(pool, ctx);
+
+    WITH_QEMU_LOCK_GUARD(&thread_pools_lock) {
+        QLIST_INSERT_HEAD(&thread_pools, pool, next);
+    }
 }
 
 ThreadPool *thread_pool_new(AioContext *ctx)
@@ -357,6 +449,10 @@ void thread_pool_free(ThreadPool *pool)
 
     assert(QLIST_EMPTY(&pool->head));
 
+    WITH_QEMU_LOCK_GUARD(&thread_pools_lock) {
+        QLIST_REMOVE(pool, next);
+    }
+
     qemu_mutex_lock(&pool->lock);
 
     /* Stop new threads from spawning */
@@ -379,3 +475,19 @@ void thread_pool_free(ThreadPool *pool)
     qemu_mutex_destroy(&pool->lock);
     g_free(pool);
 }
+
+void thread_pool_get_stats(ThreadPoolStats *stats)
+{
+    ThreadPool *pool;
+
+    memset(stats, 0, sizeof(*stats));
+
+    QEMU_LOCK_GUARD(&thread_pools_lock);
+    QLIST_FOREACH(pool, &thread_pools, next) {
+        QEMU_LOCK_GUARD(&pool->lock);
+        stats->requests += pool->requests;
+        stats->wait_ns += pool->wait_ns;
+        stats->queue_depth += pool->queued;
+        stats->workers += pool->cur_threads;
+    }
+}
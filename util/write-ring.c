@@ -0,0 +1,131 @@
+/*
+ * Ring buffer drained to a file descriptor by a writer thread
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/host-utils.h"
+#include "qemu/iov.h"
+#include "qemu/write-ring.h"
+
+static void *write_ring_thread(void *opaque)
+{
+    WriteRing *ring = opaque;
+
+    qemu_mutex_lock(&ring->lock);
+    for (;;) {
+        size_t pos, chunk;
+
+        while (ring->prod == ring->cons && !ring->stopping) {
+            qemu_cond_wait(&ring->cond, &ring->lock);
+        }
+        if (ring->prod == ring->cons) {
+            break;
+        }
+
+        pos = ring->cons & (ring->size - 1);
+        chunk = MIN(ring->prod - ring->cons, ring->size - pos);
+        qemu_mutex_unlock(&ring->lock);
+
+        if (qemu_write_full(ring->fd, ring->buf + pos, chunk) != chunk &&
+            ring->stop_on_error) {
+            qemu_mutex_lock(&ring->lock);
+            ring->failed = true;
+            break;
+        }
+
+        qemu_mutex_lock(&ring->lock);
+        ring->cons += chunk;
+    }
+    qemu_mutex_unlock(&ring->lock);
+
+    return NULL;
+}
+
+void write_ring_init(WriteRing *ring, int fd, size_t size, const char *name,
+                     bool stop_on_error)
+{
+    assert(is_power_of_2(size));
+
+    ring->fd = fd;
+    ring->name = name;
+    ring->buf = g_malloc(size);
+    ring->size = size;
+    ring->stop_on_error = stop_on_error;
+    ring->prod = ring->cons = 0;
+    ring->stopping = false;
+    ring->failed = false;
+    qemu_mutex_init(&ring->lock);
+    qemu_cond_init(&ring->cond);
+    qemu_thread_create(&ring->thread, name, write_ring_thread, ring,
+                       QEMU_THREAD_JOINABLE);
+}
+
+void write_ring_destroy(WriteRing *ring)
+{
+    qemu_mutex_lock(&ring->lock);
+    ring->stopping = true;
+    qemu_cond_signal(&ring->cond);
+    qemu_mutex_unlock(&ring->lock);
+    qemu_thread_join(&ring->thread);
+
+    qemu_cond_destroy(&ring->cond);
+    qemu_mutex_destroy(&ring->lock);
+    g_free(ring->buf);
+    ring->buf = NULL;
+}
+
+size_t write_ring_begin(WriteRing *ring, size_t *prod)
+{
+    size_t space;
+
+    qemu_mutex_lock(&ring->lock);
+    *prod = ring->prod;
+    space = ring->failed ? 0 : ring->size - (ring->prod - ring->cons);
+    qemu_mutex_unlock(&ring->lock);
+
+    return space;
+}
+
+bool write_ring_failed(WriteRing *ring)
+{
+    bool failed;
+
+    qemu_mutex_lock(&ring->lock);
+    failed = ring->failed;
+    qemu_mutex_unlock(&ring->lock);
+
+    return failed;
+}
+
+void write_ring_put(WriteRing *ring, size_t prod, const void *buf, size_t len)
+{
+    size_t pos = prod & (ring->size - 1);
+    size_t chunk = MIN(len, ring->size - pos);
+
+    memcpy(ring->buf + pos, buf, chunk);
+    memcpy(ring->buf, (const uint8_t *)buf + chunk, len - chunk);
+}
+
+void write_ring_put_iov(WriteRing *ring, size_t prod, const struct iovec *iov,
+                        int cnt, size_t offset, size_t len)
+{
+    size_t pos = prod & (ring->size - 1);
+    size_t chunk = MIN(len, ring->size - pos);
+
+    iov_to_buf(iov, cnt, offset, ring->buf + pos, chunk);
+    iov_to_buf(iov, cnt, offset + chunk, ring->buf, len - chunk);
+}
+
+void write_ring_commit(WriteRing *ring, size_t prod)
+{
+    qemu_mutex_lock(&ring->lock);
+    /* The writer only sleeps on an empty ring, it may have drained it since */
+    if (ring->prod == ring->cons && prod != ring->prod) {
+        qemu_cond_signal(&ring->cond);
+    }
+    ring->prod = prod;
+    qemu_mutex_unlock(&ring->lock);
+}